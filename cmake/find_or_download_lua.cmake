@@ -1,5 +1,30 @@
 function(find_or_download_lua)
 
+  if(PJ_USE_LUAJIT)
+    if(UNIX)
+      find_package(PkgConfig QUIET)
+      pkg_search_module(PC_LUAJIT luajit)
+    endif()
+
+    find_path(LUAJIT_INCLUDE_DIR luajit.h
+      HINTS ${PC_LUAJIT_INCLUDEDIR} ${PC_LUAJIT_INCLUDE_DIRS}
+      PATH_SUFFIXES luajit-2.1 luajit-2.0)
+    find_library(LUAJIT_LIBRARY
+      NAMES luajit-5.1 luajit lua51
+      HINTS ${PC_LUAJIT_LIBDIR} ${PC_LUAJIT_LIBRARY_DIRS})
+
+    if(NOT LUAJIT_INCLUDE_DIR OR NOT LUAJIT_LIBRARY)
+      message(FATAL_ERROR "PJ_USE_LUAJIT is ON, but LuaJIT was not found")
+    endif()
+    message(STATUS "Using LuaJIT: ${LUAJIT_LIBRARY}")
+
+    add_library(lua::lua INTERFACE IMPORTED)
+    set_target_properties(
+      lua::lua PROPERTIES INTERFACE_INCLUDE_DIRECTORIES "${LUAJIT_INCLUDE_DIR}"
+                          INTERFACE_LINK_LIBRARIES "${LUAJIT_LIBRARY}")
+    return()
+  endif()
+
   find_package(Lua QUIET)
 
   if(LUA_FOUND)
@@ -5,13 +5,16 @@
  */
 
 #include "color_map.h"
+#include "PlotJuggler/lua_engine.h"
 #include <QSettings>
+#include <cmath>
 
 sol::protected_function_result ColorMap::setScrip(QString text)
 {
   _lua_function = {};
   _lua_engine = {};
   _lua_engine.open_libraries();
+  PJ::LuaEngine::configure(_lua_engine.lua_state());
   auto func = QString("function ColorMap(v)\n"
                       "%1\n"
                       "end\n")
@@ -22,10 +25,43 @@ sol::protected_function_result ColorMap::setScrip(QString text)
     _script = text;
     _lua_function = _lua_engine["ColorMap"];
   }
+  buildLookupTable();
 
   return result;
 }
 
+void ColorMap::setLookupRange(int min, int max)
+{
+  if (max < min)
+  {
+    std::swap(min, max);
+  }
+  // limit the size of the table, keeping the lower bound
+  max = int(std::min<int64_t>(max, int64_t(min) + MAX_LOOKUP_SIZE - 1));
+
+  if (min != _lookup_min || max != _lookup_max)
+  {
+    _lookup_min = min;
+    _lookup_max = max;
+    buildLookupTable();
+  }
+}
+
+void ColorMap::buildLookupTable()
+{
+  _lookup_table.clear();
+  _cache.clear();
+  if (!_lua_function.valid())
+  {
+    return;
+  }
+  _lookup_table.reserve(size_t(_lookup_max - _lookup_min) + 1);
+  for (int v = _lookup_min; v <= _lookup_max; v++)
+  {
+    _lookup_table.push_back(callScript(v));
+  }
+}
+
 QString ColorMap::getError(sol::error err) const
 {
   return QString(err.what());
@@ -33,6 +69,33 @@ QString ColorMap::getError(sol::error err) const
 
 QColor ColorMap::mapColor(double value) const
 {
+  if (!_lookup_table.empty() && value >= _lookup_min && value <= _lookup_max &&
+      value == std::floor(value))
+  {
+    return _lookup_table[size_t(int(value) - _lookup_min)];
+  }
+
+  auto it = _cache.find(value);
+  if (it != _cache.end())
+  {
+    return it->second;
+  }
+  // bound the memory used by continuous signals
+  if (_cache.size() >= MAX_LOOKUP_SIZE)
+  {
+    _cache.clear();
+  }
+  QColor color = callScript(value);
+  _cache.insert({ value, color });
+  return color;
+}
+
+QColor ColorMap::callScript(double value) const
+{
+  if (!_lua_function.valid())
+  {
+    return Qt::transparent;
+  }
   auto res = _lua_function(value);
   if (!res.valid())
   {
@@ -60,6 +123,13 @@ void SaveColorMapToSettings()
     colormap_text.insert(it.first, it.second->script());
   }
   settings.setValue("ColorMapLibrary", colormap_text);
+
+  QMap<QString, QVariant> colormap_range;
+  for (const auto& it : ColorMapLibrary())
+  {
+    colormap_range.insert(it.first, QVariantList{ it.second->lookupMin(), it.second->lookupMax() });
+  }
+  settings.setValue("ColorMapLibrary.lookupRange", colormap_range);
 }
 
 void LoadColorMapFromSettings()
@@ -69,10 +139,16 @@ void LoadColorMapFromSettings()
   ColorMapLibrary().clear();
 
   QMap<QString, QVariant> colormap_text = settings.value("ColorMapLibrary").toMap();
+  QMap<QString, QVariant> colormap_range = settings.value("ColorMapLibrary.lookupRange").toMap();
   for (const auto& key : colormap_text.keys())
   {
     QString script = colormap_text[key].toString();
     auto colormap = std::make_shared<ColorMap>();
+    auto range = colormap_range.value(key).toList();
+    if (range.size() == 2)
+    {
+      colormap->setLookupRange(range[0].toInt(), range[1].toInt());
+    }
     auto res = colormap->setScrip(script);
     if (res.valid())
     {
@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <limits>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <QColor>
 #include <sol/sol.hpp>
 
@@ -18,6 +20,12 @@ class ColorMap
 public:
   using Ptr = std::shared_ptr<ColorMap>;
 
+  // Default range of the lookup table. Colormaps are mostly used with
+  // enumerations / states, i.e. small integers.
+  static constexpr int DEFAULT_LOOKUP_MIN = 0;
+  static constexpr int DEFAULT_LOOKUP_MAX = 255;
+  static constexpr int MAX_LOOKUP_SIZE = 65536;
+
   sol::protected_function_result setScrip(QString script);
 
   QString script() const
@@ -25,14 +33,38 @@ public:
     return _script;
   }
 
+  // The colors of the integer values in [min, max] are precomputed into a
+  // lookup table, to avoid calling the Lua function for each sample.
+  void setLookupRange(int min, int max);
+
+  int lookupMin() const
+  {
+    return _lookup_min;
+  }
+
+  int lookupMax() const
+  {
+    return _lookup_max;
+  }
+
   QColor mapColor(double value) const;
 
   QString getError(sol::error err) const;
 
 private:
+  QColor callScript(double value) const;
+
+  void buildLookupTable();
+
   sol::state _lua_engine;
   sol::protected_function _lua_function;
   QString _script;
+
+  int _lookup_min = DEFAULT_LOOKUP_MIN;
+  int _lookup_max = DEFAULT_LOOKUP_MAX;
+  std::vector<QColor> _lookup_table;
+  // values outside the lookup table that have already been evaluated
+  mutable std::unordered_map<double, QColor> _cache;
 };
 
 // Storing ColoMaps as a "singleton"
@@ -25,6 +25,9 @@ ColorMapEditor::ColorMapEditor(QWidget* parent) : QDialog(parent), ui(new Ui::co
   auto theme = settings.value("StyleSheet::theme", "light").toString();
   on_stylesheetChanged(theme);
 
+  ui->spinLookupMin->setValue(ColorMap::DEFAULT_LOOKUP_MIN);
+  ui->spinLookupMax->setValue(ColorMap::DEFAULT_LOOKUP_MAX);
+
   for (const auto& it : ColorMapLibrary())
   {
     ui->listWidget->addItem(it.first);
@@ -48,6 +51,7 @@ void ColorMapEditor::on_buttonSave_clicked()
   bool ok;
 
   auto colormap = std::make_shared<ColorMap>();
+  colormap->setLookupRange(ui->spinLookupMin->value(), ui->spinLookupMax->value());
 
   auto res = colormap->setScrip(ui->functionText->toPlainText());
   if (!res.valid())
@@ -130,5 +134,7 @@ void ColorMapEditor::on_listWidget_itemDoubleClicked(QListWidgetItem* item)
   {
     auto colormap = it->second;
     ui->functionText->setText(colormap->script());
+    ui->spinLookupMin->setValue(colormap->lookupMin());
+    ui->spinLookupMax->setValue(colormap->lookupMax());
   }
 }
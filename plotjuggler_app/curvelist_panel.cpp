@@ -26,6 +26,7 @@
 #include <QTreeWidget>
 
 #include "PlotJuggler/svg_util.h"
+#include "PlotJuggler/performance_monitor.h"
 
 //-------------------------------------------------
 
@@ -86,6 +87,7 @@ void CurveListPanel::clear()
   _custom_view->clear();
   _tree_view->clear();
   _tree_view_items.clear();
+  _evaluation_progress.clear();
   ui->labelNumberDisplayed->setText("0 of 0");
 }
 
@@ -279,8 +281,32 @@ void CurveListPanel::update2ndColumnValues(double tracker_time)
   refreshValues();
 }
 
+void CurveListPanel::setEvaluationProgress(const std::string& name, double progress)
+{
+  if (progress >= 1.0)
+  {
+    _evaluation_progress.erase(name);
+  }
+  else
+  {
+    _evaluation_progress[name] = progress;
+  }
+
+  const QString curve_name = QString::fromStdString(name);
+  _custom_view->treeVisitor([&](QTreeWidgetItem* cell) {
+    if (cell->data(0, CustomRoles::Name).toString() == curve_name)
+    {
+      cell->setToolTip(0, progress < 1.0 ?
+                              tr("Calculating in background: %1%").arg(int(progress * 100)) :
+                              QString());
+    }
+  });
+  refreshValues();
+}
+
 void CurveListPanel::refreshValues()
 {
+  PJ::PerformanceMonitor::ScopedTimer timer("Curve list", "refreshValues");
   auto default_foreground = _custom_view->palette().foreground();
 
   auto FormattedNumber = [](double value) {
@@ -302,6 +328,11 @@ void CurveListPanel::refreshValues()
   };
 
   auto GetValue = [&](const std::string& name) -> QString {
+    auto progress_it = _evaluation_progress.find(name);
+    if (progress_it != _evaluation_progress.end())
+    {
+      return QString("%1% ").arg(int(progress_it->second * 100));
+    }
     {
       auto it = _plot_data.numeric.find(name);
       if (it != _plot_data.numeric.end())
@@ -462,6 +493,7 @@ void CurveListPanel::removeCurve(const std::string& name)
   _tree_view->removeCurve(curve_name);
   _tree_view_items.erase(name);
   _custom_view->removeCurve(curve_name);
+  _evaluation_progress.erase(name);
 }
 
 void CurveListPanel::on_buttonAddCustom_clicked()
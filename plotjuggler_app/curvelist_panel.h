@@ -14,6 +14,7 @@
 #include <QStandardItemModel>
 #include <QTableView>
 #include <QItemSelection>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "transforms/custom_function.h"
@@ -56,6 +57,10 @@ public:
 
   void update2ndColumnValues(double time);
 
+  /// Progress (0 to 1) of the background calculation of a custom series.
+  /// Until it is 1, it is displayed instead of the value.
+  void setEvaluationProgress(const std::string& name, double progress);
+
   virtual void keyPressEvent(QKeyEvent* event) override;
 
   void updateAppearance();
@@ -102,6 +107,8 @@ private:
 
   double _tracker_time = 0;
 
+  std::unordered_map<std::string, double> _evaluation_progress;
+
   const TransformsMap& _transforms_map;
 
   QString _style_dir;
@@ -33,6 +33,9 @@
 #include "transforms/integral_transform.h"
 #include "transforms/absolute_transform.h"
 #include "transforms/time_since_previous_point.h"
+#include "transforms/butterworth_filter.h"
+#include "transforms/running_median.h"
+#include "transforms/savitzky_golay.h"
 
 #include "new_release_dialog.h"
 
@@ -220,6 +223,9 @@ int main(int argc, char* argv[])
   TransformFactory::registerTransform<TimeSincePreviousPointTranform>();
   TransformFactory::registerTransform<MovingVarianceFilter>();
   TransformFactory::registerTransform<SamplesCountFilter>();
+  TransformFactory::registerTransform<ButterworthFilter>();
+  TransformFactory::registerTransform<RunningMedianFilter>();
+  TransformFactory::registerTransform<SavitzkyGolayFilter>();
   //---------------------------
 
   QCommandLineParser parser;
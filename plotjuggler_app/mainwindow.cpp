@@ -48,6 +48,8 @@
 #include "dummy_data.h"
 #include "PlotJuggler/svg_util.h"
 #include "PlotJuggler/reactive_function.h"
+#include "PlotJuggler/performance_monitor.h"
+#include "PlotJuggler/lua_engine.h"
 #include "multifile_prefix.h"
 
 #include "ui_aboutdialog.h"
@@ -56,6 +58,8 @@
 #include "nlohmann_parsers.h"
 #include "cheatsheet/cheatsheet_dialog.h"
 #include "colormap_editor.h"
+#include "performance_hud.h"
+#include "transforms/transform_scheduler.h"
 
 #ifdef COMPILED_WITH_CATKIN
 
@@ -109,6 +113,23 @@ MainWindow::MainWindow(const QCommandLineParser& commandline_parser, QWidget* pa
 
   _curvelist_widget = new CurveListPanel(_mapped_plot_data, _transform_functions, this);
 
+  _lazy_evaluator = new LazyEvaluator(this);
+
+  connect(_lazy_evaluator, &LazyEvaluator::progressChanged, this,
+          [this](QString id, double progress) {
+            _curvelist_widget->setEvaluationProgress(id.toStdString(), progress);
+          });
+
+  connect(_lazy_evaluator, &LazyEvaluator::finished, this, [this](QString id) {
+    _curvelist_widget->setEvaluationProgress(id.toStdString(), 1.0);
+    // the transforms that read this series are updated too
+    updateDerivedSeries();
+    forEachWidget([](PlotWidget* plot) {
+      plot->updateCurves(true);
+      plot->replot();
+    });
+  });
+
   ui->setupUi(this);
 
   // setupUi() sets the windowTitle so the skin-based setting must be done after
@@ -336,6 +357,12 @@ MainWindow::MainWindow(const QCommandLineParser& commandline_parser, QWidget* pa
 
   connect(_function_editor, &FunctionEditorWidget::accept, this, &MainWindow::onCustomPlotCreated);
 
+  PlotWidgetBase::setParallelRendering(
+      settings.value("Preferences::parallel_rendering", false).toBool());
+  _parallel_transforms = settings.value("Preferences::parallel_transforms", false).toBool();
+  _lazy_transforms = settings.value("Preferences::lazy_transforms", false).toBool();
+  PJ::LuaEngine::setJitEnabled(settings.value("Preferences::lua_jit", true).toBool());
+
   QString theme = settings.value("Preferences::theme", "light").toString();
   if (theme != "dark")
   {
@@ -464,6 +491,7 @@ void MainWindow::onTrackerTimeUpdated(double absolute_time, bool do_replot)
 
   updateReactivePlots();
 
+  PlotWidgetBase::ReplotBatch replot_batch;
   forEachWidget([&](PlotWidget* plot) {
     plot->setTrackerPosition(_tracker_time);
     if (do_replot)
@@ -589,8 +617,14 @@ void MainWindow::initializePlugins()
     ui->layoutPublishers->addWidget(start_checkbox, pub_row, 1);
     start_checkbox->setFocusPolicy(Qt::FocusPolicy::NoFocus);
 
-    connect(start_checkbox, &QCheckBox::toggled, this,
-            [=](bool enable) { publisher->setEnabled(enable); });
+    connect(start_checkbox, &QCheckBox::toggled, this, [=](bool enable) {
+      if (enable)
+      {
+        // publish or export the complete series
+        _lazy_evaluator->finishAll();
+      }
+      publisher->setEnabled(enable);
+    });
 
     connect(publisher.get(), &StatePublisher::closed, start_checkbox,
             [=]() { start_checkbox->setChecked(false); });
@@ -671,6 +705,9 @@ void MainWindow::initializePlugins()
     ui->widgetStack->addWidget(widget);
     const auto* toolbox_ptr = toolbox.get();
 
+    // the toolboxes process the complete series
+    connect(action, &QAction::triggered, _lazy_evaluator, &LazyEvaluator::finishAll);
+
     connect(action, &QAction::triggered, toolbox_ptr, &ToolboxPlugin::onShowWidget);
 
     connect(action, &QAction::triggered, this,
@@ -804,6 +841,8 @@ void MainWindow::onPlotAdded(PlotWidget* plot)
 
   connect(plot, &PlotWidget::rectChanged, this, &MainWindow::onPlotZoomChanged);
 
+  connect(plot, &PlotWidget::completeDataRequested, _lazy_evaluator, &LazyEvaluator::finishAll);
+
   plot->setTrackerPosition(_tracker_time);
   plot->on_changeTimeOffset(_time_offset.get());
   plot->on_changeDateTimeScale(ui->buttonUseDateTime->isChecked());
@@ -1033,6 +1072,10 @@ void MainWindow::onDeleteMultipleCurves(const std::vector<std::string>& curve_na
     }
   }
 
+  for (const auto& curve_name : to_be_deleted)
+  {
+    _lazy_evaluator->cancel(curve_name);
+  }
   for (const auto& curve_name : to_be_deleted)
   {
     emit dataSourceRemoved(curve_name);
@@ -1130,6 +1173,7 @@ void MainWindow::deleteAllData()
 {
   forEachWidget([](PlotWidget* plot) { plot->removeAllCurves(); });
 
+  _lazy_evaluator->cancelAll();
   _mapped_plot_data.clear();
   _transform_functions.clear();
   _curvelist_widget->clear();
@@ -1420,6 +1464,7 @@ std::unordered_set<std::string> MainWindow::loadDataFromFile(const FileLoadInfo&
   _curvelist_widget->updateFilter();
 
   // clean the custom plot. Function updateDataAndReplot will update them
+  _lazy_evaluator->cancelAll();
   for (auto& custom_it : _transform_functions)
   {
     auto it = _mapped_plot_data.numeric.find(custom_it.first);
@@ -1429,9 +1474,26 @@ std::unordered_set<std::string> MainWindow::loadDataFromFile(const FileLoadInfo&
     }
     custom_it.second->reset();
   }
+
+  // or, in lazy mode, the visible range first and the rest in the background
+  std::vector<std::pair<std::string, TransformFunction::Ptr>> custom_functions;
+  for (const auto& [id, function] : _transform_functions)
+  {
+    if (std::dynamic_pointer_cast<CustomFunction>(function))
+    {
+      custom_functions.push_back({ id, function });
+    }
+  }
+  std::sort(custom_functions.begin(), custom_functions.end(),
+            [](const auto& a, const auto& b) { return a.second->order() < b.second->order(); });
+  for (const auto& [id, function] : custom_functions)
+  {
+    evaluateLazily(id, function);
+  }
   forEachWidget([](PlotWidget* plot) { plot->updateCurves(true); });
 
   updateDataAndReplot(true);
+  previewLazyTransforms();
   ui->timeSlider->setRealValue(ui->timeSlider->getMinimum());
 
   return added_names;
@@ -1469,6 +1531,7 @@ void MainWindow::on_buttonStreamingPause_toggled(bool paused)
   forEachWidget([&](PlotWidget* plot) {
     plot->enableTracker(paused);
     plot->setZoomEnabled(paused);
+    plot->setScrollBlitEnabled(!paused);
   });
 
   if (!paused)
@@ -1643,13 +1706,88 @@ void MainWindow::loadStyleSheet(QString file_path)
 
 void MainWindow::updateDerivedSeries()
 {
-  for (auto& [id, series] : _transform_functions)
+  std::vector<std::pair<const std::string*, TransformFunction*>> transforms;
+  transforms.reserve(_transform_functions.size());
+  for (auto& [id, function] : _transform_functions)
+  {
+    transforms.push_back({ &id, function.get() });
+  }
+  std::sort(transforms.begin(), transforms.end(), [](const auto& a, const auto& b) {
+    return a.second->order() < b.second->order();
+  });
+
+  // update all transforms, but not the ReactiveLuaFunction.
+  // The results are complete when run() returns, before the plots are updated.
+  // The ones evaluated lazily process only their current evaluation range.
+  std::vector<TransformScheduler::Task> tasks;
+  tasks.reserve(transforms.size());
+  for (auto& [id, function] : transforms)
+  {
+    if (dynamic_cast<ReactiveLuaFunction*>(function) == nullptr)
+    {
+      tasks.push_back({ id, function });
+    }
+  }
+  TransformScheduler::run(tasks, _parallel_transforms);
+}
+
+bool MainWindow::evaluateLazily(const std::string& id, TransformFunction::Ptr function)
+{
+  // while streaming, the transforms are updated at each replot anyway
+  if (!_lazy_transforms || isStreamingActive())
+  {
+    return false;
+  }
+  return _lazy_evaluator->add(id, function);
+}
+
+void MainWindow::previewLazyTransforms()
+{
+  if (_lazy_evaluator->empty())
+  {
+    return;
+  }
+
+  bool found = false;
+  Range visible = { 0, 0 };
+  forEachWidget([&](PlotWidget* plot) {
+    if (plot->isEmpty())
+    {
+      return;
+    }
+    const QRectF rect = plot->currentBoundingRect();
+    visible.min = found ? std::min(visible.min, rect.left()) : rect.left();
+    visible.max = found ? std::max(visible.max, rect.right()) : rect.right();
+    found = true;
+  });
+  if (!found)
+  {
+    return;
+  }
+  // the plots display the time minus the offset
+  visible.min += _time_offset.get();
+  visible.max += _time_offset.get();
+
+  try
+  {
+    _lazy_evaluator->preview(visible, _tracker_time);
+  }
+  catch (std::exception& ex)
   {
+    QMessageBox::warning(this, tr("Warning"),
+                         tr("Failed to create the custom timeseries. "
+                            "Error:\n\n%1")
+                             .arg(ex.what()));
   }
+  forEachWidget([](PlotWidget* plot) {
+    plot->updateCurves(true);
+    plot->replot();
+  });
 }
 
 void MainWindow::updateReactivePlots()
 {
+  PerformanceMonitor::ScopedTimer timer("Reactive", "updateReactivePlots");
   std::unordered_set<std::string> updated_curves;
 
   bool curve_added = false;
@@ -1658,7 +1796,11 @@ void MainWindow::updateReactivePlots()
     if (auto reactive_function = std::dynamic_pointer_cast<PJ::ReactiveLuaFunction>(it.second))
     {
       reactive_function->setTimeTracker(_tracker_time);
-      reactive_function->calculate();
+      // executed only if the tracker moved or the series it reads changed
+      if (!reactive_function->calculateIfNeeded())
+      {
+        continue;
+      }
 
       for (auto& name : reactive_function->createdCurves())
       {
@@ -2025,11 +2167,16 @@ bool MainWindow::loadLayoutFromFile(QString filename)
     {
       try
       {
-        CustomPlotPtr new_custom_plot = std::make_shared<LuaCustomFunction>(snippet);
+        CustomPlotPtr new_custom_plot = CreateCustomFunction(snippet);
         new_custom_plot->xmlLoadState(custom_eq);
 
-        new_custom_plot->calculateAndAdd(_mapped_plot_data);
         const auto& alias_name = new_custom_plot->aliasName();
+        new_custom_plot->calculateAndAdd(_mapped_plot_data, [&]() {
+          if (!evaluateLazily(alias_name.toStdString(), new_custom_plot))
+          {
+            new_custom_plot->calculate();
+          }
+        });
         _curvelist_widget->addCustom(alias_name);
 
         _transform_functions.insert({ alias_name.toStdString(), new_custom_plot });
@@ -2053,7 +2200,17 @@ bool MainWindow::loadLayoutFromFile(QString filename)
          colormap = colormap.nextSiblingElement("colorMap"))
     {
       QString name = colormap.attribute("name");
-      ColorMapLibrary()[name]->setScrip(colormap.text());
+      auto& colormap_ptr = ColorMapLibrary()[name];
+      if (!colormap_ptr)
+      {
+        colormap_ptr = std::make_shared<ColorMap>();
+      }
+      if (colormap.hasAttribute("lookup_min") && colormap.hasAttribute("lookup_max"))
+      {
+        colormap_ptr->setLookupRange(colormap.attribute("lookup_min").toInt(),
+                                     colormap.attribute("lookup_max").toInt());
+      }
+      colormap_ptr->setScrip(colormap.text());
     }
   }
 
@@ -2111,6 +2268,8 @@ bool MainWindow::loadLayoutFromFile(QString filename)
 
   linkedZoomOut();
 
+  previewLazyTransforms();
+
   _undo_states.clear();
   _undo_states.push_back(domDocument);
   return true;
@@ -2239,6 +2398,8 @@ void MainWindow::updateTimeOffset()
 void MainWindow::updateDataAndReplot(bool replot_hidden_tabs)
 {
   _replot_timer->stop();
+  // replots are executed all together at the end of this scope
+  PlotWidgetBase::ReplotBatch replot_batch;
 
   MoveDataRet move_ret;
 
@@ -2246,6 +2407,12 @@ void MainWindow::updateDataAndReplot(bool replot_hidden_tabs)
   {
     {
       std::lock_guard<std::mutex> lock(_active_streamer_plugin->mutex());
+      auto& monitor = PerformanceMonitor::instance();
+      if (monitor.isEnabled())
+      {
+        recordIngestionRate(_active_streamer_plugin->name(), _active_streamer_plugin->dataMap());
+      }
+      PerformanceMonitor::ScopedTimer timer("Ingest", "MoveData");
       move_ret = MoveData(_active_streamer_plugin->dataMap(), _mapped_plot_data, false);
     }
 
@@ -2270,30 +2437,22 @@ void MainWindow::updateDataAndReplot(bool replot_hidden_tabs)
   }
 
   const bool is_streaming_active = isStreamingActive();
-
-  //--------------------------------
-  std::vector<TransformFunction*> transforms;
-  transforms.reserve(_transform_functions.size());
-  for (auto& [id, function] : _transform_functions)
+  if (is_streaming_active)
   {
-    transforms.push_back(function.get());
+    // the lazy evaluation is not used while streaming
+    _lazy_evaluator->finishAll();
   }
-  std::sort(transforms.begin(), transforms.end(),
-            [](TransformFunction* a, TransformFunction* b) { return a->order() < b->order(); });
 
+  //--------------------------------
   // Update the reactive plots
   updateReactivePlots();
 
-  // update all transforms, but not the ReactiveLuaFunction
-  for (auto& function : transforms)
-  {
-    if (dynamic_cast<ReactiveLuaFunction*>(function) == nullptr)
-    {
-      function->calculate();
-    }
-  }
+  updateDerivedSeries();
 
-  forEachWidget([](PlotWidget* plot) { plot->updateCurves(false); });
+  forEachWidget([is_streaming_active](PlotWidget* plot) {
+    plot->setScrollBlitEnabled(is_streaming_active);
+    plot->updateCurves(false);
+  });
 
   //--------------------------------
   // trigger again the execution of this callback if steaming == true
@@ -2313,6 +2472,33 @@ void MainWindow::updateDataAndReplot(bool replot_hidden_tabs)
   linkedZoomOut();
 }
 
+void MainWindow::recordIngestionRate(const std::string& streamer_name,
+                                     const PlotDataMapRef& pending_data)
+{
+  size_t count = 0;
+  auto countPoints = [&count](const auto& series_map) {
+    for (const auto& it : series_map)
+    {
+      count += it.second.size();
+    }
+  };
+  countPoints(pending_data.numeric);
+  countPoints(pending_data.strings);
+  countPoints(pending_data.scatter_xy);
+  countPoints(pending_data.user_defined);
+
+  if (_ingest_timer.isValid())
+  {
+    double elapsed = std::max<qint64>(1, _ingest_timer.restart()) * 0.001;
+    PerformanceMonitor::instance().addSample("Ingest rate [samples/s]", streamer_name,
+                                             double(count) / elapsed);
+  }
+  else
+  {
+    _ingest_timer.start();
+  }
+}
+
 void MainWindow::on_streamingSpinBox_valueChanged(int value)
 {
   double real_value = value;
@@ -2569,7 +2755,7 @@ void MainWindow::onEditCustomPlot(const std::string& plot_name)
     return;
   }
   _function_editor->editExistingPlot(
-      std::dynamic_pointer_cast<LuaCustomFunction>(custom_it->second));
+      std::dynamic_pointer_cast<CustomFunction>(custom_it->second));
 }
 
 void MainWindow::onRefreshCustomPlot(const std::string& plot_name)
@@ -2582,11 +2768,17 @@ void MainWindow::onRefreshCustomPlot(const std::string& plot_name)
       qWarning("failed to find custom equation");
       return;
     }
-    CustomPlotPtr ce = std::dynamic_pointer_cast<LuaCustomFunction>(custom_it->second);
-    ce->calculateAndAdd(_mapped_plot_data);
+    CustomPlotPtr ce = std::dynamic_pointer_cast<CustomFunction>(custom_it->second);
+    ce->calculateAndAdd(_mapped_plot_data, [&]() {
+      if (!evaluateLazily(plot_name, ce))
+      {
+        ce->calculate();
+      }
+    });
 
     onUpdateLeftTableValues();
     updateDataAndReplot(true);
+    previewLazyTransforms();
   }
   catch (const std::runtime_error& e)
   {
@@ -2646,7 +2838,12 @@ void MainWindow::onCustomPlotCreated(std::vector<CustomPlotPtr> custom_plots)
     }
     try
     {
-      custom_plot->calculateAndAdd(_mapped_plot_data);
+      custom_plot->calculateAndAdd(_mapped_plot_data, [&]() {
+        if (!evaluateLazily(curve_name, custom_plot))
+        {
+          custom_plot->calculate();
+        }
+      });
     }
     catch (std::exception& ex)
     {
@@ -2685,6 +2882,7 @@ void MainWindow::onCustomPlotCreated(std::vector<CustomPlotPtr> custom_plots)
     plot->updateCurves(true);
     plot->replot();
   }
+  previewLazyTransforms();
   _curvelist_widget->clearSelections();
 }
 
@@ -3030,6 +3228,8 @@ void MainWindow::on_buttonSaveLayout_clicked()
       QDomElement colormap = doc.createElement("colorMap");
       QDomText colormap_script = doc.createTextNode(it.second->script());
       colormap.setAttribute("name", colormap_name);
+      colormap.setAttribute("lookup_min", it.second->lookupMin());
+      colormap.setAttribute("lookup_max", it.second->lookupMax());
       colormap.appendChild(colormap_script);
       color_maps.appendChild(colormap);
     }
@@ -3115,6 +3315,18 @@ void MainWindow::on_actionDeleteAllData_triggered()
   deleteAllData();
 }
 
+void MainWindow::on_actionPerformanceHUD_toggled(bool checked)
+{
+  if (!_performance_hud)
+  {
+    _performance_hud = new PerformanceHUD(this);
+    connect(_performance_hud, &PerformanceHUD::closed, this,
+            [this]() { ui->actionPerformanceHUD->setChecked(false); });
+  }
+  _ingest_timer.invalidate();
+  _performance_hud->setVisible(checked);
+}
+
 void MainWindow::on_actionPreferences_triggered()
 {
   QSettings settings;
@@ -3123,6 +3335,12 @@ void MainWindow::on_actionPreferences_triggered()
   PreferencesDialog dialog;
   dialog.exec();
 
+  PlotWidgetBase::setParallelRendering(
+      settings.value("Preferences::parallel_rendering", false).toBool());
+  _parallel_transforms = settings.value("Preferences::parallel_transforms", false).toBool();
+  _lazy_transforms = settings.value("Preferences::lazy_transforms", false).toBool();
+  PJ::LuaEngine::setJitEnabled(settings.value("Preferences::lua_jit", true).toBool());
+
   QString theme = settings.value("Preferences::theme").toString();
 
   if (!theme.isEmpty() && theme != prev_style)
@@ -31,10 +31,13 @@
 #include "PlotJuggler/util/delayed_callback.hpp"
 #include "transforms/custom_function.h"
 #include "transforms/function_editor.h"
+#include "transforms/lazy_evaluator.h"
 #include "plugin_manager.h"
 
 #include "ui_mainwindow.h"
 
+class PerformanceHUD;
+
 class MainWindow : public QMainWindow
 {
   Q_OBJECT
@@ -138,6 +141,11 @@ private:
 
   bool _autostart_publishers;
 
+  bool _parallel_transforms = false;
+
+  bool _lazy_transforms = false;
+  LazyEvaluator* _lazy_evaluator;
+
   double _tracker_time;
   std::optional<double> _reference_tracker_time;
 
@@ -237,8 +245,14 @@ private:
 
   void updateDerivedSeries();
 
+  bool evaluateLazily(const std::string& id, TransformFunction::Ptr function);
+
+  void previewLazyTransforms();
+
   void updateReactivePlots();
 
+  void recordIngestionRate(const std::string& streamer_name, const PlotDataMapRef& pending_data);
+
   void dragEnterEvent(QDragEnterEvent* event);
 
   void dropEvent(QDropEvent* event);
@@ -283,6 +297,7 @@ public slots:
 private slots:
   void on_stylesheetChanged(QString style_name);
   void on_actionPreferences_triggered();
+  void on_actionPerformanceHUD_toggled(bool checked);
   void on_actionShare_the_love_triggered();
   void on_playbackStep_valueChanged(double arg1);
   void on_actionLoadStyleSheet_triggered();
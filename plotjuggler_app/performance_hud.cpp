@@ -0,0 +1,85 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "performance_hud.h"
+#include "ui_performance_hud.h"
+#include <QTableWidgetItem>
+#include <QHideEvent>
+#include "PlotJuggler/performance_monitor.h"
+
+PerformanceHUD::PerformanceHUD(QWidget* parent)
+  : QDialog(parent), ui(new Ui::performance_hud)
+{
+  ui->setupUi(this);
+  setWindowFlag(Qt::Tool);
+
+  ui->tableWidget->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+
+  connect(ui->buttonReset, &QPushButton::clicked, this, [this]() {
+    PJ::PerformanceMonitor::instance().clear();
+    refresh();
+  });
+
+  _refresh_timer.setInterval(500);
+  connect(&_refresh_timer, &QTimer::timeout, this, &PerformanceHUD::refresh);
+}
+
+PerformanceHUD::~PerformanceHUD()
+{
+  PJ::PerformanceMonitor::instance().setEnabled(false);
+  delete ui;
+}
+
+void PerformanceHUD::showEvent(QShowEvent* event)
+{
+  PJ::PerformanceMonitor::instance().setEnabled(true);
+  _refresh_timer.start();
+  refresh();
+  QDialog::showEvent(event);
+}
+
+void PerformanceHUD::hideEvent(QHideEvent* event)
+{
+  PJ::PerformanceMonitor::instance().setEnabled(false);
+  _refresh_timer.stop();
+  QDialog::hideEvent(event);
+  // spontaneous hide events come from the window system (parent minimized)
+  if (!event->spontaneous())
+  {
+    emit closed();
+  }
+}
+
+void PerformanceHUD::refresh()
+{
+  const auto statistics = PJ::PerformanceMonitor::instance().statistics();
+
+  auto table = ui->tableWidget;
+  table->setRowCount(int(statistics.size()));
+
+  auto setCell = [table](int row, int col, const QString& text) {
+    auto item = table->item(row, col);
+    if (!item)
+    {
+      item = new QTableWidgetItem();
+      table->setItem(row, col, item);
+    }
+    item->setText(text);
+  };
+
+  int row = 0;
+  for (const auto& [key, stats] : statistics)
+  {
+    setCell(row, 0, QString::fromStdString(key.first));
+    setCell(row, 1, QString::fromStdString(key.second));
+    setCell(row, 2, QString::number(stats.last, 'f', 3));
+    setCell(row, 3, QString::number(stats.p50, 'f', 3));
+    setCell(row, 4, QString::number(stats.p99, 'f', 3));
+    setCell(row, 5, QString::number(stats.max, 'f', 3));
+    setCell(row, 6, QString::number(stats.count));
+    row++;
+  }
+}
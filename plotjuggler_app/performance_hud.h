@@ -0,0 +1,45 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PERFORMANCE_HUD_H
+#define PERFORMANCE_HUD_H
+
+#include <QDialog>
+#include <QTimer>
+
+namespace Ui
+{
+class performance_hud;
+}
+
+// Shows the statistics collected by PJ::PerformanceMonitor.
+// The monitor is enabled only while this dialog is visible.
+class PerformanceHUD : public QDialog
+{
+  Q_OBJECT
+
+public:
+  explicit PerformanceHUD(QWidget* parent = nullptr);
+  ~PerformanceHUD();
+
+signals:
+  void closed();
+
+protected:
+  void showEvent(QShowEvent* event) override;
+
+  void hideEvent(QHideEvent* event) override;
+
+private slots:
+  void refresh();
+
+private:
+  Ui::performance_hud* ui;
+
+  QTimer _refresh_timer;
+};
+
+#endif  // PERFORMANCE_HUD_H
@@ -7,6 +7,8 @@
 #include "plot_background.h"
 #include "qwt_scale_map.h"
 #include "qwt_painter.h"
+#include <algorithm>
+#include <cmath>
 
 BackgroundColorItem::BackgroundColorItem(const PJ::PlotData& data, QString colormap_name)
   : _data(data), _data_name(QString::fromStdString(data.plotName())), _colormap_name(colormap_name)
@@ -27,42 +29,53 @@ void BackgroundColorItem::draw(QPainter* painter, const QwtScaleMap& xMap,
   }
   auto colormap = it->second;
 
-  double prev_Y = _data[0].y;
-  double min_interval = _data[0].x;
-  QColor prev_color = colormap->mapColor(prev_Y);
+  const double time_offset = _time_offset ? (*_time_offset) : 0;
 
-  auto isEqual = [](double a, double b) {
-    return abs(a - b) < std::numeric_limits<float>::epsilon();
+  // The sample i colors the time span [x(i), x(i+1)). Each pixel column takes the
+  // color of the sample found with a binary search, so that the cost depends on
+  // the width of the canvas, not on the number of visible samples.
+  const double front_px = xMap.transform(_data.front().x - time_offset);
+  const double back_px = xMap.transform(_data.back().x - time_offset);
+  const int first_col = static_cast<int>(
+      std::floor(std::max(std::min(front_px, back_px), canvasRect.left())));
+  const int last_col =
+      static_cast<int>(std::ceil(std::min(std::max(front_px, back_px), canvasRect.right())));
+
+  if (first_col >= last_col)
+  {
+    return;
+  }
+
+  auto lessThan = [](double t, const PJ::PlotData::Point& p) { return t < p.x; };
+  auto colorAt = [&](int col) {
+    const double t = xMap.invTransform(col + 0.5) + time_offset;
+    auto sample_it = std::upper_bound(_data.begin(), _data.end(), t, lessThan);
+    if (sample_it != _data.begin())
+    {
+      sample_it--;
+    }
+    return colormap->mapColor(sample_it->y);
   };
 
-  const size_t N = _data.size();
-  double time_offset = _time_offset ? (*_time_offset) : 0;
+  // consecutive columns with the same color are painted as a single rectangle
+  int span_start = first_col;
+  QColor span_color = colorAt(first_col);
 
-  for (size_t i = 1; i < N; i++)
+  for (int col = first_col + 1; col <= last_col; col++)
   {
-    const auto& point = _data[i];
-    if (isEqual(prev_Y, point.y) && (i + 1) < N)
+    const bool is_last = (col == last_col);
+    QColor color = is_last ? QColor() : colorAt(col);
+    if (!is_last && color == span_color)
     {
       continue;
     }
-    QColor color = colormap->mapColor(point.y);
-    if (prev_color != color || (i + 1) == N)
+    if (span_color != Qt::transparent)
     {
-      double max_interval = point.x;
-      double x1 = xMap.transform(min_interval - time_offset);
-      double x2 = xMap.transform(max_interval - time_offset);
-
-      QRectF r(x1, canvasRect.top(), x2 - x1, canvasRect.height());
-      r = r.normalized();
-
-      if (x1 < x2 && prev_color != Qt::transparent)
-      {
-        QwtPainter::fillRect(painter, r, prev_color);
-      }
-      prev_color = color;
-      min_interval = max_interval;
+      QRectF r(span_start, canvasRect.top(), col - span_start, canvasRect.height());
+      QwtPainter::fillRect(painter, r, span_color);
     }
-    prev_Y = point.y;
+    span_start = col;
+    span_color = color;
   }
 }
 
@@ -327,6 +327,7 @@ DockWidget::DockWidget(PlotDataMapRef& datamap, QWidget* parent)
   static int plot_count = 0;
   QString plot_name = QString("_plot_%1_").arg(plot_count++);
   _plot_widget = new PlotWidget(datamap, this);
+  _plot_widget->setObjectName(plot_name);
   setWidget(_plot_widget);
   setFeature(ads::CDockWidget::DockWidgetFloatable, false);
   setFeature(ads::CDockWidget::DockWidgetDeleteOnClose, true);
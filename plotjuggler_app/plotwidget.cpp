@@ -681,6 +681,10 @@ QDomElement PlotWidget::xmlSaveState(QDomDocument& doc) const
   {
     plot_el.setAttribute("style", "StepsInv");
   }
+  else if (curveStyle() == PlotWidgetBase::DENSITY)
+  {
+    plot_el.setAttribute("style", "Density");
+  }
 
   for (auto& it : curveList())
   {
@@ -896,6 +900,10 @@ bool PlotWidget::xmlLoadState(QDomElement& plot_widget, bool autozoom)
     {
       changeCurvesStyle(PlotWidgetBase::STEPSINV);
     }
+    else if (style == "Density")
+    {
+      changeCurvesStyle(PlotWidgetBase::DENSITY);
+    }
   }
 
   QString bg_data = plot_widget.attribute("background_data");
@@ -1093,6 +1101,7 @@ void PlotWidget::on_changeTimeOffset(double offset)
 
   if (fabs(prev_offset - offset) > std::numeric_limits<double>::epsilon())
   {
+    invalidateScrollBlit();
     for (auto& it : curveList())
     {
       if (auto series = dynamic_cast<QwtTimeseries*>(it.curve->data()))
@@ -1164,6 +1173,10 @@ Range PlotWidget::getVisualizationRangeY(Range range_X) const
 
 void PlotWidget::updateCurves(bool reset_older_data)
 {
+  if (reset_older_data)
+  {
+    invalidateScrollBlit();
+  }
   for (auto& it : curveList())
   {
     auto series = dynamic_cast<QwtSeriesWrapper*>(it.curve->data());
@@ -1321,6 +1334,8 @@ void PlotWidget::onShowDataStatistics()
     _statistics_dialog = new StatisticsDialog(this);
   }
 
+  emit completeDataRequested();
+
   setStatisticsTitle(_statistics_window_title);
 
   auto rect = currentBoundingRect();
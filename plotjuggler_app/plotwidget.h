@@ -102,6 +102,8 @@ signals:
   void curvesDropped();
   void splitHorizontal();
   void splitVertical();
+  // the complete data of the curves is needed (statistics)
+  void completeDataRequested();
 
 public slots:
 
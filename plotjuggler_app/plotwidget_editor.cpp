@@ -72,10 +72,15 @@ PlotwidgetEditor::PlotwidgetEditor(PlotWidget* plotwidget, QWidget* parent)
   {
     ui->radioStepsInv->setChecked(true);
   }
+  else if (_plotwidget->curveStyle() == PlotWidgetBase::DENSITY)
+  {
+    ui->radioDensity->setChecked(true);
+  }
   else
   {
     ui->radioBoth->setChecked(true);
   }
+  ui->radioDensity->setVisible(_plotwidget->isXYPlot());
 
   ui->lineLimitMax->setValidator(new QDoubleValidator(this));
   ui->lineLimitMin->setValidator(new QDoubleValidator(this));
@@ -330,6 +335,14 @@ void PlotwidgetEditor::on_radioStepsInv_toggled(bool checked)
   }
 }
 
+void PlotwidgetEditor::on_radioDensity_toggled(bool checked)
+{
+  if (checked)
+  {
+    _plotwidget->changeCurvesStyle(PlotWidgetBase::DENSITY);
+  }
+}
+
 void PlotwidgetEditor::on_checkBoxMax_toggled(bool checked)
 {
   ui->lineLimitMax->setEnabled(checked);
@@ -88,6 +88,8 @@ private slots:
 
   void on_radioStepsInv_toggled(bool checked);
 
+  void on_radioDensity_toggled(bool checked);
+
 private:
   Ui::PlotWidgetEditor* ui;
 
@@ -6,6 +6,7 @@
 #ifdef WASM_RUNTIME_ENABLED
 #include "wasm_runtime.hpp"
 #include "wasm_parser.hpp"
+#include "wasm_transform.hpp"
 #endif
 
 namespace PJ
@@ -206,7 +207,8 @@ void PluginManager::loadWASM(const QString& pluginPath)
 
     if (manifest_map.find("plugin_type") == manifest_map.end() ||
         manifest_map.find("name") == manifest_map.end() ||
-        manifest_map.find("encoding") == manifest_map.end())
+        (manifest_map["plugin_type"] == "MessageParser" &&
+         manifest_map.find("encoding") == manifest_map.end()))
     {
       qDebug() << QString("Invalid manifest in WASM plugin:");
       std::cout << manifest.toStdString() << std::endl;
@@ -214,11 +216,21 @@ void PluginManager::loadWASM(const QString& pluginPath)
     }
     const QString plugin_name = manifest_map.at("name");
     const QString plugin_type = manifest_map.at("plugin_type");
-    const QString plugin_encoding = manifest_map.at("encoding");
+    const QString plugin_encoding = manifest_map["encoding"];
 
     qDebug() << QString("%1 is a %2 WASM plugin").arg(pluginPath).arg(plugin_type);
 
-    if (plugin_type == "MessageParser")
+    if (plugin_type == "Transform")
+    {
+      // each instance of the transform loads its own copy of the module
+      runtime.reset();
+      const std::string module_path = pluginPath.toStdString();
+      const std::string transform_name = plugin_name.toStdString();
+      TransformFactory::registerTransform(transform_name, [module_path, transform_name]() {
+        return std::make_shared<TransformWASM>(module_path, transform_name);
+      });
+    }
+    else if (plugin_type == "MessageParser")
     {
       auto parser =
           std::make_shared<ParserFactoryWASM>(std::move(runtime), plugin_name, plugin_encoding);
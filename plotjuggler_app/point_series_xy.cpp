@@ -5,6 +5,8 @@
  */
 
 #include "point_series_xy.h"
+#include "PlotJuggler/time_alignment.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 
@@ -26,12 +28,18 @@ std::optional<QPointF> PointSeriesXY::sampleFromTime(double t)
     return {};
   }
 
-  int index = _y_axis->getIndexFromX(t);
-  if (index < 0)
+  // nearest cached point
+  auto it = std::lower_bound(_cached_time.begin(), _cached_time.end(), t);
+  size_t index = std::distance(_cached_time.begin(), it);
+  if (index >= _cached_time.size())
   {
-    return {};
+    index = _cached_time.size() - 1;
+  }
+  else if (index > 0 && std::abs(_cached_time[index - 1] - t) < std::abs(_cached_time[index] - t))
+  {
+    index--;
   }
-  const auto& p = _cached_curve.at(size_t(index));
+  const auto& p = _cached_curve.at(index);
   return QPointF(p.x, p.y);
 }
 
@@ -42,31 +50,106 @@ RangeOpt PointSeriesXY::getVisualizationRangeY(Range)
 
 void PointSeriesXY::updateCache(bool reset_old_data)
 {
-  _cached_curve.clear();
-
   if (_x_axis == nullptr)
   {
     throw std::runtime_error("the X axis is null");
   }
 
-  const size_t data_size = std::min(_x_axis->size(), _y_axis->size());
+  // points of X or Y inserted or removed before the last cached one: the points
+  // already joined may have changed
+  auto changedBefore = [this](const PlotData* data, uint64_t revision) {
+    auto change = data->earliestChangeSince(revision);
+    return change && !_cached_time.empty() && *change <= _cached_time.back();
+  };
+  const bool changed =
+      changedBefore(_x_axis, _x_revision) || changedBefore(_y_axis, _y_revision);
+  _x_revision = _x_axis->revision();
+  _y_revision = _y_axis->revision();
+
+  if (reset_old_data || changed || _cached_time.empty())
+  {
+    rebuildCache();
+    return;
+  }
 
-  if (data_size == 0)
+  if (_x_axis->size() == 0 || _y_axis->size() == 0)
   {
+    rebuildCache();
     return;
   }
 
-  const double EPS = std::numeric_limits<double>::epsilon();
+  // drop the points that were trimmed from the front of the source buffers
+  const double front_time = _x_axis->front().x;
+  while (!_cached_time.empty() && _cached_time.front() < front_time)
+  {
+    _cached_time.pop_front();
+    _cached_curve.popFront();
+  }
 
-  for (size_t i = 0; i < data_size; i++)
+  // the cached points must still be a contiguous range of the X axis;
+  // otherwise (data replaced, not only appended) start from scratch.
+  const size_t cached_size = _cached_time.size();
+  if (cached_size == 0)
+  {
+    rebuildCache();
+    return;
+  }
+  auto first = std::lower_bound(_x_axis->begin(), _x_axis->end(), _cached_time.front(),
+                                [](const PlotData::Point& p, double t) { return p.x < t; });
+  const size_t first_index = std::distance(_x_axis->begin(), first);
+  const size_t last_index = first_index + cached_size - 1;
+  if (last_index >= _x_axis->size() || _x_axis->at(first_index).x != _cached_time.front() ||
+      _x_axis->at(last_index).x != _cached_time.back())
   {
-    if (std::abs(_x_axis->at(i).x - _y_axis->at(i).x) > EPS)
-    {
-      throw std::runtime_error("X and Y axis don't share the same time axis");
-    }
+    rebuildCache();
+    return;
+  }
+
+  appendToCache(last_index + 1);
+}
 
-    const QPointF p(_x_axis->at(i).y, _y_axis->at(i).y);
-    _cached_curve.pushBack({ p.x(), p.y() });
+void PointSeriesXY::rebuildCache()
+{
+  _cached_curve.clear();
+  _cached_time.clear();
+
+  if (_x_axis->size() == 0 || _y_axis->size() == 0)
+  {
+    return;
+  }
+  // the points of the X axis older than the Y axis can't be joined
+  auto first = std::lower_bound(_x_axis->begin(), _x_axis->end(), _y_axis->front().x,
+                                [](const PlotData::Point& p, double t) { return p.x < t; });
+  appendToCache(std::distance(_x_axis->begin(), first));
+}
+
+void PointSeriesXY::appendToCache(size_t first_index)
+{
+  // X and Y may be sampled at different times: the value of Y is interpolated at
+  // the timestamps of X, up to the last sample of Y (the following points of X
+  // are added when Y grows).
+  auto last = std::upper_bound(_x_axis->begin() + first_index, _x_axis->end(),
+                               _y_axis->back().x,
+                               [](double t, const PlotData::Point& p) { return t < p.x; });
+  const size_t last_index = std::distance(_x_axis->begin(), last);
+  if (first_index >= last_index)
+  {
+    return;
+  }
+  const size_t count = last_index - first_index;
+
+  _time_buffer.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    _time_buffer[i] = _x_axis->at(first_index + i).x;
+  }
+  _y_buffer.resize(count);
+  AlignSeries(*_y_axis, _time_buffer.data(), count, LINEAR, _y_buffer.data());
+
+  for (size_t i = 0; i < count; i++)
+  {
+    _cached_curve.pushBack({ _x_axis->at(first_index + i).y, _y_buffer[i] });
+    _cached_time.push_back(_time_buffer[i]);
   }
 }
 
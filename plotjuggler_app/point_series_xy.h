@@ -7,6 +7,8 @@
 #ifndef POINT_SERIES_H
 #define POINT_SERIES_H
 
+#include <deque>
+#include <vector>
 #include "timeseries_qwt.h"
 
 class PointSeriesXY : public QwtTimeseries
@@ -48,6 +50,19 @@ protected:
   const PlotData* _x_axis;
   const PlotData* _y_axis;
   PlotDataXY _cached_curve;
+  // timestamps of the points in _cached_curve, used to follow the trimming
+  // and the growth of the source buffers without rebuilding the cache.
+  std::deque<double> _cached_time;
+  // revision() of the axes when the cache was updated
+  uint64_t _x_revision = 0;
+  uint64_t _y_revision = 0;
+  std::vector<double> _time_buffer;
+  std::vector<double> _y_buffer;
+
+  void rebuildCache();
+
+  // join the points of the X axis from first_index with the Y axis
+  void appendToCache(size_t first_index);
 };
 
 #endif  // POINT_SERIES_H
@@ -11,6 +11,7 @@
 #include <QFileDialog>
 #include "PlotJuggler/save_plot.h"
 #include "PlotJuggler/svg_util.h"
+#include "PlotJuggler/lua_engine.h"
 
 PreferencesDialog::PreferencesDialog(QWidget* parent)
   : QDialog(parent), ui(new Ui::PreferencesDialog)
@@ -49,6 +50,22 @@ PreferencesDialog::PreferencesDialog(QWidget* parent)
   bool no_splash = settings.value("Preferences::no_splash", false).toBool();
   ui->checkBoxSkipSplash->setChecked(no_splash);
 
+  bool parallel_rendering = settings.value("Preferences::parallel_rendering", false).toBool();
+  ui->checkBoxParallelRendering->setChecked(parallel_rendering);
+
+  bool parallel_transforms = settings.value("Preferences::parallel_transforms", false).toBool();
+  ui->checkBoxParallelTransforms->setChecked(parallel_transforms);
+
+  bool lazy_transforms = settings.value("Preferences::lazy_transforms", false).toBool();
+  ui->checkBoxLazyTransforms->setChecked(lazy_transforms);
+
+  bool lua_jit = settings.value("Preferences::lua_jit", true).toBool();
+  ui->checkBoxLuaJit->setChecked(lua_jit && PJ::LuaEngine::isLuaJIT());
+  ui->checkBoxLuaJit->setEnabled(PJ::LuaEngine::isLuaJIT());
+  const QString lua_name = PJ::LuaEngine::name();
+  ui->checkBoxLuaJit->setText(PJ::LuaEngine::isLuaJIT() ? tr("enabled (%1)").arg(lua_name) :
+                                                          tr("not available (%1)").arg(lua_name));
+
   bool autozoom_visibility = settings.value("Preferences::autozoom_visibility", true).toBool();
   ui->checkBoxAutoZoomVisibility->setChecked(autozoom_visibility);
 
@@ -105,6 +122,15 @@ void PreferencesDialog::on_buttonBox_accepted()
   settings.setValue("Preferences::use_separator", ui->checkBoxSeparator->isChecked());
   settings.setValue("Preferences::use_opengl", ui->checkBoxOpenGL->isChecked());
   settings.setValue("Preferences::no_splash", ui->checkBoxSkipSplash->isChecked());
+  settings.setValue("Preferences::parallel_rendering",
+                    ui->checkBoxParallelRendering->isChecked());
+  settings.setValue("Preferences::parallel_transforms",
+                    ui->checkBoxParallelTransforms->isChecked());
+  settings.setValue("Preferences::lazy_transforms", ui->checkBoxLazyTransforms->isChecked());
+  if (PJ::LuaEngine::isLuaJIT())
+  {
+    settings.setValue("Preferences::lua_jit", ui->checkBoxLuaJit->isChecked());
+  }
   settings.setValue("Preferences::autozoom_visibility",
                     ui->checkBoxAutoZoomVisibility->isChecked());
   settings.setValue("Preferences::autozoom_curve_added", ui->checkBoxAutoZoomAdded->isChecked());
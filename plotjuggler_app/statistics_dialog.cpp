@@ -8,6 +8,7 @@
 #include "ui_statistics_dialog.h"
 #include <QTableWidgetItem>
 #include "qwt_text.h"
+#include "timeseries_qwt.h"
 
 StatisticsDialog::StatisticsDialog(PlotWidget* parent)
   : QDialog(parent), ui(new Ui::statistics_dialog), _parent(parent)
@@ -37,50 +38,54 @@ bool StatisticsDialog::calcVisibleRange()
 
 void StatisticsDialog::update(PJ::Range range)
 {
-  std::map<QString, Statistics> statistics;
+  std::map<QString, RangeStatistics> statistics;
 
-  for (const auto& info : _parent->curveList())
+  const bool visible_range = calcVisibleRange();
+  if (!visible_range)
   {
-    Statistics stat;
-    double start_time;
-    double end_time;
-    const auto ts = info.curve->data();
+    range = { std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max() };
+  }
 
-    bool first = true;
+  for (const auto& info : _parent->curveList())
+  {
+    RangeStatistics stat;
+    auto timeseries = dynamic_cast<QwtTimeseries*>(info.curve->data());
 
-    for (size_t i = 0; i < ts->size(); i++)
+    if (timeseries && timeseries->timeseriesData())
+    {
+      // use the aggregates stored in the timeseries: O(log N)
+      const double offset = timeseries->timeOffset();
+      stat = timeseries->timeseriesData()->statistics(range.min + offset, range.max + offset);
+      stat.first_time -= offset;
+      stat.last_time -= offset;
+    }
+    else
     {
-      const auto p = ts->sample(i);
-      if (calcVisibleRange())
+      const auto ts = info.curve->data();
+      for (size_t i = 0; i < ts->size(); i++)
       {
-        if (p.x() < range.min)
+        const auto p = ts->sample(i);
+        if (visible_range)
         {
-          continue;
+          if (p.x() < range.min)
+          {
+            continue;
+          }
+          if (p.x() > range.max)
+          {
+            break;
+          }
         }
-        if (p.x() > range.max)
+        if (stat.count == 0)
         {
-          break;
+          stat.first_time = p.x();
+          stat.last_time = p.x();
         }
+        stat.first_time = std::min(stat.first_time, p.x());
+        stat.last_time = std::max(stat.last_time, p.x());
+        stat.add(p.y());
       }
-      stat.count++;
-      if (first)
-      {
-        start_time = p.x();
-        end_time = p.x();
-        stat.min = p.y();
-        stat.max = p.y();
-        first = false;
-      }
-      else
-      {
-        start_time = std::min(start_time, p.x());
-        end_time = std::max(end_time, p.x());
-        stat.min = std::min(stat.min, p.y());
-        stat.max = std::max(stat.max, p.y());
-      }
-      stat.mean_tot += p.y();
     }
-    stat.mean_interval = (end_time - start_time) / double(stat.count);
     statistics[info.curve->title().text()] = stat;
   }
 
@@ -89,15 +94,18 @@ void StatisticsDialog::update(PJ::Range range)
   for (const auto& it : statistics)
   {
     const auto& stat = it.second;
+    const bool empty = (stat.count == 0);
 
-    std::array<QString, 6> row_values;
+    std::array<QString, 8> row_values;
     row_values[0] = it.first;
     row_values[1] = QString::number(stat.count);
-    row_values[2] = QString::number(stat.min, 'f');
-    row_values[3] = QString::number(stat.max, 'f');
-    double mean = stat.mean_tot / double(stat.count);
-    row_values[4] = QString::number(mean, 'f');
-    row_values[5] = QString::number(stat.mean_interval, 'f');
+    row_values[2] = QString::number(empty ? 0.0 : stat.min, 'f');
+    row_values[3] = QString::number(empty ? 0.0 : stat.max, 'f');
+    row_values[4] = QString::number(stat.mean(), 'f');
+    row_values[5] = QString::number(stat.stdDev(), 'f');
+    row_values[6] = QString::number(stat.rms(), 'f');
+    double mean_interval = empty ? 0.0 : (stat.last_time - stat.first_time) / double(stat.count);
+    row_values[7] = QString::number(mean_interval, 'f');
 
     for (size_t col = 0; col < row_values.size(); col++)
     {
@@ -10,6 +10,7 @@
 #include <QDialog>
 #include <QCloseEvent>
 #include "PlotJuggler/plotdata.h"
+#include "PlotJuggler/range_statistics.h"
 #include "plotwidget.h"
 
 namespace Ui
@@ -17,15 +18,6 @@ namespace Ui
 class statistics_dialog;
 }
 
-struct Statistics
-{
-  size_t count = 0;
-  double min = 0;
-  double max = 0;
-  double mean_tot = 0;
-  double mean_interval = 0;
-};
-
 class StatisticsDialog : public QDialog
 {
   Q_OBJECT
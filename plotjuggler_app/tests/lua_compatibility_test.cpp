@@ -0,0 +1,289 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+// The results of the Lua custom functions must not depend on the engine.
+// A process can link only one of them, so this test is built with the engine
+// selected by PJ_USE_LUAJIT and compares the results with a C++ reference:
+// run it in both configurations. With LuaJIT, each test runs with the JIT
+// compiler enabled and disabled.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <QFile>
+
+#include "PlotJuggler/lua_engine.h"
+#include "lua_custom_function.h"
+
+using namespace PJ;
+
+namespace
+{
+struct Inputs
+{
+  std::vector<double> time;
+  std::vector<double> value;
+  std::vector<double> v1;
+  std::vector<double> v2;
+  std::vector<double> v3;
+};
+
+// value, v1, v2 and v3 form a unit quaternion (w, x, y, z), as expected by
+// the quat_to_* snippets; the other snippets use them as generic signals.
+Inputs MakeInputs()
+{
+  Inputs in;
+  const size_t count = 10000;
+  for (size_t i = 0; i < count; i++)
+  {
+    const double t = 0.01 * double(i);
+    const double roll = 0.5 * std::sin(0.7 * t);
+    const double pitch = 0.3 * std::cos(1.3 * t);
+    const double yaw = std::fmod(0.2 * t, 6.0) - 3.0;
+    const double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+    const double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+    const double cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+    in.time.push_back(t);
+    in.value.push_back(cr * cp * cy + sr * sp * sy);
+    in.v1.push_back(sr * cp * cy - cr * sp * sy);
+    in.v2.push_back(cr * sp * cy + sr * cp * sy);
+    in.v3.push_back(cr * cp * sy - sr * sp * cy);
+  }
+  return in;
+}
+
+using Reference = std::function<std::vector<double>(const Inputs&)>;
+
+// same algorithm of each snippet of default.snippets.xml. NaN are not added
+// to the series, like the results of the custom functions.
+std::map<QString, Reference> References()
+{
+  std::map<QString, Reference> refs;
+
+  refs["backward_difference_derivative"] = [](const Inputs& in) {
+    std::vector<double> out;
+    double prev_x = in.time[0];
+    double prev_y = in.value[0];
+    for (size_t i = 0; i < in.time.size(); i++)
+    {
+      out.push_back((in.value[i] - prev_y) / (in.time[i] - prev_x));
+      prev_x = in.time[i];
+      prev_y = in.value[i];
+    }
+    return out;
+  };
+
+  refs["central_difference_derivative"] = [](const Inputs& in) {
+    std::vector<double> out;
+    double first_x = in.time[0], first_y = in.value[0];
+    double second_x = in.time[0], second_y = in.value[0];
+    for (size_t i = 0; i < in.time.size(); i++)
+    {
+      out.push_back((in.value[i] - first_y) / (in.time[i] - first_x));
+      first_x = second_x;
+      first_y = second_y;
+      second_x = in.time[i];
+      second_y = in.value[i];
+    }
+    return out;
+  };
+
+  refs["average_two_curves"] = [](const Inputs& in) {
+    std::vector<double> out;
+    for (size_t i = 0; i < in.time.size(); i++)
+    {
+      out.push_back((in.value[i] + in.v1[i]) / 2);
+    }
+    return out;
+  };
+
+  refs["integral"] = [](const Inputs& in) {
+    std::vector<double> out;
+    double prev_x = in.time[0];
+    double integral = 0;
+    for (size_t i = 0; i < in.time.size(); i++)
+    {
+      integral = integral + in.value[i] * (in.time[i] - prev_x);
+      prev_x = in.time[i];
+      out.push_back(integral);
+    }
+    return out;
+  };
+
+  refs["rad_to_deg"] = [](const Inputs& in) {
+    std::vector<double> out;
+    for (double value : in.value)
+    {
+      out.push_back(value * 180 / 3.14159);
+    }
+    return out;
+  };
+
+  refs["remove_offset"] = [](const Inputs& in) {
+    std::vector<double> out;
+    for (double value : in.value)
+    {
+      out.push_back(value - in.value[0]);
+    }
+    return out;
+  };
+
+  refs["quat_to_roll"] = [](const Inputs& in) {
+    std::vector<double> out;
+    for (size_t i = 0; i < in.time.size(); i++)
+    {
+      const double w = in.value[i], x = in.v1[i], y = in.v2[i], z = in.v3[i];
+      out.push_back(std::atan2(2 * (w * x + y * z), w * w - x * x - y * y + z * z));
+    }
+    return out;
+  };
+
+  refs["quat_to_pitch"] = [](const Inputs& in) {
+    std::vector<double> out;
+    for (size_t i = 0; i < in.time.size(); i++)
+    {
+      const double w = in.value[i], x = in.v1[i], y = in.v2[i], z = in.v3[i];
+      out.push_back(std::asin(-2 * (x * z - w * y)));
+    }
+    return out;
+  };
+
+  refs["quat_to_yaw"] = [](const Inputs& in) {
+    std::vector<double> out;
+    for (size_t i = 0; i < in.time.size(); i++)
+    {
+      const double w = in.value[i], x = in.v1[i], y = in.v2[i], z = in.v3[i];
+      out.push_back(std::atan2(2 * (x * y + w * z), w * w + x * x - y * y - z * z));
+    }
+    return out;
+  };
+
+  return refs;
+}
+
+class LuaCompatibilityTest : public ::testing::TestWithParam<bool>
+{
+protected:
+  void SetUp() override
+  {
+    LuaEngine::setJitEnabled(GetParam());
+    _inputs = MakeInputs();
+    addSeries("value", _inputs.value);
+    addSeries("v1", _inputs.v1);
+    addSeries("v2", _inputs.v2);
+    addSeries("v3", _inputs.v3);
+  }
+
+  void TearDown() override
+  {
+    LuaEngine::setJitEnabled(true);
+  }
+
+  void addSeries(const std::string& name, const std::vector<double>& values)
+  {
+    auto& series = _data.addNumeric(name)->second;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      series.pushBack({ _inputs.time[i], values[i] });
+    }
+  }
+
+  // calculate the snippet using "value" as main source and v1, v2, v3
+  const PlotData& calculate(SnippetData snippet)
+  {
+    snippet.alias_name = "result_" + snippet.alias_name;
+    snippet.linked_source = "value";
+    snippet.additional_sources = { "v1", "v2", "v3" };
+    snippet.language = "LUA";
+    LuaCustomFunction function(snippet);
+    function.calculateAndAdd(_data);
+    return _data.numeric.at(snippet.alias_name.toStdString());
+  }
+
+  static void expectSame(const std::vector<double>& time, const std::vector<double>& expected,
+                         const PlotData& result)
+  {
+    size_t index = 0;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+      if (!std::isfinite(expected[i]))
+      {
+        continue;
+      }
+      ASSERT_LT(index, result.size());
+      const auto& point = result.at(index++);
+      ASSERT_EQ(point.x, time[i]);
+      ASSERT_NEAR(point.y, expected[i], 1e-9 * std::max(1.0, std::abs(expected[i])))
+          << "at time " << time[i];
+    }
+    EXPECT_EQ(index, result.size());
+  }
+
+  Inputs _inputs;
+  PlotDataMapRef _data;
+};
+
+TEST_P(LuaCompatibilityTest, SnippetLibrary)
+{
+  QFile file(PJ_DEFAULT_SNIPPETS);
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  const auto snippets = GetSnippetsFromXML(QString::fromUtf8(file.readAll()));
+  ASSERT_FALSE(snippets.empty());
+
+  const auto references = References();
+  for (const auto& [name, snippet] : snippets)
+  {
+    SCOPED_TRACE(name.toStdString());
+    auto ref = references.find(name);
+    ASSERT_NE(ref, references.end()) << "add a reference for the new snippet";
+    expectSame(_inputs.time, ref->second(_inputs), calculate(snippet));
+  }
+}
+
+TEST_P(LuaCompatibilityTest, BatchFunctions)
+{
+  const auto expected = References().at("average_two_curves")(_inputs);
+
+  SnippetData per_point;
+  per_point.alias_name = "per_point";
+  per_point.function = "return (value + v1) / 2";
+  expectSame(_inputs.time, expected, calculate(per_point));
+
+  SnippetData batch;
+  batch.alias_name = "batch";
+  batch.global_vars = R"(
+function calc_batch(time, value, v1)
+  local out = {}
+  for i = 1, #time do
+    out[i] = (value[i] + v1[i]) / 2
+  end
+  return out
+end)";
+  batch.function = "return 0";
+  expectSame(_inputs.time, expected, calculate(batch));
+
+  // FFI pointers with LuaJIT, Lua arrays with the reference interpreter
+  SnippetData ffi;
+  ffi.alias_name = "ffi";
+  ffi.global_vars = R"(
+function calc_batch_ffi(n, out, time, value, v1)
+  for i = 1, n do
+    out[i] = (value[i] + v1[i]) / 2
+  end
+end)";
+  ffi.function = "return 0";
+  expectSame(_inputs.time, expected, calculate(ffi));
+}
+
+INSTANTIATE_TEST_SUITE_P(Engine, LuaCompatibilityTest, ::testing::Values(true, false),
+                         [](const auto& info) {
+                           return std::string(info.param ? "JitEnabled" : "JitDisabled");
+                         });
+
+}  // namespace
@@ -8,3 +8,17 @@ std::optional<PlotData::Point> AbsoluteTransform::calculateNextPoint(size_t inde
   PlotData::Point out = { p.x, std::abs(p.y) };
   return out;
 }
+
+void AbsoluteTransform::calculateBatch(size_t first, size_t last,
+                                       std::vector<PlotData::Point>& out)
+{
+  const size_t offset = out.size();
+  out.resize(offset + (last - first));
+  PlotData::Point* dst = out.data() + offset;
+
+  auto it = dataSource()->begin() + first;
+  for (size_t i = 0; i < last - first; i++, ++it)
+  {
+    dst[i] = { it->x, std::abs(it->y) };
+  }
+}
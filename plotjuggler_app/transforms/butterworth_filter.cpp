@@ -0,0 +1,381 @@
+#include "butterworth_filter.h"
+#include "ui_butterworth_filter.h"
+#include <algorithm>
+#include <cmath>
+
+// the sample rate is estimated from the intervals between these first samples
+static constexpr size_t SAMPLE_RATE_ESTIMATION_SIZE = 1000;
+
+static double EstimateSampleRate(const PlotData& data)
+{
+  const size_t count = std::min(data.size(), SAMPLE_RATE_ESTIMATION_SIZE);
+  std::vector<double> intervals;
+  intervals.reserve(count);
+  for (size_t i = 1; i < count; i++)
+  {
+    const double dt = data[i].x - data[i - 1].x;
+    if (dt > 0)
+    {
+      intervals.push_back(dt);
+    }
+  }
+  if (intervals.empty())
+  {
+    return 0;
+  }
+  // the median is not affected by the gaps in the data
+  auto middle = intervals.begin() + intervals.size() / 2;
+  std::nth_element(intervals.begin(), middle, intervals.end());
+  return 1.0 / (*middle);
+}
+
+// Set the state of the sections as if the input had always been equal to value.
+static void InitializeSteadyState(std::vector<ButterworthFilter::Section>& sections, double value)
+{
+  for (auto& s : sections)
+  {
+    const double gain = (s.b0 + s.b1 + s.b2) / (1.0 + s.a1 + s.a2);
+    const double out = gain * value;
+    s.z2 = s.b2 * value - s.a2 * out;
+    s.z1 = s.b1 * value - s.a1 * out + s.z2;
+    value = out;
+  }
+}
+
+// Filter the values in place, one section at a time: the inner loop
+// has only the two state variables as dependencies.
+static void ApplySections(std::vector<ButterworthFilter::Section>& sections, double* values,
+                          size_t count)
+{
+  for (auto& s : sections)
+  {
+    const double b0 = s.b0, b1 = s.b1, b2 = s.b2, a1 = s.a1, a2 = s.a2;
+    double z1 = s.z1;
+    double z2 = s.z2;
+    for (size_t i = 0; i < count; i++)
+    {
+      const double x = values[i];
+      const double y = b0 * x + z1;
+      z1 = b1 * x - a1 * y + z2;
+      z2 = b2 * x - a2 * y;
+      values[i] = y;
+    }
+    s.z1 = z1;
+    s.z2 = z2;
+  }
+}
+
+ButterworthFilter::ButterworthFilter() : ui(new Ui::ButterworthFilter), _widget(new QWidget())
+{
+  ui->setupUi(_widget);
+
+  connect(ui->comboType, qOverload<int>(&QComboBox::currentIndexChanged), this, [=](int type) {
+    ui->spinBoxCutoffHigh->setEnabled(type == BAND_PASS);
+    emit parametersChanged();
+  });
+
+  connect(ui->spinBoxOrder, qOverload<int>(&QSpinBox::valueChanged), this,
+          [=](int) { emit parametersChanged(); });
+
+  connect(ui->spinBoxCutoff, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+          [=](double) { emit parametersChanged(); });
+
+  connect(ui->spinBoxCutoffHigh, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+          [=](double) { emit parametersChanged(); });
+
+  connect(ui->checkBoxSampleRate, &QCheckBox::toggled, this, [=](bool checked) {
+    ui->spinBoxSampleRate->setEnabled(checked);
+    emit parametersChanged();
+  });
+
+  connect(ui->spinBoxSampleRate, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+          [=](double) { emit parametersChanged(); });
+
+  connect(ui->checkBoxZeroPhase, &QCheckBox::toggled, this, [=]() { emit parametersChanged(); });
+}
+
+ButterworthFilter::~ButterworthFilter()
+{
+  delete ui;
+  delete _widget;
+}
+
+std::vector<ButterworthFilter::Section> ButterworthFilter::designSections(const Design& design)
+{
+  std::vector<Section> sections;
+  if (design.sample_rate <= 0 || design.order < 1)
+  {
+    return sections;
+  }
+
+  // bilinear transform of the analog prototype, with pre-warped cutoff frequency
+  auto add_filter = [&](bool high_pass, double cutoff) {
+    const double nyquist = 0.5 * design.sample_rate;
+    cutoff = std::clamp(cutoff, 1e-6 * nyquist, 0.999 * nyquist);
+    const double K = std::tan(M_PI * cutoff / design.sample_rate);
+    const double K2 = K * K;
+
+    // one section for each pair of complex conjugate poles
+    for (int k = 0; k < design.order / 2; k++)
+    {
+      const double Q = 1.0 / (2.0 * std::sin(M_PI * double(2 * k + 1) / (2.0 * design.order)));
+      const double norm = 1.0 / (1.0 + K / Q + K2);
+      Section s;
+      if (high_pass)
+      {
+        s.b0 = norm;
+        s.b1 = -2.0 * norm;
+      }
+      else
+      {
+        s.b0 = K2 * norm;
+        s.b1 = 2.0 * K2 * norm;
+      }
+      s.b2 = s.b0;
+      s.a1 = 2.0 * (K2 - 1.0) * norm;
+      s.a2 = (1.0 - K / Q + K2) * norm;
+      sections.push_back(s);
+    }
+    // and a first order section for the real pole, if the order is odd
+    if (design.order % 2 == 1)
+    {
+      const double norm = 1.0 / (1.0 + K);
+      Section s;
+      s.b0 = high_pass ? norm : K * norm;
+      s.b1 = high_pass ? -norm : K * norm;
+      s.b2 = 0;
+      s.a1 = (K - 1.0) * norm;
+      s.a2 = 0;
+      sections.push_back(s);
+    }
+  };
+
+  switch (design.type)
+  {
+    case LOW_PASS:
+      add_filter(false, design.cutoff);
+      break;
+    case HIGH_PASS:
+      add_filter(true, design.cutoff);
+      break;
+    case BAND_PASS:
+      add_filter(true, std::min(design.cutoff, design.cutoff_high));
+      add_filter(false, std::max(design.cutoff, design.cutoff_high));
+      break;
+  }
+  return sections;
+}
+
+ButterworthFilter::Design ButterworthFilter::currentDesign() const
+{
+  Design design;
+  design.type = static_cast<FilterType>(ui->comboType->currentIndex());
+  design.order = ui->spinBoxOrder->value();
+  design.cutoff = ui->spinBoxCutoff->value();
+  design.cutoff_high = ui->spinBoxCutoffHigh->value();
+  if (ui->checkBoxSampleRate->isChecked())
+  {
+    design.sample_rate = ui->spinBoxSampleRate->value();
+  }
+  else if (_initialized && _design.sample_rate > 0)
+  {
+    // estimated once: it must not change while the data is processed
+    design.sample_rate = _design.sample_rate;
+  }
+  else if (dataSource())
+  {
+    design.sample_rate = EstimateSampleRate(*dataSource());
+  }
+  return design;
+}
+
+void ButterworthFilter::reset()
+{
+  for (auto& s : _sections)
+  {
+    s.z1 = 0;
+    s.z2 = 0;
+  }
+  _initialized = false;
+  _zero_phase_source.reset();
+  TransformFunction_SISO::reset();
+}
+
+void ButterworthFilter::calculate()
+{
+  const Design design = currentDesign();
+  const bool zero_phase = ui->checkBoxZeroPhase->isChecked();
+
+  // the output calculated with other coefficients, or in the other mode, is discarded
+  if (!(design == _design) || zero_phase != _zero_phase_source.has_value())
+  {
+    _design = design;
+    _sections = designSections(design);
+    reset();
+    dataDestinations().front()->clear();
+  }
+
+  if (zero_phase)
+  {
+    calculateZeroPhase();
+  }
+  else
+  {
+    TransformFunction_SISO::calculate();
+  }
+}
+
+void ButterworthFilter::calculateZeroPhase()
+{
+  const PlotData* src_data = dataSource();
+  PlotData* dst_data = dataDestinations().front();
+  dst_data->setMaximumRangeX(src_data->maximumRangeX());
+
+  SourceState source;
+  source.revision = src_data->revision();
+  source.size = src_data->size();
+  if (source.size > 0)
+  {
+    source.front = src_data->front().x;
+    source.back = src_data->back().x;
+  }
+  if (_zero_phase_source && *_zero_phase_source == source)
+  {
+    return;
+  }
+  _zero_phase_source = source;
+
+  dst_data->clear();
+  if (source.size == 0 || _sections.empty())
+  {
+    return;
+  }
+
+  std::vector<double> values(source.size);
+  for (size_t i = 0; i < source.size; i++)
+  {
+    values[i] = (*src_data)[i].y;
+  }
+
+  // forward, then backward on the reversed output
+  auto sections = _sections;
+  InitializeSteadyState(sections, values.front());
+  ApplySections(sections, values.data(), values.size());
+  std::reverse(values.begin(), values.end());
+  InitializeSteadyState(sections, values.front());
+  ApplySections(sections, values.data(), values.size());
+  std::reverse(values.begin(), values.end());
+
+  for (size_t i = 0; i < source.size; i++)
+  {
+    dst_data->pushBack({ (*src_data)[i].x, values[i] });
+  }
+}
+
+std::any ButterworthFilter::saveState() const
+{
+  if (!_initialized)
+  {
+    return {};
+  }
+  return std::make_pair(_design, _sections);
+}
+
+bool ButterworthFilter::restoreState(const std::any& state)
+{
+  // a checkpoint saved with a different design can't be used
+  auto saved = std::any_cast<std::pair<Design, std::vector<Section>>>(&state);
+  if (!saved || !(saved->first == _design))
+  {
+    return false;
+  }
+  _sections = saved->second;
+  _initialized = true;
+  return true;
+}
+
+std::optional<PlotData::Point> ButterworthFilter::calculateNextPoint(size_t index)
+{
+  std::vector<PlotData::Point> out;
+  calculateBatch(index, index + 1, out);
+  if (out.empty())
+  {
+    return {};
+  }
+  return out.front();
+}
+
+void ButterworthFilter::calculateBatch(size_t first, size_t last,
+                                       std::vector<PlotData::Point>& out)
+{
+  if (_sections.empty() || first >= last)
+  {
+    return;
+  }
+  const size_t count = last - first;
+  auto src = dataSource()->begin() + first;
+
+  std::vector<double> values(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    values[i] = src[i].y;
+  }
+  if (!_initialized)
+  {
+    // avoid the transient of a step from zero to the first value
+    InitializeSteadyState(_sections, values.front());
+    _initialized = true;
+  }
+  ApplySections(_sections, values.data(), count);
+
+  out.reserve(out.size() + count);
+  for (size_t i = 0; i < count; i++)
+  {
+    out.push_back({ src[i].x, values[i] });
+  }
+}
+
+QWidget* ButterworthFilter::optionsWidget()
+{
+  return _widget;
+}
+
+bool ButterworthFilter::xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const
+{
+  static const char* type_names[] = { "low_pass", "high_pass", "band_pass" };
+
+  QDomElement widget_el = doc.createElement("options");
+  widget_el.setAttribute("type", type_names[ui->comboType->currentIndex()]);
+  widget_el.setAttribute("order", ui->spinBoxOrder->value());
+  widget_el.setAttribute("cutoff", ui->spinBoxCutoff->value());
+  widget_el.setAttribute("cutoff_high", ui->spinBoxCutoffHigh->value());
+  widget_el.setAttribute("custom_sample_rate",
+                         ui->checkBoxSampleRate->isChecked() ? "true" : "false");
+  widget_el.setAttribute("sample_rate", ui->spinBoxSampleRate->value());
+  widget_el.setAttribute("zero_phase", ui->checkBoxZeroPhase->isChecked() ? "true" : "false");
+  parent_element.appendChild(widget_el);
+  return true;
+}
+
+bool ButterworthFilter::xmlLoadState(const QDomElement& parent_element)
+{
+  QDomElement widget_el = parent_element.firstChildElement("options");
+  if (widget_el.isNull())
+  {
+    return false;
+  }
+  const QString type = widget_el.attribute("type");
+  ui->comboType->setCurrentIndex(type == "high_pass" ? HIGH_PASS :
+                                 type == "band_pass" ? BAND_PASS :
+                                                       LOW_PASS);
+  ui->spinBoxOrder->setValue(widget_el.attribute("order").toInt());
+  ui->spinBoxCutoff->setValue(widget_el.attribute("cutoff").toDouble());
+  ui->spinBoxCutoffHigh->setValue(widget_el.attribute("cutoff_high").toDouble());
+  ui->checkBoxSampleRate->setChecked(widget_el.attribute("custom_sample_rate") == "true");
+  if (widget_el.hasAttribute("sample_rate"))
+  {
+    ui->spinBoxSampleRate->setValue(widget_el.attribute("sample_rate").toDouble());
+  }
+  ui->checkBoxZeroPhase->setChecked(widget_el.attribute("zero_phase") == "true");
+  return true;
+}
@@ -0,0 +1,121 @@
+#ifndef BUTTERWORTH_FILTER_H
+#define BUTTERWORTH_FILTER_H
+
+#include <QWidget>
+#include "PlotJuggler/transform_function.h"
+
+using namespace PJ;
+
+namespace Ui
+{
+class ButterworthFilter;
+}
+
+/**
+ * Butterworth low-pass, high-pass or band-pass filter, implemented as a cascade of
+ * second order sections (transposed direct form II). The band-pass is a high-pass
+ * followed by a low-pass with the same order.
+ *
+ * The sample rate is estimated from the data, unless it is specified by the user.
+ * In zero-phase mode, the filter is applied forward and backward (like filtfilt):
+ * the result has no delay, but the whole series is processed again when it changes.
+ */
+class ButterworthFilter : public TransformFunction_SISO
+{
+  Q_OBJECT
+
+public:
+  explicit ButterworthFilter();
+
+  ~ButterworthFilter() override;
+
+  static const char* transformName()
+  {
+    return "Butterworth Filter";
+  }
+
+  const char* name() const override
+  {
+    return transformName();
+  }
+
+  void reset() override;
+
+  void calculate() override;
+
+  std::any saveState() const override;
+
+  bool restoreState(const std::any& state) override;
+
+  QWidget* optionsWidget() override;
+
+  bool xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const override;
+
+  bool xmlLoadState(const QDomElement& parent_element) override;
+
+  enum FilterType
+  {
+    LOW_PASS,
+    HIGH_PASS,
+    BAND_PASS
+  };
+
+  struct Design
+  {
+    FilterType type = LOW_PASS;
+    int order = 2;
+    double cutoff = 1.0;       // Hz; lower cutoff of the band-pass
+    double cutoff_high = 2.0;  // Hz; only band-pass
+    double sample_rate = 0;
+
+    bool operator==(const Design& other) const
+    {
+      return type == other.type && order == other.order && cutoff == other.cutoff &&
+             cutoff_high == other.cutoff_high && sample_rate == other.sample_rate;
+    }
+  };
+
+  struct Section
+  {
+    // coefficients, normalized with a0 = 1. First order sections have b2 = a2 = 0
+    double b0, b1, b2, a1, a2;
+    // state
+    double z1 = 0;
+    double z2 = 0;
+  };
+
+  static std::vector<Section> designSections(const Design& design);
+
+private:
+  Ui::ButterworthFilter* ui;
+  QWidget* _widget;
+
+  Design _design;
+  std::vector<Section> _sections;
+  bool _initialized = false;
+
+  // zero-phase mode: the source when the output was calculated
+  struct SourceState
+  {
+    uint64_t revision = 0;
+    size_t size = 0;
+    double front = 0;
+    double back = 0;
+    bool operator==(const SourceState& other) const
+    {
+      return revision == other.revision && size == other.size && front == other.front &&
+             back == other.back;
+    }
+  };
+  std::optional<SourceState> _zero_phase_source;
+
+  Design currentDesign() const;
+
+  void calculateZeroPhase();
+
+  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
+};
+
+#endif  // BUTTERWORTH_FILTER_H
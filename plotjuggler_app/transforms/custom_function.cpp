@@ -1,10 +1,12 @@
 #include "custom_function.h"
 
+#include <algorithm>
 #include <limits>
 #include <QFile>
 #include <QMessageBox>
 #include <QElapsedTimer>
 #include "lua_custom_function.h"
+#include "expression_custom_function.h"
 
 CustomFunction::CustomFunction(SnippetData snippet)
 {
@@ -28,9 +30,12 @@ void CustomFunction::reset()
 {
   // This cause a crash during streaming for reasons that are not 100% clear.
   // initEngine();
+  _revision_sources.clear();
+  _source_revisions.clear();
 }
 
-void CustomFunction::calculateAndAdd(PlotDataMapRef& src_data)
+void CustomFunction::calculateAndAdd(PlotDataMapRef& src_data,
+                                     const std::function<void()>& evaluate)
 {
   bool newly_added = false;
 
@@ -49,7 +54,14 @@ void CustomFunction::calculateAndAdd(PlotDataMapRef& src_data)
 
   try
   {
-    calculate();
+    if (evaluate)
+    {
+      evaluate();
+    }
+    else
+    {
+      calculate();
+    }
   }
   catch (...)
   {
@@ -101,20 +113,105 @@ void CustomFunction::calculate()
     last_updated_stamp = dst_data->back().x;
   }
 
+  // points of a source inserted or removed before the last calculated one.
+  // There are no checkpoints: the script may keep a state in its global
+  // variables, so everything is calculated again, like a TransformFunction_SISO
+  // without saveState().
+  if (sourcesChangedBefore(last_updated_stamp))
+  {
+    initEngine();
+    dst_data->clear();
+    last_updated_stamp = std::numeric_limits<double>::lowest();
+  }
+
+  // the source is sorted: skip the points older than last_updated_stamp
+  auto first_new = std::upper_bound(main_data_source->begin(), main_data_source->end(),
+                                    last_updated_stamp,
+                                    [](double x, const PlotData::Point& p) { return x < p.x; });
+  size_t index = std::distance(main_data_source->begin(), first_new);
+
+  // lazy evaluation: only the points inside the evaluation range
+  size_t src_size = main_data_source->size();
+  if (_evaluation_range)
+  {
+    auto first = std::lower_bound(main_data_source->begin(), main_data_source->end(),
+                                  _evaluation_range->min,
+                                  [](const PlotData::Point& p, double x) { return p.x < x; });
+    index = std::max<size_t>(index, std::distance(main_data_source->begin(), first));
+    auto last = std::upper_bound(main_data_source->begin(), main_data_source->end(),
+                                 _evaluation_range->max,
+                                 [](double x, const PlotData::Point& p) { return x < p.x; });
+    src_size = std::distance(main_data_source->begin(), last);
+  }
+
+  // process the points in blocks, to bound the size of the temporary buffer
+  static constexpr size_t BLOCK_SIZE = 4096;
   std::vector<PlotData::Point> points;
-  for (size_t i = 0; i < main_data_source->size(); ++i)
+
+  while (index < src_size)
+  {
+    const size_t last = std::min(index + BLOCK_SIZE, src_size);
+    points.clear();
+    calculatePointsBatch(_src_vector, index, last, points);
+    for (auto& point : points)
+    {
+      dst_data->pushBack(std::move(point));
+    }
+    index = last;
+  }
+}
+
+bool CustomFunction::sourcesChangedBefore(double time)
+{
+  bool changed = false;
+  if (_revision_sources == _src_vector)
   {
-    if (main_data_source->at(i).x > last_updated_stamp)
+    for (size_t i = 0; i < _src_vector.size(); i++)
     {
-      points.clear();
-      calculatePoints(_src_vector, i, points);
+      auto change = _src_vector[i]->earliestChangeSince(_source_revisions[i]);
+      changed |= (change && *change <= time);
+    }
+  }
+  _revision_sources = _src_vector;
+  _source_revisions.clear();
+  for (const PlotData* source : _src_vector)
+  {
+    _source_revisions.push_back(source->revision());
+  }
+  return changed;
+}
 
-      for (PlotData::Point const& point : points)
-      {
-        dst_data->pushBack(point);
-      }
+void CustomFunction::calculatePointsBatch(const std::vector<const PlotData*>& src_data,
+                                          size_t first, size_t last,
+                                          std::vector<PlotData::Point>& new_points)
+{
+  for (size_t i = first; i < last; i++)
+  {
+    calculatePoints(src_data, i, new_points);
+  }
+}
+
+std::vector<const PlotData*> CustomFunction::dependencies()
+{
+  // _src_vector is updated only by calculate(): resolve the names instead
+  std::vector<const PlotData*> sources;
+  if (!plotData())
+  {
+    return sources;
+  }
+  auto addSource = [&](const std::string& name) {
+    auto it = plotData()->numeric.find(name);
+    if (it != plotData()->numeric.end())
+    {
+      sources.push_back(&it->second);
     }
+  };
+  addSource(_linked_plot_name);
+  for (const auto& channel : _used_channels)
+  {
+    addSource(channel);
   }
+  return sources;
 }
 
 bool CustomFunction::xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const
@@ -181,6 +278,15 @@ QDomElement ExportSnippets(const SnippetsMap& snippets, QDomDocument& doc)
   return snippets_root;
 }
 
+CustomPlotPtr CreateCustomFunction(const SnippetData& snippet)
+{
+  if (snippet.language == "EXPRESSION")
+  {
+    return std::make_shared<ExpressionCustomFunction>(snippet);
+  }
+  return std::make_shared<LuaCustomFunction>(snippet);
+}
+
 SnippetData GetSnippetFromXML(const QDomElement& element)
 {
   SnippetData snippet;
@@ -188,6 +294,7 @@ SnippetData GetSnippetFromXML(const QDomElement& element)
   snippet.alias_name = element.attribute("name");
   snippet.global_vars = element.firstChildElement("global").text().trimmed();
   snippet.function = element.firstChildElement("function").text().trimmed();
+  snippet.language = element.attribute("language", "LUA");
 
   auto additional_el = element.firstChildElement("additional_sources");
   if (!additional_el.isNull())
@@ -210,6 +317,10 @@ QDomElement ExportSnippetToXML(const SnippetData& snippet, QDomDocument& doc)
   auto element = doc.createElement("snippet");
 
   element.setAttribute("name", snippet.alias_name);
+  if (snippet.language != "LUA")
+  {
+    element.setAttribute("language", snippet.language);
+  }
 
   auto global_el = doc.createElement("global");
   global_el.appendChild(doc.createTextNode(snippet.global_vars));
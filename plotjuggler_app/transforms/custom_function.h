@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -23,6 +24,8 @@ struct SnippetData
   QString function;
   QString linked_source;
   QStringList additional_sources;
+  // "LUA" or "EXPRESSION", see CustomFunction::language()
+  QString language = "LUA";
 };
 
 typedef std::map<QString, SnippetData> SnippetsMap;
@@ -37,6 +40,10 @@ QDomElement ExportSnippetToXML(const SnippetData& snippet, QDomDocument& destina
 
 QDomElement ExportSnippets(const SnippetsMap& snippets, QDomDocument& destination_doc);
 
+/// Create the LuaCustomFunction or the ExpressionCustomFunction, according to snippet.language.
+/// Throws std::runtime_error if the code is not valid.
+CustomPlotPtr CreateCustomFunction(const SnippetData& snippet);
+
 class CustomFunction : public PJ::TransformFunction
 {
 public:
@@ -63,6 +70,13 @@ public:
 
   void calculate() override;
 
+  bool supportsEvaluationRange() const override
+  {
+    return true;
+  }
+
+  std::vector<const PlotData*> dependencies() override;
+
   bool xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const override;
 
   bool xmlLoadState(const QDomElement& parent_element) override;
@@ -73,15 +87,33 @@ public:
 
   virtual void initEngine() = 0;
 
-  void calculateAndAdd(PlotDataMapRef& src_data);
+  /// Create the destination series in src_data, if needed, and calculate it.
+  /// If not empty, evaluate is called instead of calculate(), for instance to
+  /// evaluate the function lazily.
+  void calculateAndAdd(PlotDataMapRef& src_data, const std::function<void()>& evaluate = {});
 
   virtual void calculatePoints(const std::vector<const PlotData*>& src_data, size_t point_index,
                                std::vector<PlotData::Point>& new_points) = 0;
 
+  /// Batch version of calculatePoints(), used by calculate(): process the points
+  /// of src_data.front() in the range [first, last) and append the results to new_points.
+  /// The default implementation calls calculatePoints() for each point.
+  virtual void calculatePointsBatch(const std::vector<const PlotData*>& src_data, size_t first,
+                                    size_t last, std::vector<PlotData::Point>& new_points);
+
 protected:
   SnippetData _snippet;
   std::string _linked_plot_name;
   std::string _plot_name;
 
   std::vector<std::string> _used_channels;
+
+private:
+  // sources of the last calculate() and their revision() at that time
+  std::vector<const PlotData*> _revision_sources;
+  std::vector<uint64_t> _source_revisions;
+
+  // true if a point of the sources was inserted or removed at time <= time
+  // since the last call; it records the current revisions.
+  bool sourcesChangedBefore(double time);
 };
@@ -0,0 +1,70 @@
+#include "expression_custom_function.h"
+#include "PlotJuggler/time_alignment.h"
+
+ExpressionCustomFunction::ExpressionCustomFunction(SnippetData snippet)
+  : CustomFunction(snippet)
+{
+  initEngine();
+}
+
+void ExpressionCustomFunction::initEngine()
+{
+  std::vector<std::string> variables = { "time", "value" };
+  for (int index = 1; index <= _snippet.additional_sources.size(); index++)
+  {
+    variables.push_back("v" + std::to_string(index));
+  }
+  _expression = std::make_unique<MathExpression>(_snippet.function.toStdString(), variables);
+}
+
+void ExpressionCustomFunction::calculatePoints(const std::vector<const PlotData*>& src_data,
+                                               size_t point_index,
+                                               std::vector<PlotData::Point>& points)
+{
+  calculatePointsBatch(src_data, point_index, point_index + 1, points);
+}
+
+void ExpressionCustomFunction::calculatePointsBatch(const std::vector<const PlotData*>& src_data,
+                                                    size_t first, size_t last,
+                                                    std::vector<PlotData::Point>& points)
+{
+  if (first >= last)
+  {
+    return;
+  }
+  const PlotData& main_data = *src_data.front();
+  const size_t count = last - first;
+
+  _time.resize(count);
+  for (size_t i = first; i < last; i++)
+  {
+    _time[i - first] = main_data.at(i).x;
+  }
+
+  // the variables are time, value, v1, v2, ...
+  std::vector<const double*> inputs = { _time.data() };
+  _aligned_values.resize(src_data.size());
+  for (size_t chan_index = 0; chan_index < src_data.size(); chan_index++)
+  {
+    auto& values = _aligned_values[chan_index];
+    values.resize(count);
+    AlignSeries(*src_data[chan_index], _time.data(), count, NEAREST, values.data());
+    inputs.push_back(values.data());
+  }
+
+  _results.resize(count);
+  _expression->evaluate(inputs, count, _results.data());
+
+  points.reserve(points.size() + count);
+  for (size_t i = 0; i < count; i++)
+  {
+    points.push_back({ _time[i], _results[i] });
+  }
+}
+
+bool ExpressionCustomFunction::xmlLoadState(const QDomElement& parent_element)
+{
+  bool ret = CustomFunction::xmlLoadState(parent_element);
+  initEngine();
+  return ret;
+}
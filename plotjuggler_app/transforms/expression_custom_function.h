@@ -0,0 +1,50 @@
+#ifndef EXPRESSION_CUSTOM_FUNCTION_H
+#define EXPRESSION_CUSTOM_FUNCTION_H
+
+#include "custom_function.h"
+#include "math_expression.h"
+
+/**
+ * Custom function defined by a single math expression, for instance "sqrt(v1^2 + v2^2)",
+ * calculated without a script interpreter. See MathExpression for the syntax.
+ * The global variables of the snippet are not used.
+ */
+class ExpressionCustomFunction : public CustomFunction
+{
+public:
+  ExpressionCustomFunction(SnippetData snippet = {});
+
+  void initEngine() override;
+
+  void calculatePoints(const std::vector<const PlotData*>& src_data, size_t point_index,
+                       std::vector<PlotData::Point>& points) override;
+
+  void calculatePointsBatch(const std::vector<const PlotData*>& src_data, size_t first,
+                            size_t last, std::vector<PlotData::Point>& points) override;
+
+  QString language() const override
+  {
+    return "EXPRESSION";
+  }
+
+  const char* name() const override
+  {
+    return "ExpressionCustomFunction";
+  }
+
+  bool xmlLoadState(const QDomElement& parent_element) override;
+
+  // each instance has its own engine
+  bool isThreadSafe() const override
+  {
+    return true;
+  }
+
+private:
+  std::unique_ptr<MathExpression> _expression;
+  std::vector<double> _time;
+  std::vector<std::vector<double>> _aligned_values;
+  std::vector<double> _results;
+};
+
+#endif  // EXPRESSION_CUSTOM_FUNCTION_H
@@ -61,6 +61,30 @@ std::optional<PlotData::Point> FirstDerivative::calculateNextPoint(size_t index)
   return out;
 }
 
+void FirstDerivative::calculateBatch(size_t first, size_t last,
+                                     std::vector<PlotData::Point>& out)
+{
+  // the first point has no predecessor
+  first = std::max<size_t>(first, 1);
+  if (first >= last)
+  {
+    return;
+  }
+  const double custom_dt = _dT;
+  out.reserve(out.size() + (last - first));
+
+  auto prev = dataSource()->begin() + (first - 1);
+  const auto end = dataSource()->begin() + last;
+  for (auto it = prev + 1; it != end; ++it, ++prev)
+  {
+    const double dt = (custom_dt == 0.0) ? (it->x - prev->x) : custom_dt;
+    if (dt > 0)
+    {
+      out.push_back({ prev->x, (it->y - prev->y) / dt });
+    }
+  }
+}
+
 QWidget* FirstDerivative::optionsWidget()
 {
   const size_t data_size = dataSource()->size();
@@ -32,9 +32,16 @@ public:
 
   void on_buttonCompute_clicked();
 
+  bool isStateless() const override
+  {
+    return true;
+  }
+
 private:
   std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
 
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
+
   QWidget* _widget;
   Ui::FirstDerivariveForm* ui;
   double _dT;
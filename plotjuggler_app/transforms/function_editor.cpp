@@ -30,6 +30,7 @@
 #include "QLuaHighlighter"
 
 #include "lua_custom_function.h"
+#include "expression_custom_function.h"
 #include "PlotJuggler/svg_util.h"
 #include "ui_function_editor_help.h"
 #include "stylesheet.h"
@@ -134,6 +135,10 @@ FunctionEditorWidget::FunctionEditorWidget(PlotDataMapRef& plotMapData,
 
   ui->functionText->setPlainText(
       settings.value("FunctionEditorWidget.previousFunction", "return value").toString());
+
+  ui->comboLanguage->addItem("Lua", "LUA");
+  ui->comboLanguage->addItem("Math Expression", "EXPRESSION");
+  setCurrentLanguage(settings.value("FunctionEditorWidget.previousLanguage", "LUA").toString());
   ui->functionTextBatch->setPlainText(
       settings.value("FunctionEditorWidget.previousFunctionBatch", "return value").toString());
 
@@ -183,6 +188,7 @@ void FunctionEditorWidget::saveSettings()
                     ui->globalVarsTextBatch->toPlainText());
 
   settings.setValue("FunctionEditorWidget.previousFunction", ui->functionText->toPlainText());
+  settings.setValue("FunctionEditorWidget.previousLanguage", currentLanguage());
   settings.setValue("FunctionEditorWidget.previousFunctionBatch",
                     ui->functionTextBatch->toPlainText());
   int batch_filter_type = 0;
@@ -242,6 +248,7 @@ void FunctionEditorWidget::createNewPlot()
 
 void FunctionEditorWidget::editExistingPlot(CustomPlotPtr data)
 {
+  setCurrentLanguage(data->language());
   ui->globalVarsText->setPlainText(data->snippet().global_vars);
   ui->functionText->setPlainText(data->snippet().function);
   setLinkedPlotName(data->snippet().linked_source);
@@ -354,7 +361,7 @@ void FunctionEditorWidget::importSnippets(const QByteArray& xml_text)
 
   for (const auto& custom_it : _transform_maps)
   {
-    auto math_plot = dynamic_cast<LuaCustomFunction*>(custom_it.second.get());
+    auto math_plot = dynamic_cast<CustomFunction*>(custom_it.second.get());
     if (!math_plot)
     {
       continue;
@@ -393,6 +400,12 @@ void FunctionEditorWidget::on_snippetsListSaved_currentRowChanged(int current_ro
 
   QString preview;
 
+  if (snippet.language == "EXPRESSION")
+  {
+    ui->snippetPreview->setPlainText(snippet.function);
+    return;
+  }
+
   if (!snippet.global_vars.isEmpty())
   {
     preview += snippet.global_vars + "\n\n";
@@ -419,6 +432,7 @@ void FunctionEditorWidget::on_snippetsListSaved_doubleClicked(const QModelIndex&
   const auto& name = ui->snippetsListSaved->item(index.row())->text();
   const SnippetData& snippet = _snipped_saved.at(name);
 
+  setCurrentLanguage(snippet.language);
   ui->globalVarsText->setPlainText(snippet.global_vars);
   ui->functionText->setPlainText(snippet.function);
 }
@@ -542,10 +556,10 @@ void FunctionEditorWidget::on_buttonSaveCurrent_clicked()
     return;
   }
 
-  SnippetData snippet;
+  SnippetData snippet = currentSnippet();
   snippet.alias_name = name;
-  snippet.global_vars = ui->globalVarsText->toPlainText();
-  snippet.function = ui->functionText->toPlainText();
+  snippet.linked_source.clear();
+  snippet.additional_sources.clear();
 
   addToSaved(name, snippet);
 
@@ -632,16 +646,7 @@ void FunctionEditorWidget::on_pushButtonCreate_clicked()
         }
       }
 
-      SnippetData snippet;
-      snippet.function = ui->functionText->toPlainText();
-      snippet.global_vars = ui->globalVarsText->toPlainText();
-      snippet.alias_name = ui->nameLineEdit->text();
-      snippet.linked_source = getLinkedData();
-      for (int row = 0; row < ui->listAdditionalSources->rowCount(); row++)
-      {
-        snippet.additional_sources.push_back(ui->listAdditionalSources->item(row, 1)->text());
-      }
-      created_plots.push_back(std::make_unique<LuaCustomFunction>(snippet));
+      created_plots.push_back(CreateCustomFunction(currentSnippet()));
     }
     else  // ----------- batch ------
     {
@@ -685,7 +690,8 @@ void FunctionEditorWidget::on_pushButtonCancel_pressed()
 
 void FunctionEditorWidget::on_listSourcesChanged()
 {
-  QString function_text("function( time, value");
+  const bool expression = (currentLanguage() == "EXPRESSION");
+  QString function_text(expression ? "expression( time, value" : "function( time, value");
   for (int row = 0; row < ui->listAdditionalSources->rowCount(); row++)
   {
     function_text += ", ";
@@ -797,25 +803,19 @@ void FunctionEditorWidget::onUpdatePreview()
     errors += "- Missing source time series.\n";
   }
 
-  SnippetData snippet;
-  snippet.function = ui->functionText->toPlainText();
-  snippet.global_vars = ui->globalVarsText->toPlainText();
-  snippet.alias_name = ui->nameLineEdit->text();
-  snippet.linked_source = getLinkedData();
-  for (int row = 0; row < ui->listAdditionalSources->rowCount(); row++)
-  {
-    snippet.additional_sources.push_back(ui->listAdditionalSources->item(row, 1)->text());
-  }
+  const SnippetData snippet = currentSnippet();
+  const QString error_prefix =
+      (snippet.language == "EXPRESSION") ? "- Error in expression: %1" : "- Error in Lua script: %1";
 
   CustomPlotPtr lua_function;
   try
   {
-    lua_function = std::make_unique<LuaCustomFunction>(snippet);
+    lua_function = CreateCustomFunction(snippet);
     ui->buttonSaveCurrent->setEnabled(true);
   }
   catch (std::runtime_error& err)
   {
-    errors += QString("- Error in Lua script: %1").arg(err.what());
+    errors += error_prefix.arg(err.what());
     ui->buttonSaveCurrent->setEnabled(false);
   }
 
@@ -837,7 +837,7 @@ void FunctionEditorWidget::onUpdatePreview()
     }
     catch (std::runtime_error& err)
     {
-      errors += QString("- Error in Lua script: %1").arg(err.what());
+      errors += error_prefix.arg(err.what());
     }
   }
 
@@ -977,3 +977,40 @@ void FunctionEditorWidget::on_functionText_textChanged()
 {
   _update_preview_tab1.triggerSignal(250);
 }
+
+void FunctionEditorWidget::on_comboLanguage_currentIndexChanged(int)
+{
+  // math expressions have no global code
+  const bool expression = (currentLanguage() == "EXPRESSION");
+  ui->globalVarsText->setEnabled(!expression);
+  on_listSourcesChanged();
+}
+
+QString FunctionEditorWidget::currentLanguage() const
+{
+  return ui->comboLanguage->currentData().toString();
+}
+
+void FunctionEditorWidget::setCurrentLanguage(const QString& language)
+{
+  int index = ui->comboLanguage->findData(language);
+  ui->comboLanguage->setCurrentIndex(index < 0 ? 0 : index);
+}
+
+SnippetData FunctionEditorWidget::currentSnippet() const
+{
+  SnippetData snippet;
+  snippet.language = currentLanguage();
+  snippet.function = ui->functionText->toPlainText();
+  if (snippet.language != "EXPRESSION")
+  {
+    snippet.global_vars = ui->globalVarsText->toPlainText();
+  }
+  snippet.alias_name = ui->nameLineEdit->text();
+  snippet.linked_source = getLinkedData();
+  for (int row = 0; row < ui->listAdditionalSources->rowCount(); row++)
+  {
+    snippet.additional_sources.push_back(ui->listAdditionalSources->item(row, 1)->text());
+  }
+  return snippet;
+}
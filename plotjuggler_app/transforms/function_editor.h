@@ -104,7 +104,17 @@ private slots:
 
   void on_functionText_textChanged();
 
+  void on_comboLanguage_currentIndexChanged(int index);
+
 private:
+  /// "LUA" or "EXPRESSION", selected in comboLanguage
+  QString currentLanguage() const;
+
+  void setCurrentLanguage(const QString& language);
+
+  /// Snippet of the first tab
+  SnippetData currentSnippet() const;
+
   void importSnippets(const QByteArray& xml_text);
 
   QByteArray exportSnippets() const;
@@ -3,7 +3,7 @@
 #include <QDoubleValidator>
 
 IntegralTransform::IntegralTransform()
-  : _widget(new QWidget()), ui(new Ui::IntegralTransform), _dT(0.0)
+  : _widget(new QWidget()), ui(new Ui::IntegralTransform), _dT(0.0), _accumulated_value(0.0)
 {
   ui->setupUi(_widget);
   ui->lineEditCustom->setValidator(new QDoubleValidator(0.0001, 1000, 4));
@@ -62,6 +62,33 @@ std::optional<PlotData::Point> IntegralTransform::calculateNextPoint(size_t inde
   return out;
 }
 
+void IntegralTransform::calculateBatch(size_t first, size_t last,
+                                       std::vector<PlotData::Point>& out)
+{
+  // the first point has no predecessor
+  first = std::max<size_t>(first, 1);
+  if (first >= last)
+  {
+    return;
+  }
+  const double custom_dt = _dT;
+  double accumulated = _accumulated_value;
+  out.reserve(out.size() + (last - first));
+
+  auto prev = dataSource()->begin() + (first - 1);
+  const auto end = dataSource()->begin() + last;
+  for (auto it = prev + 1; it != end; ++it, ++prev)
+  {
+    const double dt = (custom_dt == 0.0) ? (it->x - prev->x) : custom_dt;
+    if (dt > 0)
+    {
+      accumulated += (it->y + prev->y) * dt / (2.0);
+      out.push_back({ it->x, accumulated });
+    }
+  }
+  _accumulated_value = accumulated;
+}
+
 QWidget* IntegralTransform::optionsWidget()
 {
   const size_t data_size = dataSource()->size();
@@ -79,6 +106,22 @@ void IntegralTransform::reset()
   TransformFunction_SISO::reset();
 }
 
+std::any IntegralTransform::saveState() const
+{
+  return _accumulated_value;
+}
+
+bool IntegralTransform::restoreState(const std::any& state)
+{
+  auto value = std::any_cast<double>(&state);
+  if (!value)
+  {
+    return false;
+  }
+  _accumulated_value = *value;
+  return true;
+}
+
 bool IntegralTransform::xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const
 {
   QDomElement widget_el = doc.createElement("options");
@@ -28,6 +28,10 @@ public:
 
   void reset() override;
 
+  std::any saveState() const override;
+
+  bool restoreState(const std::any& state) override;
+
   bool xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const override;
 
   bool xmlLoadState(const QDomElement& parent_element) override;
@@ -37,6 +41,8 @@ public:
 private:
   std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
 
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
+
   QWidget* _widget;
   Ui::IntegralTransform* ui;
   double _dT;
@@ -0,0 +1,288 @@
+#include "lazy_evaluator.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <QApplication>
+#include <QElapsedTimer>
+#include "PlotJuggler/performance_monitor.h"
+#include "custom_function.h"
+
+using namespace PJ;
+
+// duration of the work done by each timeout of the timer
+static constexpr int TIME_SLICE_MS = 20;
+// points of the source processed by each call of calculate() in the background
+static constexpr size_t BLOCK_SIZE = 16384;
+// maximum number of points of the source calculated by preview()
+static constexpr size_t MAX_PREVIEW_POINTS = 200000;
+
+// an evaluation range that contains no point
+static const Range EMPTY_RANGE = { std::numeric_limits<double>::lowest(),
+                                   std::numeric_limits<double>::lowest() };
+
+static size_t LowerIndex(const PlotData& data, double time)
+{
+  auto it = std::lower_bound(data.begin(), data.end(), time,
+                             [](const PlotData::Point& p, double x) { return p.x < x; });
+  return std::distance(data.begin(), it);
+}
+
+static size_t UpperIndex(const PlotData& data, double time)
+{
+  auto it = std::upper_bound(data.begin(), data.end(), time,
+                             [](double x, const PlotData::Point& p) { return x < p.x; });
+  return std::distance(data.begin(), it);
+}
+
+// reset() does not reinitialize the engine of a custom function (see
+// CustomFunction::reset()): the global variables of the script, for instance
+// the ones of an integral, would keep the values of the previous evaluation.
+static void Restart(TransformFunction& function)
+{
+  function.reset();
+  if (auto custom = dynamic_cast<CustomFunction*>(&function))
+  {
+    custom->initEngine();
+  }
+}
+
+static const PlotData* MainSource(TransformFunction& function)
+{
+  auto sources = function.dependencies();
+  return sources.empty() ? nullptr : sources.front();
+}
+
+LazyEvaluator::LazyEvaluator(QObject* parent) : QObject(parent), _timer(new QTimer(this))
+{
+  // a timeout of 0 ms is processed when there are no other events
+  _timer->setInterval(0);
+  connect(_timer, &QTimer::timeout, this, &LazyEvaluator::onTimeout);
+}
+
+bool LazyEvaluator::add(const std::string& id, TransformFunction::Ptr function)
+{
+  cancel(id);
+  if (!function->supportsEvaluationRange() || function->dataDestinations().size() != 1 ||
+      !MainSource(*function))
+  {
+    return false;
+  }
+
+  Task task;
+  task.id = id;
+  task.function = function;
+  task.destination = function->dataDestinations().front();
+  task.destination->clear();
+
+  // nothing is calculated until preview() or the background evaluation
+  Restart(*function);
+  function->setEvaluationRange(EMPTY_RANGE);
+
+  _tasks.push_back(std::move(task));
+  _timer->start();
+  return true;
+}
+
+void LazyEvaluator::preview(Range visible, double tracker_time)
+{
+  const double margin = 0.5 * (visible.max - visible.min);
+
+  std::deque<Task>::iterator it = _tasks.begin();
+  while (it != _tasks.end())
+  {
+    Task& task = *it;
+    const PlotData* source = MainSource(*task.function);
+    if (task.staging || !source || source->size() == 0)
+    {
+      it++;
+      continue;
+    }
+
+    size_t first = LowerIndex(*source, visible.min - margin);
+    size_t last = UpperIndex(*source, visible.max + margin);
+    if (last - first > MAX_PREVIEW_POINTS)
+    {
+      const size_t center = std::clamp(LowerIndex(*source, tracker_time), first, last);
+      first = center - std::min(center - first, MAX_PREVIEW_POINTS / 2);
+      last = std::min(last, first + MAX_PREVIEW_POINTS);
+    }
+    if (first >= last)
+    {
+      it++;
+      continue;
+    }
+
+    try
+    {
+      PerformanceMonitor::ScopedTimer timer("Transform",
+                                            [&task]() { return task.id + " (preview)"; });
+      task.function->setEvaluationRange({ source->at(first).x, source->at(last - 1).x });
+      task.function->calculate();
+      // the background evaluation starts from the first point
+      Restart(*task.function);
+      task.function->setEvaluationRange(EMPTY_RANGE);
+      it++;
+    }
+    catch (...)
+    {
+      restore(task);
+      _tasks.erase(it);
+      throw;
+    }
+  }
+}
+
+void LazyEvaluator::finishAll()
+{
+  if (_tasks.empty())
+  {
+    return;
+  }
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  while (!_tasks.empty())
+  {
+    Task task = std::move(_tasks.front());
+    _tasks.pop_front();
+    try
+    {
+      advance(task, std::numeric_limits<size_t>::max());
+      emit finished(QString::fromStdString(task.id));
+    }
+    catch (std::exception& err)
+    {
+      restore(task);
+      qWarning("Failed to calculate [%s]: %s", task.id.c_str(), err.what());
+      emit progressChanged(QString::fromStdString(task.id), 1.0);
+    }
+  }
+  _timer->stop();
+  QApplication::restoreOverrideCursor();
+}
+
+void LazyEvaluator::cancel(const std::string& id)
+{
+  auto it = std::find_if(_tasks.begin(), _tasks.end(),
+                         [&id](const Task& task) { return task.id == id; });
+  if (it != _tasks.end())
+  {
+    restore(*it);
+    _tasks.erase(it);
+  }
+}
+
+void LazyEvaluator::cancelAll()
+{
+  for (auto& task : _tasks)
+  {
+    restore(task);
+  }
+  _tasks.clear();
+  _timer->stop();
+}
+
+void LazyEvaluator::onTimeout()
+{
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  while (!_tasks.empty() && elapsed.elapsed() < TIME_SLICE_MS)
+  {
+    Task& task = _tasks.front();
+    const QString id = QString::fromStdString(task.id);
+    try
+    {
+      if (!advance(task, BLOCK_SIZE))
+      {
+        const PlotData* source = MainSource(*task.function);
+        emit progressChanged(id, double(task.processed) / double(source->size()));
+        continue;
+      }
+      _tasks.pop_front();
+      emit finished(id);
+    }
+    catch (std::exception& err)
+    {
+      restore(task);
+      _tasks.pop_front();
+      qWarning("Failed to calculate [%s]: %s", qPrintable(id), err.what());
+      emit progressChanged(id, 1.0);
+    }
+  }
+
+  if (_tasks.empty())
+  {
+    _timer->stop();
+  }
+}
+
+void LazyEvaluator::start(Task& task)
+{
+  task.staging =
+      std::make_unique<PlotData>(task.destination->plotName(), task.destination->group());
+  task.processed = 0;
+
+  auto sources = task.function->dataSources();
+  std::vector<PlotData*> destinations = { task.staging.get() };
+  Restart(*task.function);
+  task.function->setData(task.function->plotData(), sources, destinations);
+}
+
+bool LazyEvaluator::advance(Task& task, size_t count)
+{
+  if (!task.staging)
+  {
+    start(task);
+  }
+  const PlotData* source = MainSource(*task.function);
+  if (!source)
+  {
+    throw std::runtime_error("the source was removed");
+  }
+
+  PerformanceMonitor::ScopedTimer timer("Transform", task.id);
+  const size_t size = source->size();
+  if (count >= size - std::min(size, task.processed))
+  {
+    task.function->clearEvaluationRange();
+    task.function->calculate();
+    complete(task);
+    return true;
+  }
+
+  // the points with the same time are processed together
+  const double time = source->at(task.processed + count - 1).x;
+  task.function->setEvaluationRange({ std::numeric_limits<double>::lowest(), time });
+  task.function->calculate();
+  task.processed = UpperIndex(*source, time);
+  return false;
+}
+
+void LazyEvaluator::complete(Task& task)
+{
+  PlotData* destination = task.destination;
+  destination->clear();
+  for (const auto& point : *task.staging)
+  {
+    destination->pushBack(point);
+  }
+  destination->setMaximumRangeX(task.staging->maximumRangeX());
+
+  auto sources = task.function->dataSources();
+  std::vector<PlotData*> destinations = { destination };
+  task.function->setData(task.function->plotData(), sources, destinations);
+  task.staging.reset();
+}
+
+void LazyEvaluator::restore(Task& task)
+{
+  if (task.staging)
+  {
+    auto sources = task.function->dataSources();
+    std::vector<PlotData*> destinations = { task.destination };
+    task.function->setData(task.function->plotData(), sources, destinations);
+    task.staging.reset();
+  }
+  task.function->clearEvaluationRange();
+  Restart(*task.function);
+  task.destination->clear();
+}
@@ -0,0 +1,95 @@
+#ifndef LAZY_EVALUATOR_H
+#define LAZY_EVALUATOR_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <QObject>
+#include <QTimer>
+#include "PlotJuggler/transform_function.h"
+
+// Lazy evaluation of the derived series, used when a layout is loaded or a
+// custom function is created.
+//
+// add() clears the destination of a transform and queues it. preview()
+// calculates the points of the queued transforms inside the visible time range
+// (plus a margin), that can be displayed immediately.
+//
+// The entire source is then processed in the background, one transform at a
+// time and in the order they were added, so that a transform reads the
+// complete result of the ones it depends on. The work is split into short
+// time slices executed by the event loop of the main thread when it is idle:
+// the series can't be read by another thread, since the GUI modifies them.
+// The result is written into a staging series that replaces the content of
+// the destination when it is complete: until then, the preview is displayed.
+//
+// Only the transforms that support TransformFunction::setEvaluationRange()
+// can be evaluated lazily. The engine of a custom function is reinitialized
+// before each evaluation, so the state of the script left by the preview is
+// not used by the background evaluation.
+class LazyEvaluator : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit LazyEvaluator(QObject* parent = nullptr);
+
+  // Returns false if the transform must be calculated as usual.
+  // A transform with the same id already queued is cancelled.
+  bool add(const std::string& id, PJ::TransformFunction::Ptr function);
+
+  // Calculate the points of the queued transforms in the range visible (plus
+  // a margin). If they are too many, only the ones around tracker_time.
+  // Throws if a transform fails; it is removed from the queue.
+  void preview(PJ::Range visible, double tracker_time);
+
+  bool empty() const
+  {
+    return _tasks.empty();
+  }
+
+  // Complete the evaluation of all the queued transforms now: used before
+  // the data is exported or its statistics are calculated.
+  void finishAll();
+
+  // Remove a transform from the queue: its destination is cleared, and the
+  // next calculate() will process the entire source.
+  // It must be called before the transform or its destination are deleted.
+  void cancel(const std::string& id);
+
+  void cancelAll();
+
+signals:
+  // fraction of the source processed in the background; 1 if the evaluation failed
+  void progressChanged(QString id, double progress);
+
+  void finished(QString id);
+
+private:
+  struct Task
+  {
+    std::string id;
+    PJ::TransformFunction::Ptr function;
+    PJ::PlotData* destination = nullptr;
+    // the destination of the function during the background evaluation
+    std::unique_ptr<PJ::PlotData> staging;
+    // number of points of the source processed in the background
+    size_t processed = 0;
+  };
+
+  std::deque<Task> _tasks;
+  QTimer* _timer;
+
+  void onTimeout();
+
+  // process count points of the source more. Returns true when complete
+  bool advance(Task& task, size_t count);
+
+  void start(Task& task);
+
+  void complete(Task& task);
+
+  void restore(Task& task);
+};
+
+#endif  // LAZY_EVALUATOR_H
@@ -1,5 +1,9 @@
 #include "lua_custom_function.h"
+#include "PlotJuggler/lua_engine.h"
+#include "PlotJuggler/time_alignment.h"
 #include <QTextStream>
+#include <algorithm>
+#include <cmath>
 
 LuaCustomFunction::LuaCustomFunction(SnippetData snippet) : CustomFunction(snippet)
 {
@@ -27,8 +31,23 @@ void LuaCustomFunction::initEngine()
   std::unique_lock<std::mutex> lk(mutex_);
 
   _lua_function = {};
+  _lua_batch_function = {};
+  _lua_ffi_function = {};
+  _ffi_array = {};
   _lua_engine = {};
   _lua_engine.open_libraries();
+  LuaEngine::configure(_lua_engine.lua_state());
+
+#ifdef PJ_USE_LUAJIT
+  // views of the aligned buffers, indexed from 1 like the Lua arrays
+  sol::protected_function_result ffi_helper = _lua_engine.safe_script(R"(
+    local ffi = require("ffi")
+    return function(ptr, writable)
+      return ffi.cast(writable and "double*" or "const double*", ptr) - 1
+    end)");
+  _ffi_array = ffi_helper.get<sol::protected_function>();
+#endif
+
   auto result = _lua_engine.safe_script(_snippet.global_vars.toStdString());
   if (!result.valid())
   {
@@ -50,70 +69,88 @@ void LuaCustomFunction::initEngine()
     throw std::runtime_error(getError(err));
   }
   _lua_function = _lua_engine["calc"];
+
+  sol::object batch_function = _lua_engine["calc_batch"];
+  if (batch_function.get_type() == sol::type::function)
+  {
+    _lua_batch_function = batch_function;
+  }
+  sol::object ffi_function = _lua_engine["calc_batch_ffi"];
+  if (ffi_function.get_type() == sol::type::function)
+  {
+    _lua_ffi_function = ffi_function;
+  }
 }
 
 void LuaCustomFunction::calculatePoints(const std::vector<const PlotData*>& src_data,
                                         size_t point_index, std::vector<PlotData::Point>& points)
 {
   std::unique_lock<std::mutex> lk(mutex_);
+  calculateRange(src_data, point_index, point_index + 1, points);
+}
 
-  _chan_values.resize(src_data.size());
+void LuaCustomFunction::calculatePointsBatch(const std::vector<const PlotData*>& src_data,
+                                             size_t first, size_t last,
+                                             std::vector<PlotData::Point>& points)
+{
+  std::unique_lock<std::mutex> lk(mutex_);
+  calculateRange(src_data, first, last, points);
+}
 
-  const PlotData::Point& old_point = src_data.front()->at(point_index);
+void LuaCustomFunction::calculateRange(const std::vector<const PlotData*>& src_data,
+                                       size_t first, size_t last,
+                                       std::vector<PlotData::Point>& points)
+{
+  if (first >= last)
+  {
+    return;
+  }
+  const PlotData& main_data = *src_data.front();
+
+  _aligned_time.resize(last - first);
+  for (size_t i = first; i < last; i++)
+  {
+    _aligned_time[i - first] = main_data.at(i).x;
+  }
 
+  // the values of the other channels at the same time (nearest sample)
+  _aligned_values.resize(src_data.size());
   for (size_t chan_index = 0; chan_index < src_data.size(); chan_index++)
   {
-    double value;
-    const PlotData* chan_data = src_data[chan_index];
-    int index = chan_data->getIndexFromX(old_point.x);
-    if (index != -1)
-    {
-      value = chan_data->at(index).y;
-    }
-    else
-    {
-      value = std::numeric_limits<double>::quiet_NaN();
-    }
-    _chan_values[chan_index] = value;
-  }
-
-  sol::safe_function_result result;
-  const auto& v = _chan_values;
-  // ugly code, sorry
-  switch (_snippet.additional_sources.size())
-  {
-    case 0:
-      result = _lua_function(old_point.x, v[0]);
-      break;
-    case 1:
-      result = _lua_function(old_point.x, v[0], v[1]);
-      break;
-    case 2:
-      result = _lua_function(old_point.x, v[0], v[1], v[2]);
-      break;
-    case 3:
-      result = _lua_function(old_point.x, v[0], v[1], v[2], v[3]);
-      break;
-    case 4:
-      result = _lua_function(old_point.x, v[0], v[1], v[2], v[3], v[4]);
-      break;
-    case 5:
-      result = _lua_function(old_point.x, v[0], v[1], v[2], v[3], v[4], v[5]);
-      break;
-    case 6:
-      result = _lua_function(old_point.x, v[0], v[1], v[2], v[3], v[4], v[5], v[6]);
-      break;
-    case 7:
-      result = _lua_function(old_point.x, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
-      break;
-    case 8:
-      result = _lua_function(old_point.x, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8]);
-      break;
-    default:
-      throw std::runtime_error("Lua Engine: maximum number of additional data sources is "
-                               "8");
+    auto& values = _aligned_values[chan_index];
+    values.resize(_aligned_time.size());
+    AlignSeries(*src_data[chan_index], _aligned_time.data(), _aligned_time.size(), NEAREST,
+                values.data());
   }
 
+  if (_lua_ffi_function.valid())
+  {
+    callFfiFunction(points);
+    return;
+  }
+  if (_lua_batch_function.valid())
+  {
+    callBatchFunction(points);
+    return;
+  }
+
+  _chan_values.resize(src_data.size());
+  for (size_t offset = 0; offset < _aligned_time.size(); offset++)
+  {
+    callFunction(offset, points);
+  }
+}
+
+void LuaCustomFunction::callFunction(size_t offset, std::vector<PlotData::Point>& points)
+{
+  for (size_t chan_index = 0; chan_index < _aligned_values.size(); chan_index++)
+  {
+    _chan_values[chan_index] = _aligned_values[chan_index][offset];
+  }
+  const double time = _aligned_time[offset];
+
+  sol::safe_function_result result = _lua_function(time, sol::as_args(_chan_values));
+
   if (!result.valid())
   {
     sol::error err = result;
@@ -130,16 +167,13 @@ void LuaCustomFunction::calculatePoints(const std::vector<const PlotData*>& src_
   else if (result.return_count() == 1 && result.get_type(0) == sol::type::number)
   {
     PlotData::Point new_point;
-    new_point.x = old_point.x;
+    new_point.x = time;
     new_point.y = result.get<double>(0);
     points.push_back(new_point);
   }
   else if (result.return_count() == 1 && result.get_type(0) == sol::type::table)
   {
-    static std::vector<std::array<double, 2>> multi_samples;
-    multi_samples.clear();
-
-    multi_samples = result.get<std::vector<std::array<double, 2>>>(0);
+    auto multi_samples = result.get<std::vector<std::array<double, 2>>>(0);
 
     for (std::array<double, 2> sample : multi_samples)
     {
@@ -157,6 +191,124 @@ void LuaCustomFunction::calculatePoints(const std::vector<const PlotData*>& src_
   }
 }
 
+void LuaCustomFunction::callBatchFunction(std::vector<PlotData::Point>& points)
+{
+  const size_t count = _aligned_time.size();
+
+  std::vector<sol::table> arguments;
+  arguments.reserve(_aligned_values.size() + 1);
+  arguments.push_back(createArray(_aligned_time));
+  for (const auto& values : _aligned_values)
+  {
+    arguments.push_back(createArray(values));
+  }
+
+  sol::safe_function_result result = _lua_batch_function(sol::as_args(arguments));
+
+  if (!result.valid())
+  {
+    sol::error err = result;
+    throw std::runtime_error(getError(err));
+  }
+
+  if (result.return_count() == 1 && result.get_type(0) == sol::type::table)
+  {
+    auto values = result.get<std::vector<double>>(0);
+    if (values.size() != count)
+    {
+      throw std::runtime_error("calc_batch: the returned array must have the same size of "
+                               "the array [time]");
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      points.push_back({ _aligned_time[i], values[i] });
+    }
+  }
+  else if (result.return_count() == 2 && result.get_type(0) == sol::type::table &&
+           result.get_type(1) == sol::type::table)
+  {
+    auto times = result.get<std::vector<double>>(0);
+    auto values = result.get<std::vector<double>>(1);
+    if (times.size() != values.size())
+    {
+      throw std::runtime_error("calc_batch: the returned arrays [time] and [value] must "
+                               "have the same size");
+    }
+    for (size_t i = 0; i < times.size(); i++)
+    {
+      points.push_back({ times[i], values[i] });
+    }
+  }
+  else
+  {
+    throw std::runtime_error("Wrong return object of calc_batch: expecting either an "
+                             "array of values or two arrays (time, value)");
+  }
+}
+
+void LuaCustomFunction::callFfiFunction(std::vector<PlotData::Point>& points)
+{
+  const size_t count = _aligned_time.size();
+  _ffi_output.assign(count, std::numeric_limits<double>::quiet_NaN());
+
+  std::vector<sol::object> arguments;
+  arguments.reserve(_aligned_values.size() + 3);
+  arguments.push_back(sol::make_object(_lua_engine, count));
+
+#ifdef PJ_USE_LUAJIT
+  // LuaJIT: the function reads and writes directly our buffers
+  auto view = [this](const std::vector<double>& buffer, bool writable) {
+    void* data = const_cast<double*>(buffer.data());
+    sol::protected_function_result result = _ffi_array(data, writable);
+    return result.get<sol::object>();
+  };
+  arguments.push_back(view(_ffi_output, true));
+  arguments.push_back(view(_aligned_time, false));
+  for (const auto& values : _aligned_values)
+  {
+    arguments.push_back(view(values, false));
+  }
+#else
+  // reference interpreter: same interface, using Lua arrays
+  sol::table output = _lua_engine.create_table(static_cast<int>(count), 0);
+  arguments.push_back(output);
+  arguments.push_back(createArray(_aligned_time));
+  for (const auto& values : _aligned_values)
+  {
+    arguments.push_back(createArray(values));
+  }
+#endif
+
+  sol::safe_function_result result = _lua_ffi_function(sol::as_args(arguments));
+  if (!result.valid())
+  {
+    sol::error err = result;
+    throw std::runtime_error(getError(err));
+  }
+
+#ifndef PJ_USE_LUAJIT
+  for (size_t i = 0; i < count; i++)
+  {
+    _ffi_output[i] = output.get_or(i + 1, std::numeric_limits<double>::quiet_NaN());
+  }
+#endif
+
+  for (size_t i = 0; i < count; i++)
+  {
+    points.push_back({ _aligned_time[i], _ffi_output[i] });
+  }
+}
+
+sol::table LuaCustomFunction::createArray(const std::vector<double>& values)
+{
+  sol::table array = _lua_engine.create_table(static_cast<int>(values.size()), 0);
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    array.raw_set(i + 1, values[i]);
+  }
+  return array;
+}
+
 bool LuaCustomFunction::xmlLoadState(const QDomElement& parent_element)
 {
   bool ret = CustomFunction::xmlLoadState(parent_element);
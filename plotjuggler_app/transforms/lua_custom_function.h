@@ -16,6 +16,9 @@ public:
   void calculatePoints(const std::vector<const PlotData*>& channels_data, size_t point_index,
                        std::vector<PlotData::Point>& points) override;
 
+  void calculatePointsBatch(const std::vector<const PlotData*>& src_data, size_t first,
+                            size_t last, std::vector<PlotData::Point>& points) override;
+
   QString language() const override
   {
     return "LUA";
@@ -28,15 +31,42 @@ public:
 
   bool xmlLoadState(const QDomElement& parent_element) override;
 
+  // each instance has its own engine
+  bool isThreadSafe() const override
+  {
+    return true;
+  }
+
   std::string getError(sol::error err);
 
 private:
   sol::state _lua_engine;
   sol::protected_function _lua_function;
+  // optional calc_batch(time, value, v1, ...) defined in the global code
+  sol::protected_function _lua_batch_function;
+  // optional calc_batch_ffi(count, out, time, value, v1, ...) defined in the global code
+  sol::protected_function _lua_ffi_function;
+  // with LuaJIT, returns a 1-based FFI pointer to a buffer of doubles
+  sol::protected_function _ffi_array;
+  std::vector<double> _ffi_output;
   std::vector<double> _chan_values;
+  // values of each channel, aligned to the timestamps of the main source
+  std::vector<std::vector<double>> _aligned_values;
+  std::vector<double> _aligned_time;
   std::mutex mutex_;
   int global_lines_ = 0;
   int function_lines_ = 0;
+
+  void calculateRange(const std::vector<const PlotData*>& src_data, size_t first, size_t last,
+                      std::vector<PlotData::Point>& points);
+
+  void callFunction(size_t offset, std::vector<PlotData::Point>& points);
+
+  void callBatchFunction(std::vector<PlotData::Point>& points);
+
+  void callFfiFunction(std::vector<PlotData::Point>& points);
+
+  sol::table createArray(const std::vector<double>& values);
 };
 
 #endif  // LUA_CUSTOM_FUNCTION_H
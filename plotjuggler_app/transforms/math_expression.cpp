@@ -0,0 +1,792 @@
+#include "math_expression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <locale>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+enum class Op
+{
+  // unary
+  NEG,
+  NOT,
+  ABS,
+  SQRT,
+  EXP,
+  LOG,
+  LOG10,
+  LOG2,
+  SIN,
+  COS,
+  TAN,
+  ASIN,
+  ACOS,
+  ATAN,
+  SINH,
+  COSH,
+  TANH,
+  FLOOR,
+  CEIL,
+  ROUND,
+  SIGN,
+  SQUARE,
+  // binary
+  ADD,
+  SUB,
+  MUL,
+  DIV,
+  MOD,
+  POW,
+  ATAN2,
+  HYPOT,
+  MIN,
+  MAX,
+  LT,
+  LE,
+  GT,
+  GE,
+  EQ,
+  NE,
+  AND,
+  OR,
+  // ternary
+  IF
+};
+
+struct FunctionInfo
+{
+  Op op;
+  // -1 for min() and max(), that accept two or more arguments
+  int arity;
+};
+
+const std::map<std::string, FunctionInfo>& Functions()
+{
+  static const std::map<std::string, FunctionInfo> functions = {
+    { "abs", { Op::ABS, 1 } },       { "sqrt", { Op::SQRT, 1 } },   { "exp", { Op::EXP, 1 } },
+    { "log", { Op::LOG, 1 } },       { "log10", { Op::LOG10, 1 } }, { "log2", { Op::LOG2, 1 } },
+    { "sin", { Op::SIN, 1 } },       { "cos", { Op::COS, 1 } },     { "tan", { Op::TAN, 1 } },
+    { "asin", { Op::ASIN, 1 } },     { "acos", { Op::ACOS, 1 } },   { "atan", { Op::ATAN, 1 } },
+    { "sinh", { Op::SINH, 1 } },     { "cosh", { Op::COSH, 1 } },   { "tanh", { Op::TANH, 1 } },
+    { "floor", { Op::FLOOR, 1 } },   { "ceil", { Op::CEIL, 1 } },   { "round", { Op::ROUND, 1 } },
+    { "sign", { Op::SIGN, 1 } },     { "atan2", { Op::ATAN2, 2 } }, { "hypot", { Op::HYPOT, 2 } },
+    { "pow", { Op::POW, 2 } },       { "fmod", { Op::MOD, 2 } },    { "min", { Op::MIN, -1 } },
+    { "max", { Op::MAX, -1 } },      { "if", { Op::IF, 3 } },
+  };
+  return functions;
+}
+
+// operand of an instruction: a constant (data == nullptr) or an array
+struct Arg
+{
+  const double* data = nullptr;
+  double value = 0;
+};
+
+template <typename F>
+void Map1(size_t n, double* out, const Arg& a, F f)
+{
+  if (a.data)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = f(a.data[i]);
+    }
+  }
+  else
+  {
+    std::fill(out, out + n, f(a.value));
+  }
+}
+
+// separate loops for the combinations of arrays and constants, to let
+// the compiler vectorize them
+template <typename F>
+void Map2(size_t n, double* out, const Arg& a, const Arg& b, F f)
+{
+  if (a.data && b.data)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = f(a.data[i], b.data[i]);
+    }
+  }
+  else if (a.data)
+  {
+    const double y = b.value;
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = f(a.data[i], y);
+    }
+  }
+  else if (b.data)
+  {
+    const double x = a.value;
+    for (size_t i = 0; i < n; i++)
+    {
+      out[i] = f(x, b.data[i]);
+    }
+  }
+  else
+  {
+    std::fill(out, out + n, f(a.value, b.value));
+  }
+}
+
+double Sign(double x)
+{
+  return (x > 0) ? 1.0 : ((x < 0) ? -1.0 : x);
+}
+
+double Mod(double x, double y)
+{
+  // same as Lua: the result has the sign of y
+  const double m = std::fmod(x, y);
+  return (m != 0 && ((m < 0) != (y < 0))) ? m + y : m;
+}
+
+void Execute(Op op, size_t n, double* out, const Arg& a, const Arg& b, const Arg& c)
+{
+  switch (op)
+  {
+    // clang-format off
+    case Op::NEG:    Map1(n, out, a, [](double x) { return -x; }); break;
+    case Op::NOT:    Map1(n, out, a, [](double x) { return x == 0 ? 1.0 : 0.0; }); break;
+    case Op::ABS:    Map1(n, out, a, [](double x) { return std::abs(x); }); break;
+    case Op::SQRT:   Map1(n, out, a, [](double x) { return std::sqrt(x); }); break;
+    case Op::EXP:    Map1(n, out, a, [](double x) { return std::exp(x); }); break;
+    case Op::LOG:    Map1(n, out, a, [](double x) { return std::log(x); }); break;
+    case Op::LOG10:  Map1(n, out, a, [](double x) { return std::log10(x); }); break;
+    case Op::LOG2:   Map1(n, out, a, [](double x) { return std::log2(x); }); break;
+    case Op::SIN:    Map1(n, out, a, [](double x) { return std::sin(x); }); break;
+    case Op::COS:    Map1(n, out, a, [](double x) { return std::cos(x); }); break;
+    case Op::TAN:    Map1(n, out, a, [](double x) { return std::tan(x); }); break;
+    case Op::ASIN:   Map1(n, out, a, [](double x) { return std::asin(x); }); break;
+    case Op::ACOS:   Map1(n, out, a, [](double x) { return std::acos(x); }); break;
+    case Op::ATAN:   Map1(n, out, a, [](double x) { return std::atan(x); }); break;
+    case Op::SINH:   Map1(n, out, a, [](double x) { return std::sinh(x); }); break;
+    case Op::COSH:   Map1(n, out, a, [](double x) { return std::cosh(x); }); break;
+    case Op::TANH:   Map1(n, out, a, [](double x) { return std::tanh(x); }); break;
+    case Op::FLOOR:  Map1(n, out, a, [](double x) { return std::floor(x); }); break;
+    case Op::CEIL:   Map1(n, out, a, [](double x) { return std::ceil(x); }); break;
+    case Op::ROUND:  Map1(n, out, a, [](double x) { return std::round(x); }); break;
+    case Op::SIGN:   Map1(n, out, a, Sign); break;
+    case Op::SQUARE: Map1(n, out, a, [](double x) { return x * x; }); break;
+
+    case Op::ADD:    Map2(n, out, a, b, [](double x, double y) { return x + y; }); break;
+    case Op::SUB:    Map2(n, out, a, b, [](double x, double y) { return x - y; }); break;
+    case Op::MUL:    Map2(n, out, a, b, [](double x, double y) { return x * y; }); break;
+    case Op::DIV:    Map2(n, out, a, b, [](double x, double y) { return x / y; }); break;
+    case Op::MOD:    Map2(n, out, a, b, Mod); break;
+    case Op::POW:    Map2(n, out, a, b, [](double x, double y) { return std::pow(x, y); }); break;
+    case Op::ATAN2:  Map2(n, out, a, b, [](double x, double y) { return std::atan2(x, y); }); break;
+    case Op::HYPOT:  Map2(n, out, a, b, [](double x, double y) { return std::hypot(x, y); }); break;
+    case Op::MIN:    Map2(n, out, a, b, [](double x, double y) { return std::min(x, y); }); break;
+    case Op::MAX:    Map2(n, out, a, b, [](double x, double y) { return std::max(x, y); }); break;
+    case Op::LT:     Map2(n, out, a, b, [](double x, double y) { return x < y ? 1.0 : 0.0; }); break;
+    case Op::LE:     Map2(n, out, a, b, [](double x, double y) { return x <= y ? 1.0 : 0.0; }); break;
+    case Op::GT:     Map2(n, out, a, b, [](double x, double y) { return x > y ? 1.0 : 0.0; }); break;
+    case Op::GE:     Map2(n, out, a, b, [](double x, double y) { return x >= y ? 1.0 : 0.0; }); break;
+    case Op::EQ:     Map2(n, out, a, b, [](double x, double y) { return x == y ? 1.0 : 0.0; }); break;
+    case Op::NE:     Map2(n, out, a, b, [](double x, double y) { return x != y ? 1.0 : 0.0; }); break;
+    case Op::AND:    Map2(n, out, a, b, [](double x, double y) { return (x != 0 && y != 0) ? 1.0 : 0.0; }); break;
+    case Op::OR:     Map2(n, out, a, b, [](double x, double y) { return (x != 0 || y != 0) ? 1.0 : 0.0; }); break;
+      // clang-format on
+
+    case Op::IF:
+      for (size_t i = 0; i < n; i++)
+      {
+        const double cond = a.data ? a.data[i] : a.value;
+        const Arg& selected = (cond != 0) ? b : c;
+        out[i] = selected.data ? selected.data[i] : selected.value;
+      }
+      break;
+  }
+}
+
+//---------------------------------------------------------------
+
+struct Node
+{
+  enum Kind
+  {
+    CONSTANT,
+    VARIABLE,
+    OPERATION
+  };
+  Kind kind = CONSTANT;
+  double value = 0;
+  size_t variable = 0;
+  Op op = Op::ADD;
+  std::vector<std::unique_ptr<Node>> args;
+};
+
+using NodePtr = std::unique_ptr<Node>;
+
+NodePtr MakeConstant(double value)
+{
+  auto node = std::make_unique<Node>();
+  node->kind = Node::CONSTANT;
+  node->value = value;
+  return node;
+}
+
+bool IsConstant(const NodePtr& node, double value)
+{
+  return node->kind == Node::CONSTANT && node->value == value;
+}
+
+NodePtr MakeOperation(Op op, std::vector<NodePtr> args);
+
+NodePtr MakeUnary(Op op, NodePtr a)
+{
+  std::vector<NodePtr> args;
+  args.push_back(std::move(a));
+  return MakeOperation(op, std::move(args));
+}
+
+// create an operation, folding the constants
+NodePtr MakeOperation(Op op, std::vector<NodePtr> args)
+{
+  bool all_constants = true;
+  for (const auto& arg : args)
+  {
+    all_constants &= (arg->kind == Node::CONSTANT);
+  }
+  if (all_constants)
+  {
+    Arg a[3];
+    for (size_t i = 0; i < args.size(); i++)
+    {
+      a[i].value = args[i]->value;
+    }
+    double result = 0;
+    Execute(op, 1, &result, a[0], a[1], a[2]);
+    return MakeConstant(result);
+  }
+
+  if (op == Op::IF && args[0]->kind == Node::CONSTANT)
+  {
+    return std::move(args[0]->value != 0 ? args[1] : args[2]);
+  }
+  if (op == Op::POW && IsConstant(args[1], 2.0))
+  {
+    return MakeUnary(Op::SQUARE, std::move(args[0]));
+  }
+  if (op == Op::POW && IsConstant(args[1], 0.5))
+  {
+    return MakeUnary(Op::SQRT, std::move(args[0]));
+  }
+
+  auto node = std::make_unique<Node>();
+  node->kind = Node::OPERATION;
+  node->op = op;
+  node->args = std::move(args);
+  return node;
+}
+
+NodePtr MakeOperation(Op op, NodePtr a, NodePtr b)
+{
+  std::vector<NodePtr> args;
+  args.push_back(std::move(a));
+  args.push_back(std::move(b));
+  return MakeOperation(op, std::move(args));
+}
+
+//---------------------------------------------------------------
+
+class Parser
+{
+public:
+  Parser(const std::string& text, const std::vector<std::string>& variables)
+    : _text(text), _variables(variables)
+  {
+  }
+
+  NodePtr parse()
+  {
+    skipSpaces();
+    if (matchWord("return"))
+    {
+      skipSpaces();
+    }
+    if (_pos >= _text.size())
+    {
+      throw std::runtime_error("[Expression]: the expression is empty");
+    }
+    NodePtr node = parseOr();
+    skipSpaces();
+    if (_pos < _text.size())
+    {
+      error("unexpected character '" + std::string(1, _text[_pos]) + "'");
+    }
+    return node;
+  }
+
+private:
+  const std::string& _text;
+  const std::vector<std::string>& _variables;
+  size_t _pos = 0;
+
+  [[noreturn]] void error(const std::string& msg) const
+  {
+    throw std::runtime_error("[Expression]: " + msg + " at position " + std::to_string(_pos + 1));
+  }
+
+  void skipSpaces()
+  {
+    while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos])))
+    {
+      _pos++;
+    }
+  }
+
+  static bool isIdentifierChar(char c)
+  {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  }
+
+  bool match(const char* symbol)
+  {
+    skipSpaces();
+    const size_t len = std::char_traits<char>::length(symbol);
+    if (_text.compare(_pos, len, symbol) == 0)
+    {
+      _pos += len;
+      return true;
+    }
+    return false;
+  }
+
+  // match a keyword, that must not be followed by other identifier characters
+  bool matchWord(const char* word)
+  {
+    skipSpaces();
+    const size_t len = std::char_traits<char>::length(word);
+    if (_text.compare(_pos, len, word) == 0 &&
+        (_pos + len >= _text.size() || !isIdentifierChar(_text[_pos + len])))
+    {
+      _pos += len;
+      return true;
+    }
+    return false;
+  }
+
+  NodePtr parseOr()
+  {
+    NodePtr node = parseAnd();
+    while (match("||") || matchWord("or"))
+    {
+      node = MakeOperation(Op::OR, std::move(node), parseAnd());
+    }
+    return node;
+  }
+
+  NodePtr parseAnd()
+  {
+    NodePtr node = parseComparison();
+    while (match("&&") || matchWord("and"))
+    {
+      node = MakeOperation(Op::AND, std::move(node), parseComparison());
+    }
+    return node;
+  }
+
+  NodePtr parseComparison()
+  {
+    NodePtr node = parseAdditive();
+    while (true)
+    {
+      Op op;
+      if (match("<="))
+      {
+        op = Op::LE;
+      }
+      else if (match(">="))
+      {
+        op = Op::GE;
+      }
+      else if (match("=="))
+      {
+        op = Op::EQ;
+      }
+      else if (match("~=") || match("!="))
+      {
+        op = Op::NE;
+      }
+      else if (match("<"))
+      {
+        op = Op::LT;
+      }
+      else if (match(">"))
+      {
+        op = Op::GT;
+      }
+      else
+      {
+        return node;
+      }
+      node = MakeOperation(op, std::move(node), parseAdditive());
+    }
+  }
+
+  NodePtr parseAdditive()
+  {
+    NodePtr node = parseMultiplicative();
+    while (true)
+    {
+      if (match("+"))
+      {
+        node = MakeOperation(Op::ADD, std::move(node), parseMultiplicative());
+      }
+      else if (match("-"))
+      {
+        node = MakeOperation(Op::SUB, std::move(node), parseMultiplicative());
+      }
+      else
+      {
+        return node;
+      }
+    }
+  }
+
+  NodePtr parseMultiplicative()
+  {
+    NodePtr node = parseUnary();
+    while (true)
+    {
+      if (match("*"))
+      {
+        node = MakeOperation(Op::MUL, std::move(node), parseUnary());
+      }
+      else if (match("/"))
+      {
+        node = MakeOperation(Op::DIV, std::move(node), parseUnary());
+      }
+      else if (match("%"))
+      {
+        node = MakeOperation(Op::MOD, std::move(node), parseUnary());
+      }
+      else
+      {
+        return node;
+      }
+    }
+  }
+
+  NodePtr parseUnary()
+  {
+    if (match("-"))
+    {
+      return MakeUnary(Op::NEG, parseUnary());
+    }
+    if (match("+"))
+    {
+      return parseUnary();
+    }
+    if (matchWord("not") || (!lookAhead("!=") && match("!")))
+    {
+      return MakeUnary(Op::NOT, parseUnary());
+    }
+    return parsePower();
+  }
+
+  bool lookAhead(const char* symbol)
+  {
+    skipSpaces();
+    return _text.compare(_pos, std::char_traits<char>::length(symbol), symbol) == 0;
+  }
+
+  NodePtr parsePower()
+  {
+    NodePtr node = parsePrimary();
+    if (match("^"))
+    {
+      // right associative, with higher priority than the unary minus on its left
+      node = MakeOperation(Op::POW, std::move(node), parseUnary());
+    }
+    return node;
+  }
+
+  NodePtr parsePrimary()
+  {
+    skipSpaces();
+    if (_pos >= _text.size())
+    {
+      error("unexpected end of the expression");
+    }
+    const char c = _text[_pos];
+
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+    {
+      return parseNumber();
+    }
+    if (match("("))
+    {
+      NodePtr node = parseOr();
+      if (!match(")"))
+      {
+        error("expected ')'");
+      }
+      return node;
+    }
+    if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+    {
+      const size_t start = _pos;
+      while (_pos < _text.size() && isIdentifierChar(_text[_pos]))
+      {
+        _pos++;
+      }
+      const std::string name = _text.substr(start, _pos - start);
+
+      if (match("("))
+      {
+        return parseCall(name, start);
+      }
+      auto it = std::find(_variables.begin(), _variables.end(), name);
+      if (it != _variables.end())
+      {
+        auto node = std::make_unique<Node>();
+        node->kind = Node::VARIABLE;
+        node->variable = size_t(std::distance(_variables.begin(), it));
+        return node;
+      }
+      if (name == "pi")
+      {
+        return MakeConstant(std::acos(-1.0));
+      }
+      if (name == "e")
+      {
+        return MakeConstant(std::exp(1.0));
+      }
+      _pos = start;
+      error("unknown variable '" + name + "'");
+    }
+    error("unexpected character '" + std::string(1, c) + "'");
+  }
+
+  NodePtr parseNumber()
+  {
+    const size_t start = _pos;
+    auto digits = [this]() {
+      while (_pos < _text.size() && std::isdigit(static_cast<unsigned char>(_text[_pos])))
+      {
+        _pos++;
+      }
+    };
+    digits();
+    if (_pos < _text.size() && _text[_pos] == '.')
+    {
+      _pos++;
+      digits();
+    }
+    if (_pos < _text.size() && (_text[_pos] == 'e' || _text[_pos] == 'E'))
+    {
+      _pos++;
+      if (_pos < _text.size() && (_text[_pos] == '+' || _text[_pos] == '-'))
+      {
+        _pos++;
+      }
+      digits();
+    }
+    // independent from the locale of the application
+    std::istringstream stream(_text.substr(start, _pos - start));
+    stream.imbue(std::locale::classic());
+    double value = 0;
+    stream >> value;
+    if (stream.fail() || !stream.eof())
+    {
+      _pos = start;
+      error("invalid number");
+    }
+    return MakeConstant(value);
+  }
+
+  NodePtr parseCall(const std::string& name, size_t name_pos)
+  {
+    std::vector<NodePtr> args;
+    if (!match(")"))
+    {
+      do
+      {
+        args.push_back(parseOr());
+      } while (match(","));
+      if (!match(")"))
+      {
+        error("expected ')'");
+      }
+    }
+
+    auto it = Functions().find(name);
+    if (it == Functions().end())
+    {
+      _pos = name_pos;
+      error("unknown function '" + name + "'");
+    }
+    const FunctionInfo& info = it->second;
+
+    if (info.arity < 0)
+    {
+      if (args.size() < 2)
+      {
+        _pos = name_pos;
+        error("function '" + name + "' requires at least 2 arguments");
+      }
+      NodePtr node = std::move(args[0]);
+      for (size_t i = 1; i < args.size(); i++)
+      {
+        node = MakeOperation(info.op, std::move(node), std::move(args[i]));
+      }
+      return node;
+    }
+    if (args.size() != size_t(info.arity))
+    {
+      _pos = name_pos;
+      error("function '" + name + "' requires " + std::to_string(info.arity) + " argument(s)");
+    }
+    return MakeOperation(info.op, std::move(args));
+  }
+};
+
+}  // namespace
+
+//---------------------------------------------------------------
+
+struct MathExpression::Program
+{
+  struct Operand
+  {
+    enum Kind
+    {
+      CONSTANT,
+      INPUT,
+      REGISTER
+    };
+    Kind kind = CONSTANT;
+    size_t index = 0;
+    double value = 0;
+  };
+
+  struct Instruction
+  {
+    Op op;
+    size_t dst;
+    Operand args[3];
+  };
+
+  std::vector<Instruction> instructions;
+  Operand result;
+  size_t num_registers = 0;
+
+  // Registers are allocated like a stack: the operands of an operation use the
+  // registers from first_free, its result is stored in first_free.
+  Operand emit(const Node& node, size_t first_free)
+  {
+    Operand out;
+    switch (node.kind)
+    {
+      case Node::CONSTANT:
+        out.kind = Operand::CONSTANT;
+        out.value = node.value;
+        return out;
+      case Node::VARIABLE:
+        out.kind = Operand::INPUT;
+        out.index = node.variable;
+        return out;
+      case Node::OPERATION:
+        break;
+    }
+
+    Instruction instr;
+    instr.op = node.op;
+    instr.dst = first_free;
+    size_t next_free = first_free;
+    for (size_t i = 0; i < node.args.size(); i++)
+    {
+      instr.args[i] = emit(*node.args[i], next_free);
+      if (instr.args[i].kind == Operand::REGISTER)
+      {
+        next_free = instr.args[i].index + 1;
+      }
+    }
+    instructions.push_back(instr);
+    num_registers = std::max(num_registers, first_free + 1);
+
+    out.kind = Operand::REGISTER;
+    out.index = first_free;
+    return out;
+  }
+};
+
+MathExpression::MathExpression(const std::string& text, const std::vector<std::string>& variables)
+{
+  Parser parser(text, variables);
+  NodePtr root = parser.parse();
+
+  auto program = std::make_shared<Program>();
+  program->result = program->emit(*root, 0);
+  _program = program;
+}
+
+bool MathExpression::isConstant() const
+{
+  return _program->result.kind == Program::Operand::CONSTANT;
+}
+
+void MathExpression::evaluate(const std::vector<const double*>& inputs, size_t count,
+                              double* output) const
+{
+  using Operand = Program::Operand;
+  std::vector<double> registers(_program->num_registers * count);
+
+  auto resolve = [&](const Operand& operand) {
+    Arg arg;
+    switch (operand.kind)
+    {
+      case Operand::CONSTANT:
+        arg.value = operand.value;
+        break;
+      case Operand::INPUT:
+        arg.data = inputs.at(operand.index);
+        break;
+      case Operand::REGISTER:
+        arg.data = registers.data() + operand.index * count;
+        break;
+    }
+    return arg;
+  };
+
+  for (const auto& instr : _program->instructions)
+  {
+    // the destination may be one of the operands: each element depends only
+    // on the elements with the same index
+    double* dst = registers.data() + instr.dst * count;
+    Execute(instr.op, count, dst, resolve(instr.args[0]), resolve(instr.args[1]),
+            resolve(instr.args[2]));
+  }
+
+  const Arg result = resolve(_program->result);
+  if (result.data)
+  {
+    std::copy(result.data, result.data + count, output);
+  }
+  else
+  {
+    std::fill(output, output + count, result.value);
+  }
+}
+
+std::vector<std::string> MathExpression::functionNames()
+{
+  std::vector<std::string> names;
+  for (const auto& it : Functions())
+  {
+    names.push_back(it.first);
+  }
+  return names;
+}
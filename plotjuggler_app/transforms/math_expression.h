@@ -0,0 +1,40 @@
+#ifndef MATH_EXPRESSION_H
+#define MATH_EXPRESSION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Arithmetic expression, like "sqrt(v1^2 + v2^2)", compiled into a short list of
+ * instructions that process arrays of samples at once.
+ *
+ * The syntax is a subset of the Lua expressions: numbers, the variables passed to
+ * the constructor, the constants pi and e, the operators + - * / % ^, the comparisons
+ * < <= > >= == ~= (or !=), the logical operators and, or, not (or &&, ||, !),
+ * the functions returned by functionNames() and if(condition, value_true, value_false).
+ * Comparisons and logical operators return 1 or 0. A leading "return" is ignored.
+ *
+ * Sub-expressions that do not depend on the variables are calculated once, when the
+ * expression is parsed.
+ */
+class MathExpression
+{
+public:
+  /// Throws std::runtime_error if the expression is not valid.
+  MathExpression(const std::string& text, const std::vector<std::string>& variables);
+
+  /// Calculate count results; inputs[i] points to count values of the i-th variable.
+  void evaluate(const std::vector<const double*>& inputs, size_t count, double* output) const;
+
+  /// True if the result does not depend on the variables.
+  bool isConstant() const;
+
+  static std::vector<std::string> functionNames();
+
+private:
+  struct Program;
+  std::shared_ptr<const Program> _program;
+};
+
+#endif  // MATH_EXPRESSION_H
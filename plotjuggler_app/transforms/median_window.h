@@ -0,0 +1,106 @@
+#ifndef MEDIAN_WINDOW_H
+#define MEDIAN_WINDOW_H
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <set>
+
+/**
+ * Median of the last N values, used by the RunningMedianFilter transform.
+ *
+ * The values are kept sorted in two multisets: the lower half, that has one
+ * value more when the count is odd, and the upper half. push() inserts the new
+ * value and removes the oldest one in O(log N); median() is O(1).
+ */
+class MedianWindow
+{
+public:
+  void setSize(size_t size)
+  {
+    if (size != _size)
+    {
+      _size = std::max<size_t>(1, size);
+      reset();
+    }
+  }
+
+  size_t size() const
+  {
+    return _size;
+  }
+
+  void reset()
+  {
+    _values.clear();
+    _low.clear();
+    _high.clear();
+  }
+
+  size_t count() const
+  {
+    return _values.size();
+  }
+
+  /// NaN must not be pushed: it can't be ordered.
+  void push(double value)
+  {
+    _values.push_back(value);
+    if (_low.empty() || value <= *_low.rbegin())
+    {
+      _low.insert(value);
+    }
+    else
+    {
+      _high.insert(value);
+    }
+
+    if (_values.size() > _size)
+    {
+      const double oldest = _values.front();
+      _values.pop_front();
+      if (oldest <= *_low.rbegin())
+      {
+        _low.erase(_low.find(oldest));
+      }
+      else
+      {
+        _high.erase(_high.find(oldest));
+      }
+    }
+    rebalance();
+  }
+
+  double median() const
+  {
+    if (_low.size() > _high.size())
+    {
+      return *_low.rbegin();
+    }
+    return 0.5 * (*_low.rbegin() + *_high.begin());
+  }
+
+private:
+  size_t _size = 1;
+  std::deque<double> _values;
+  std::multiset<double> _low;
+  std::multiset<double> _high;
+
+  void rebalance()
+  {
+    while (_low.size() > _high.size() + 1)
+    {
+      auto it = std::prev(_low.end());
+      _high.insert(*it);
+      _low.erase(it);
+    }
+    while (_high.size() > _low.size())
+    {
+      auto it = _high.begin();
+      _low.insert(*it);
+      _high.erase(it);
+    }
+  }
+};
+
+#endif  // MEDIAN_WINDOW_H
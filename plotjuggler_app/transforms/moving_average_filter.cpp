@@ -5,14 +5,21 @@
 MovingAverageFilter::MovingAverageFilter()
   : ui(new Ui::MovingAverageFilter)
   , _widget(new QWidget())
-  , _buffer(1)
-  , _ring_view(_buffer.begin(), _buffer.end())
 {
   ui->setupUi(_widget);
 
   connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this,
           [=](int) { emit parametersChanged(); });
 
+  connect(ui->spinBoxSeconds, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+          [=](double) { emit parametersChanged(); });
+
+  connect(ui->radioTime, &QRadioButton::toggled, this, [=](bool checked) {
+    ui->spinBoxSamples->setEnabled(!checked);
+    ui->spinBoxSeconds->setEnabled(checked);
+    emit parametersChanged();
+  });
+
   connect(ui->checkBoxTimeOffset, &QCheckBox::toggled, this, [=]() { emit parametersChanged(); });
 }
 
@@ -24,41 +31,47 @@ MovingAverageFilter::~MovingAverageFilter()
 
 void MovingAverageFilter::reset()
 {
-  _buffer.clear();
+  _window.reset();
   TransformFunction_SISO::reset();
 }
 
-std::optional<PlotData::Point> MovingAverageFilter::calculateNextPoint(size_t index)
+std::any MovingAverageFilter::saveState() const
 {
-  size_t buffer_size = std::min(size_t(ui->spinBoxSamples->value()), size_t(dataSource()->size()));
-  if (buffer_size != _buffer.size())
-  {
-    _buffer.resize(buffer_size);
-    _ring_view = nonstd::ring_span<PlotData::Point>(_buffer.begin(), _buffer.end());
-  }
-
-  const auto& p = dataSource()->at(index);
-  _ring_view.push_back(p);
+  // the samples of the window are read again from the source by restoreState()
+  return _window.checkpoint();
+}
 
-  while (_ring_view.size() < buffer_size)
-  {
-    _ring_view.push_back(p);
-  }
+bool MovingAverageFilter::restoreState(const std::any& state)
+{
+  auto checkpoint = std::any_cast<MovingWindow::Checkpoint>(&state);
+  auto last_index = lastProcessedIndex();
+  return checkpoint && last_index && _window.restore(*checkpoint, *dataSource(), *last_index);
+}
 
-  double total = 0;
+void MovingAverageFilter::calculate()
+{
+  MovingWindow::Options options;
+  options.time_based = ui->radioTime->isChecked();
+  options.samples = size_t(ui->spinBoxSamples->value());
+  options.seconds = ui->spinBoxSeconds->value();
+  _window.setOptions(options);
+  _compensate_offset = ui->checkBoxTimeOffset->isChecked();
+
+  TransformFunction_SISO::calculate();
+}
 
-  for (size_t i = 0; i < buffer_size; i++)
-  {
-    total += _ring_view[i].y;
-  }
+std::optional<PlotData::Point> MovingAverageFilter::calculateNextPoint(size_t index)
+{
+  const auto& p = dataSource()->at(index);
+  _window.push(p, dataSource()->size());
 
   double time = p.x;
-  if (ui->checkBoxTimeOffset->isChecked())
+  if (_compensate_offset)
   {
-    time = (_ring_view.back().x + _ring_view.front().x) / 2.0;
+    time = (_window.back().x + _window.front().x) / 2.0;
   }
 
-  PlotData::Point out = { time, total / _ring_view.size() };
+  PlotData::Point out = { time, _window.mean() };
   return out;
 }
 
@@ -71,6 +84,8 @@ bool MovingAverageFilter::xmlSaveState(QDomDocument& doc, QDomElement& parent_el
 {
   QDomElement widget_el = doc.createElement("options");
   widget_el.setAttribute("value", ui->spinBoxSamples->value());
+  widget_el.setAttribute("time_window", ui->spinBoxSeconds->value());
+  widget_el.setAttribute("window_type", ui->radioTime->isChecked() ? "time" : "samples");
   widget_el.setAttribute("compensate_offset",
                          ui->checkBoxTimeOffset->isChecked() ? "true" : "false");
   parent_element.appendChild(widget_el);
@@ -86,6 +101,13 @@ bool MovingAverageFilter::xmlLoadState(const QDomElement& parent_element)
   }
 
   ui->spinBoxSamples->setValue(widget_el.attribute("value").toInt());
+  if (widget_el.hasAttribute("time_window"))
+  {
+    ui->spinBoxSeconds->setValue(widget_el.attribute("time_window").toDouble());
+  }
+  bool time_window = widget_el.attribute("window_type") == "time";
+  ui->radioTime->setChecked(time_window);
+  ui->radioSamples->setChecked(!time_window);
   bool checked = widget_el.attribute("compensate_offset") == "true";
   ui->checkBoxTimeOffset->setChecked(checked);
   return true;
@@ -5,7 +5,7 @@
 #include <QDoubleSpinBox>
 #include "PlotJuggler/transform_function.h"
 #include "ui_moving_average_filter.h"
-#include "PlotJuggler/contrib/ring_span.hpp"
+#include "moving_window.h"
 
 using namespace PJ;
 
@@ -23,6 +23,12 @@ public:
 
   void reset() override;
 
+  std::any saveState() const override;
+
+  bool restoreState(const std::any& state) override;
+
+  void calculate() override;
+
   static const char* transformName()
   {
     return "Moving Average";
@@ -42,8 +48,9 @@ public:
 private:
   Ui::MovingAverageFilter* ui;
   QWidget* _widget;
-  std::vector<PlotData::Point> _buffer;
-  nonstd::ring_span_lite::ring_span<PlotData::Point> _ring_view;
+  MovingWindow _window;
+  // parameters read from the widget once per calculate()
+  bool _compensate_offset = false;
 
   std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
 };
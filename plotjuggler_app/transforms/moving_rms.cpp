@@ -4,13 +4,20 @@
 MovingRMS::MovingRMS()
   : ui(new Ui::MovingRMS)
   , _widget(new QWidget())
-  , _buffer(1)
-  , _ring_view(_buffer.begin(), _buffer.end())
 {
   ui->setupUi(_widget);
 
   connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this,
           [=](int) { emit parametersChanged(); });
+
+  connect(ui->spinBoxSeconds, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+          [=](double) { emit parametersChanged(); });
+
+  connect(ui->radioTime, &QRadioButton::toggled, this, [=](bool checked) {
+    ui->spinBoxSamples->setEnabled(!checked);
+    ui->spinBoxSeconds->setEnabled(checked);
+    emit parametersChanged();
+  });
 }
 
 MovingRMS::~MovingRMS()
@@ -21,10 +28,34 @@ MovingRMS::~MovingRMS()
 
 void MovingRMS::reset()
 {
-  _buffer.clear();
+  _window.reset();
   TransformFunction_SISO::reset();
 }
 
+std::any MovingRMS::saveState() const
+{
+  // the samples of the window are read again from the source by restoreState()
+  return _window.checkpoint();
+}
+
+bool MovingRMS::restoreState(const std::any& state)
+{
+  auto checkpoint = std::any_cast<MovingWindow::Checkpoint>(&state);
+  auto last_index = lastProcessedIndex();
+  return checkpoint && last_index && _window.restore(*checkpoint, *dataSource(), *last_index);
+}
+
+void MovingRMS::calculate()
+{
+  MovingWindow::Options options;
+  options.time_based = ui->radioTime->isChecked();
+  options.samples = size_t(ui->spinBoxSamples->value());
+  options.seconds = ui->spinBoxSeconds->value();
+  _window.setOptions(options);
+
+  TransformFunction_SISO::calculate();
+}
+
 QWidget* MovingRMS::optionsWidget()
 {
   return _widget;
@@ -34,6 +65,8 @@ bool MovingRMS::xmlSaveState(QDomDocument& doc, QDomElement& parent_element) con
 {
   QDomElement widget_el = doc.createElement("options");
   widget_el.setAttribute("value", ui->spinBoxSamples->value());
+  widget_el.setAttribute("time_window", ui->spinBoxSeconds->value());
+  widget_el.setAttribute("window_type", ui->radioTime->isChecked() ? "time" : "samples");
   parent_element.appendChild(widget_el);
   return true;
 }
@@ -46,36 +79,21 @@ bool MovingRMS::xmlLoadState(const QDomElement& parent_element)
     return false;
   }
   ui->spinBoxSamples->setValue(widget_el.attribute("value").toInt());
+  if (widget_el.hasAttribute("time_window"))
+  {
+    ui->spinBoxSeconds->setValue(widget_el.attribute("time_window").toDouble());
+  }
+  bool time_window = widget_el.attribute("window_type") == "time";
+  ui->radioTime->setChecked(time_window);
+  ui->radioSamples->setChecked(!time_window);
   return true;
 }
 
 std::optional<PJ::PlotData::Point> MovingRMS::calculateNextPoint(size_t index)
 {
-  size_t buffer_size = std::min(size_t(ui->spinBoxSamples->value()), size_t(dataSource()->size()));
-  if (buffer_size != _buffer.size())
-  {
-    _buffer.resize(buffer_size);
-    _ring_view = nonstd::ring_span<PJ::PlotData::Point>(_buffer.begin(), _buffer.end());
-  }
-
   const auto& p = dataSource()->at(index);
-  _ring_view.push_back(p);
-
-  while (_ring_view.size() < buffer_size)
-  {
-    _ring_view.push_back(p);
-  }
-
-  double total_sqr = 0;
-
-  for (size_t i = 0; i < buffer_size; i++)
-  {
-    double val = _ring_view[i].y;
-    total_sqr += val * val;
-  }
-
-  double time = p.x;
+  _window.push(p, dataSource()->size());
 
-  PJ::PlotData::Point out = { time, sqrt(total_sqr / _ring_view.size()) };
+  PJ::PlotData::Point out = { p.x, std::sqrt(_window.meanSquare()) };
   return out;
 }
@@ -4,7 +4,7 @@
 #include <QSpinBox>
 #include <QWidget>
 #include "PlotJuggler/transform_function.h"
-#include "PlotJuggler/contrib/ring_span.hpp"
+#include "moving_window.h"
 
 namespace Ui
 {
@@ -22,6 +22,12 @@ public:
 
   void reset() override;
 
+  std::any saveState() const override;
+
+  bool restoreState(const std::any& state) override;
+
+  void calculate() override;
+
   static const char* transformName()
   {
     return "Moving Root Mean Squared";
@@ -42,8 +48,7 @@ private:
   Ui::MovingRMS* ui;
 
   QWidget* _widget;
-  std::vector<PJ::PlotData::Point> _buffer;
-  nonstd::ring_span_lite::ring_span<PJ::PlotData::Point> _ring_view;
+  MovingWindow _window;
 
   std::optional<PJ::PlotData::Point> calculateNextPoint(size_t index) override;
 };
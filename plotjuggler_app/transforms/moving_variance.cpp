@@ -5,14 +5,21 @@
 MovingVarianceFilter::MovingVarianceFilter()
   : ui(new Ui::MovingVarianceFilter)
   , _widget(new QWidget())
-  , _buffer(1)
-  , _ring_view(_buffer.begin(), _buffer.end())
 {
   ui->setupUi(_widget);
 
   connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this,
           [=](int) { emit parametersChanged(); });
 
+  connect(ui->spinBoxSeconds, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+          [=](double) { emit parametersChanged(); });
+
+  connect(ui->radioTime, &QRadioButton::toggled, this, [=](bool checked) {
+    ui->spinBoxSamples->setEnabled(!checked);
+    ui->spinBoxSeconds->setEnabled(checked);
+    emit parametersChanged();
+  });
+
   connect(ui->checkBoxStdDev, &QCheckBox::toggled, this, [=]() { emit parametersChanged(); });
 }
 
@@ -24,47 +31,46 @@ MovingVarianceFilter::~MovingVarianceFilter()
 
 void MovingVarianceFilter::reset()
 {
-  _buffer.clear();
+  _window.reset();
   TransformFunction_SISO::reset();
 }
 
-std::optional<PlotData::Point> MovingVarianceFilter::calculateNextPoint(size_t index)
+std::any MovingVarianceFilter::saveState() const
 {
-  size_t buffer_size = std::min(size_t(ui->spinBoxSamples->value()), size_t(dataSource()->size()));
-  if (buffer_size != _buffer.size())
-  {
-    _buffer.resize(buffer_size);
-    _ring_view = nonstd::ring_span<PlotData::Point>(_buffer.begin(), _buffer.end());
-  }
+  // the samples of the window are read again from the source by restoreState()
+  return _window.checkpoint();
+}
 
-  const auto& p = dataSource()->at(index);
-  _ring_view.push_back(p);
+bool MovingVarianceFilter::restoreState(const std::any& state)
+{
+  auto checkpoint = std::any_cast<MovingWindow::Checkpoint>(&state);
+  auto last_index = lastProcessedIndex();
+  return checkpoint && last_index && _window.restore(*checkpoint, *dataSource(), *last_index);
+}
 
-  while (_ring_view.size() < buffer_size)
-  {
-    _ring_view.push_back(p);
-  }
+void MovingVarianceFilter::calculate()
+{
+  MovingWindow::Options options;
+  options.time_based = ui->radioTime->isChecked();
+  options.samples = size_t(ui->spinBoxSamples->value());
+  options.seconds = ui->spinBoxSeconds->value();
+  _window.setOptions(options);
+  _apply_sqrt = ui->checkBoxStdDev->isChecked();
 
-  double total = 0;
-  for (const auto& point : _ring_view)
-  {
-    total += point.y;
-  }
-  const double N = double(_ring_view.size());
-  const double avg = total / N;
+  TransformFunction_SISO::calculate();
+}
 
-  double total_sqr = 0;
-  for (const auto& point : _ring_view)
-  {
-    const auto v = point.y - avg;
-    total_sqr += v * v;
-  }
+std::optional<PlotData::Point> MovingVarianceFilter::calculateNextPoint(size_t index)
+{
+  const auto& p = dataSource()->at(index);
+  _window.push(p, dataSource()->size());
 
-  if (ui->checkBoxStdDev->isChecked())
+  const double variance = _window.variance();
+  if (_apply_sqrt)
   {
-    return PlotData::Point{ p.x, std::sqrt(total_sqr / N) };
+    return PlotData::Point{ p.x, std::sqrt(variance) };
   }
-  return PlotData::Point{ p.x, total_sqr / N };
+  return PlotData::Point{ p.x, variance };
 }
 
 QWidget* MovingVarianceFilter::optionsWidget()
@@ -80,6 +86,8 @@ bool MovingVarianceFilter::xmlSaveState(QDomDocument& doc, QDomElement& parent_e
     return false;
   }
   widget_el.setAttribute("value", ui->spinBoxSamples->value());
+  widget_el.setAttribute("time_window", ui->spinBoxSeconds->value());
+  widget_el.setAttribute("window_type", ui->radioTime->isChecked() ? "time" : "samples");
   widget_el.setAttribute("apply_sqrt", ui->checkBoxStdDev->isChecked() ? "true" : "false");
   parent_element.appendChild(widget_el);
   return true;
@@ -89,6 +97,13 @@ bool MovingVarianceFilter::xmlLoadState(const QDomElement& parent_element)
 {
   QDomElement widget_el = parent_element.firstChildElement("options");
   ui->spinBoxSamples->setValue(widget_el.attribute("value").toInt());
+  if (widget_el.hasAttribute("time_window"))
+  {
+    ui->spinBoxSeconds->setValue(widget_el.attribute("time_window").toDouble());
+  }
+  bool time_window = widget_el.attribute("window_type") == "time";
+  ui->radioTime->setChecked(time_window);
+  ui->radioSamples->setChecked(!time_window);
   bool checked = widget_el.attribute("apply_sqrt") == "true";
   ui->checkBoxStdDev->setChecked(checked);
   return true;
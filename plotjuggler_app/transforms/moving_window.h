@@ -0,0 +1,284 @@
+#ifndef MOVING_WINDOW_H
+#define MOVING_WINDOW_H
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include "PlotJuggler/plotdata.h"
+
+/**
+ * Running sums of the samples inside a sliding window, used by the
+ * MovingAverage, MovingVariance and MovingRMS transforms.
+ *
+ * push() adds a sample and removes the ones leaving the window in O(1).
+ * The window is either the last N samples or the samples of the last T seconds.
+ * NaN and infinite samples are counted apart, not in the sums: the results are NaN
+ * only while one of them is inside the window.
+ */
+class MovingWindow
+{
+public:
+  struct Options
+  {
+    bool time_based = false;
+    size_t samples = 1;
+    double seconds = 1.0;
+
+    bool operator==(const Options& other) const
+    {
+      return time_based == other.time_based && samples == other.samples &&
+             seconds == other.seconds;
+    }
+    bool operator!=(const Options& other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  void setOptions(const Options& options)
+  {
+    if (options != _options)
+    {
+      _options = options;
+      reset();
+    }
+  }
+
+  const Options& options() const
+  {
+    return _options;
+  }
+
+  void reset()
+  {
+    _entries.clear();
+    _count = 0;
+    _non_finite = 0;
+    _sum = 0;
+    _sum_sq = 0;
+    _updates = 0;
+  }
+
+  /// When the window is empty and sample based, the first sample is repeated
+  /// to fill min(window size, initial_fill) positions.
+  void push(const PJ::PlotData::Point& p, size_t initial_fill)
+  {
+    if (_count == 0)
+    {
+      const size_t copies =
+          _options.time_based ? 1 : std::max<size_t>(1, std::min(_options.samples, initial_fill));
+      add(p, copies);
+    }
+    else
+    {
+      add(p, 1);
+    }
+
+    if (_options.time_based)
+    {
+      const double oldest = p.x - _options.seconds;
+      while (_entries.size() > 1 && _entries.front().point.x < oldest)
+      {
+        removeFront(_entries.front().count);
+      }
+    }
+    else
+    {
+      while (_count > _options.samples)
+      {
+        removeFront(std::min(_count - _options.samples, _entries.front().count));
+      }
+    }
+
+    // bound the accumulated rounding error, amortized O(1)
+    if (++_updates > 4 * _entries.size() + 1024)
+    {
+      resync();
+    }
+  }
+
+  size_t count() const
+  {
+    return _count;
+  }
+
+  const PJ::PlotData::Point& front() const
+  {
+    return _entries.front().point;
+  }
+
+  const PJ::PlotData::Point& back() const
+  {
+    return _entries.back().point;
+  }
+
+  /// State of the window without its samples: they are the last ones pushed,
+  /// that restore() reads again from the source.
+  struct Checkpoint
+  {
+    Options options;
+    size_t entries = 0;
+    // copies of the first sample still in the window
+    size_t front_count = 0;
+    size_t count = 0;
+    size_t non_finite = 0;
+    double reference = 0;
+    double sum = 0;
+    double sum_sq = 0;
+    size_t updates = 0;
+  };
+
+  Checkpoint checkpoint() const
+  {
+    Checkpoint checkpoint;
+    checkpoint.options = _options;
+    checkpoint.entries = _entries.size();
+    checkpoint.front_count = _entries.empty() ? 0 : _entries.front().count;
+    checkpoint.count = _count;
+    checkpoint.non_finite = _non_finite;
+    checkpoint.reference = _reference;
+    checkpoint.sum = _sum;
+    checkpoint.sum_sq = _sum_sq;
+    checkpoint.updates = _updates;
+    return checkpoint;
+  }
+
+  /// last_index is the index in source of the last sample pushed before the
+  /// checkpoint. Return false if the options are different or the samples of
+  /// the window are not in source anymore.
+  bool restore(const Checkpoint& checkpoint, const PJ::PlotData& source, size_t last_index)
+  {
+    if (checkpoint.options != _options || last_index >= source.size() ||
+        checkpoint.entries > last_index + 1)
+    {
+      return false;
+    }
+    _entries.clear();
+    const size_t first = last_index + 1 - checkpoint.entries;
+    for (size_t i = first; i <= last_index; i++)
+    {
+      _entries.push_back({ source[i], i == first ? checkpoint.front_count : 1 });
+    }
+    _count = checkpoint.count;
+    _non_finite = checkpoint.non_finite;
+    _reference = checkpoint.reference;
+    _sum = checkpoint.sum;
+    _sum_sq = checkpoint.sum_sq;
+    _updates = checkpoint.updates;
+    return true;
+  }
+
+  double mean() const
+  {
+    if (_non_finite > 0)
+    {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    return _reference + _sum / double(_count);
+  }
+
+  double variance() const
+  {
+    if (_non_finite > 0)
+    {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    // sums are computed relative to _reference, to reduce cancellation errors
+    const double m = _sum / double(_count);
+    return std::max(0.0, _sum_sq / double(_count) - m * m);
+  }
+
+  double meanSquare() const
+  {
+    if (_non_finite > 0)
+    {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    const double m = _sum / double(_count);
+    const double ms = _sum_sq / double(_count) + 2.0 * _reference * m + _reference * _reference;
+    return std::max(0.0, ms);
+  }
+
+private:
+  struct Entry
+  {
+    PJ::PlotData::Point point;
+    size_t count;
+  };
+
+  Options _options;
+  std::deque<Entry> _entries;
+  size_t _count = 0;
+  // samples of _count that are NaN or infinite
+  size_t _non_finite = 0;
+  double _reference = 0;
+  double _sum = 0;
+  double _sum_sq = 0;
+  size_t _updates = 0;
+
+  void add(const PJ::PlotData::Point& p, size_t n)
+  {
+    _entries.push_back({ p, n });
+    _count += n;
+    if (!std::isfinite(p.y))
+    {
+      _non_finite += n;
+      return;
+    }
+    if (_count == _non_finite + n)
+    {
+      // the only finite samples: the sums are empty, the reference can change
+      _reference = p.y;
+      _sum = 0;
+      _sum_sq = 0;
+    }
+    const double v = p.y - _reference;
+    _sum += v * double(n);
+    _sum_sq += v * v * double(n);
+  }
+
+  void removeFront(size_t n)
+  {
+    auto& entry = _entries.front();
+    _count -= n;
+    if (std::isfinite(entry.point.y))
+    {
+      const double v = entry.point.y - _reference;
+      _sum -= v * double(n);
+      _sum_sq -= v * v * double(n);
+    }
+    else
+    {
+      _non_finite -= n;
+    }
+    entry.count -= n;
+    if (entry.count == 0)
+    {
+      _entries.pop_front();
+    }
+  }
+
+  void resync()
+  {
+    _updates = 0;
+    if (_count > _non_finite)
+    {
+      _reference += _sum / double(_count - _non_finite);
+    }
+    _sum = 0;
+    _sum_sq = 0;
+    for (const auto& entry : _entries)
+    {
+      if (!std::isfinite(entry.point.y))
+      {
+        continue;
+      }
+      const double v = entry.point.y - _reference;
+      _sum += v * double(entry.count);
+      _sum_sq += v * v * double(entry.count);
+    }
+  }
+};
+
+#endif  // MOVING_WINDOW_H
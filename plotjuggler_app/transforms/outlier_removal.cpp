@@ -43,6 +43,29 @@ bool OutlierRemovalFilter::xmlLoadState(const QDomElement& parent_element)
   return true;
 }
 
+std::any OutlierRemovalFilter::saveState() const
+{
+  return std::vector<double>(_ring_view.begin(), _ring_view.end());
+}
+
+bool OutlierRemovalFilter::restoreState(const std::any& state)
+{
+  auto values = std::any_cast<std::vector<double>>(&state);
+  if (!values)
+  {
+    return false;
+  }
+  while (!_ring_view.empty())
+  {
+    _ring_view.pop_front();
+  }
+  for (double value : *values)
+  {
+    _ring_view.push_back(value);
+  }
+  return true;
+}
+
 std::optional<PJ::PlotData::Point> OutlierRemovalFilter::calculateNextPoint(size_t index)
 {
   const auto& p = dataSource()->at(index);
@@ -36,6 +36,10 @@ public:
 
   bool xmlLoadState(const QDomElement& parent_element) override;
 
+  std::any saveState() const override;
+
+  bool restoreState(const std::any& state) override;
+
 private:
   Ui::OutlierRemovalFilter* ui;
   QWidget* _widget;
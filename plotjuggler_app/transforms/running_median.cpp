@@ -0,0 +1,138 @@
+#include "running_median.h"
+#include "ui_running_median.h"
+#include <cmath>
+
+RunningMedianFilter::RunningMedianFilter()
+  : ui(new Ui::RunningMedianFilter)
+  , _widget(new QWidget())
+{
+  ui->setupUi(_widget);
+
+  connect(ui->spinBoxSamples, qOverload<int>(&QSpinBox::valueChanged), this,
+          [=](int) { emit parametersChanged(); });
+
+  connect(ui->checkBoxTimeOffset, &QCheckBox::toggled, this, [=]() { emit parametersChanged(); });
+}
+
+RunningMedianFilter::~RunningMedianFilter()
+{
+  delete ui;
+  delete _widget;
+}
+
+void RunningMedianFilter::reset()
+{
+  _window.reset();
+  TransformFunction_SISO::reset();
+}
+
+std::any RunningMedianFilter::saveState() const
+{
+  // the values of the window are read again from the source by restoreState()
+  return Checkpoint{ _window.size(), _window.count() };
+}
+
+bool RunningMedianFilter::restoreState(const std::any& state)
+{
+  // a checkpoint saved with a different window can't be used
+  auto checkpoint = std::any_cast<Checkpoint>(&state);
+  auto last_index = lastProcessedIndex();
+  if (!checkpoint || !last_index || checkpoint->window_size != _window.size())
+  {
+    return false;
+  }
+  // the window contains the last values that are not NaN
+  const PJ::PlotData& src = *dataSource();
+  size_t first = *last_index + 1;
+  size_t found = 0;
+  while (found < checkpoint->count && first > 0)
+  {
+    first--;
+    found += std::isnan(src[first].y) ? 0 : 1;
+  }
+  if (found < checkpoint->count)
+  {
+    return false;
+  }
+  _window.reset();
+  for (size_t index = first; index <= *last_index; index++)
+  {
+    if (!std::isnan(src[index].y))
+    {
+      _window.push(src[index].y);
+    }
+  }
+  return true;
+}
+
+void RunningMedianFilter::calculate()
+{
+  _window.setSize(size_t(ui->spinBoxSamples->value()));
+  _compensate_offset = ui->checkBoxTimeOffset->isChecked();
+
+  TransformFunction_SISO::calculate();
+}
+
+std::optional<PJ::PlotData::Point> RunningMedianFilter::calculateNextPoint(size_t index)
+{
+  std::vector<PJ::PlotData::Point> out;
+  calculateBatch(index, index + 1, out);
+  if (out.empty())
+  {
+    return {};
+  }
+  return out.front();
+}
+
+void RunningMedianFilter::calculateBatch(size_t first, size_t last,
+                                         std::vector<PJ::PlotData::Point>& out)
+{
+  const PJ::PlotData& src = *dataSource();
+  out.reserve(out.size() + (last - first));
+
+  for (size_t index = first; index < last; index++)
+  {
+    const auto& p = src[index];
+    if (std::isnan(p.y))
+    {
+      continue;
+    }
+    _window.push(p.y);
+
+    double time = p.x;
+    if (_compensate_offset)
+    {
+      // the middle of the window. NaN values are skipped, so this is an approximation
+      const size_t offset = std::min(index, (_window.count() - 1) / 2);
+      time = src[index - offset].x;
+    }
+    out.push_back({ time, _window.median() });
+  }
+}
+
+QWidget* RunningMedianFilter::optionsWidget()
+{
+  return _widget;
+}
+
+bool RunningMedianFilter::xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const
+{
+  QDomElement widget_el = doc.createElement("options");
+  widget_el.setAttribute("value", ui->spinBoxSamples->value());
+  widget_el.setAttribute("compensate_offset",
+                         ui->checkBoxTimeOffset->isChecked() ? "true" : "false");
+  parent_element.appendChild(widget_el);
+  return true;
+}
+
+bool RunningMedianFilter::xmlLoadState(const QDomElement& parent_element)
+{
+  QDomElement widget_el = parent_element.firstChildElement("options");
+  if (widget_el.isNull())
+  {
+    return false;
+  }
+  ui->spinBoxSamples->setValue(widget_el.attribute("value").toInt());
+  ui->checkBoxTimeOffset->setChecked(widget_el.attribute("compensate_offset") == "true");
+  return true;
+}
@@ -0,0 +1,66 @@
+#ifndef RUNNING_MEDIAN_H
+#define RUNNING_MEDIAN_H
+
+#include <QSpinBox>
+#include <QWidget>
+#include "PlotJuggler/transform_function.h"
+#include "median_window.h"
+
+namespace Ui
+{
+class RunningMedianFilter;
+}
+
+class RunningMedianFilter : public PJ::TransformFunction_SISO
+{
+  Q_OBJECT
+
+public:
+  explicit RunningMedianFilter();
+
+  ~RunningMedianFilter() override;
+
+  void reset() override;
+
+  std::any saveState() const override;
+
+  bool restoreState(const std::any& state) override;
+
+  void calculate() override;
+
+  static const char* transformName()
+  {
+    return "Running Median";
+  }
+
+  const char* name() const override
+  {
+    return transformName();
+  }
+
+  QWidget* optionsWidget() override;
+
+  bool xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const override;
+
+  bool xmlLoadState(const QDomElement& parent_element) override;
+
+private:
+  // see saveState()
+  struct Checkpoint
+  {
+    size_t window_size;
+    size_t count;
+  };
+
+  Ui::RunningMedianFilter* ui;
+
+  QWidget* _widget;
+  MedianWindow _window;
+  bool _compensate_offset = false;
+
+  std::optional<PJ::PlotData::Point> calculateNextPoint(size_t index) override;
+
+  void calculateBatch(size_t first, size_t last, std::vector<PJ::PlotData::Point>& out) override;
+};
+
+#endif  // RUNNING_MEDIAN_H
@@ -55,3 +55,41 @@ std::optional<PJ::PlotData::Point> SamplesCountFilter::calculateNextPoint(size_t
   auto min_index = dataSource()->getIndexFromX(min_time);
   return PJ::PlotData::Point{ point.x, double(index - min_index) };
 }
+
+void SamplesCountFilter::calculateBatch(size_t first, size_t last,
+                                        std::vector<PJ::PlotData::Point>& out)
+{
+  const PJ::PlotData* src = dataSource();
+  if (src->size() == 0 || first >= last)
+  {
+    return;
+  }
+  const double delta = 0.001 * double(ui->spinBoxMilliseconds->value());
+  out.reserve(out.size() + (last - first));
+
+  // min_time grows monotonically: the lower bound is found with a sliding
+  // index instead of a binary search per point.
+  const size_t size = src->size();
+  size_t lower = size_t(std::max(0, src->getIndexFromX(src->at(first).x - delta)));
+  for (size_t index = first; index < last; index++)
+  {
+    const double x = src->at(index).x;
+    const double min_time = x - delta;
+    while (lower > 0 && src->at(lower - 1).x >= min_time)
+    {
+      lower--;
+    }
+    while (lower < size && src->at(lower).x < min_time)
+    {
+      lower++;
+    }
+    // same rounding to the nearest sample as PlotData::getIndexFromX()
+    size_t min_index = std::min(lower, size - 1);
+    if (min_index > 0 &&
+        std::abs(src->at(min_index - 1).x - min_time) < std::abs(src->at(min_index).x - min_time))
+    {
+      min_index--;
+    }
+    out.push_back({ x, double(index - min_index) });
+  }
+}
@@ -33,6 +33,11 @@ public:
 
   bool xmlLoadState(const QDomElement& parent_element) override;
 
+  bool isStateless() const override
+  {
+    return true;
+  }
+
 private:
   Ui::SamplesCount* ui;
   QWidget* _widget;
@@ -41,4 +46,6 @@ private:
   double interval_end_ = 0;
 
   std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
 };
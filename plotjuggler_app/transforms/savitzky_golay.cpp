@@ -0,0 +1,199 @@
+#include "savitzky_golay.h"
+#include "ui_savitzky_golay.h"
+#include <cmath>
+
+SavitzkyGolayFilter::SavitzkyGolayFilter() : ui(new Ui::SavitzkyGolayFilter), _widget(new QWidget())
+{
+  ui->setupUi(_widget);
+
+  connect(ui->spinBoxWindow, qOverload<int>(&QSpinBox::valueChanged), this,
+          [=](int) { emit parametersChanged(); });
+
+  connect(ui->spinBoxOrder, qOverload<int>(&QSpinBox::valueChanged), this,
+          [=](int) { emit parametersChanged(); });
+
+  connect(ui->comboDerivative, qOverload<int>(&QComboBox::currentIndexChanged), this,
+          [=](int) { emit parametersChanged(); });
+}
+
+SavitzkyGolayFilter::~SavitzkyGolayFilter()
+{
+  delete ui;
+  delete _widget;
+}
+
+std::vector<double> SavitzkyGolayFilter::coefficients(int half_window, int order, int derivative)
+{
+  const int size = 2 * half_window + 1;
+  order = std::min(order, size - 1);
+  std::vector<double> weights(size, 0.0);
+  if (derivative > order)
+  {
+    return weights;
+  }
+
+  // positions normalized to [-1, 1], to keep the normal equations well conditioned
+  const int terms = order + 1;
+  const double scale = (half_window > 0) ? double(half_window) : 1.0;
+  std::vector<std::vector<double>> powers(size, std::vector<double>(terms));
+  for (int k = 0; k < size; k++)
+  {
+    const double t = double(k - half_window) / scale;
+    double value = 1.0;
+    for (int j = 0; j < terms; j++)
+    {
+      powers[k][j] = value;
+      value *= t;
+    }
+  }
+
+  // solve (A^T A) u = e_derivative, with Gaussian elimination and partial pivoting
+  std::vector<std::vector<double>> matrix(terms, std::vector<double>(terms + 1, 0.0));
+  for (int r = 0; r < terms; r++)
+  {
+    for (int c = 0; c < terms; c++)
+    {
+      for (int k = 0; k < size; k++)
+      {
+        matrix[r][c] += powers[k][r] * powers[k][c];
+      }
+    }
+    matrix[r][terms] = (r == derivative) ? 1.0 : 0.0;
+  }
+  for (int col = 0; col < terms; col++)
+  {
+    int pivot = col;
+    for (int r = col + 1; r < terms; r++)
+    {
+      if (std::abs(matrix[r][col]) > std::abs(matrix[pivot][col]))
+      {
+        pivot = r;
+      }
+    }
+    std::swap(matrix[col], matrix[pivot]);
+    for (int r = 0; r < terms; r++)
+    {
+      if (r != col)
+      {
+        const double factor = matrix[r][col] / matrix[col][col];
+        for (int c = col; c <= terms; c++)
+        {
+          matrix[r][c] -= factor * matrix[col][c];
+        }
+      }
+    }
+  }
+
+  // the derivative of t^d at 0 is d!, and d/dx = (d/dt) / scale
+  double factor = 1.0;
+  for (int d = 2; d <= derivative; d++)
+  {
+    factor *= d;
+  }
+  factor /= std::pow(scale, derivative);
+
+  for (int k = 0; k < size; k++)
+  {
+    double sum = 0;
+    for (int j = 0; j < terms; j++)
+    {
+      sum += matrix[j][terms] / matrix[j][j] * powers[k][j];
+    }
+    weights[k] = factor * sum;
+  }
+  return weights;
+}
+
+void SavitzkyGolayFilter::calculate()
+{
+  const int half_window = ui->spinBoxWindow->value() / 2;
+  const int order = ui->spinBoxOrder->value();
+  const int derivative = ui->comboDerivative->currentIndex();
+  _coefficients = coefficients(half_window, order, derivative);
+  _half_window = half_window;
+  _derivative = derivative;
+
+  TransformFunction_SISO::calculate();
+}
+
+std::optional<PlotData::Point> SavitzkyGolayFilter::calculateNextPoint(size_t index)
+{
+  std::vector<PlotData::Point> out;
+  calculateBatch(index, index + 1, out);
+  if (out.empty())
+  {
+    return {};
+  }
+  return out.front();
+}
+
+void SavitzkyGolayFilter::calculateBatch(size_t first, size_t last,
+                                         std::vector<PlotData::Point>& out)
+{
+  // the sample "index" completes the window centered in index - half_window
+  const size_t window = 2 * size_t(_half_window);
+  first = std::max(first, window);
+  if (first >= last)
+  {
+    return;
+  }
+
+  auto src = dataSource()->begin();
+  std::vector<double> values(last - first + window);
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    values[i] = src[first - window + i].y;
+  }
+
+  const double* weights = _coefficients.data();
+  out.reserve(out.size() + (last - first));
+  for (size_t index = first; index < last; index++)
+  {
+    const double* samples = values.data() + (index - first);
+    double sum = 0;
+    for (size_t k = 0; k <= window; k++)
+    {
+      sum += weights[k] * samples[k];
+    }
+
+    if (_derivative > 0)
+    {
+      const double dt = (window > 0) ? (src[index].x - src[index - window].x) / double(window) :
+                                       0.0;
+      if (dt <= 0)
+      {
+        continue;
+      }
+      sum /= (_derivative == 1) ? dt : dt * dt;
+    }
+    out.push_back({ src[index - _half_window].x, sum });
+  }
+}
+
+QWidget* SavitzkyGolayFilter::optionsWidget()
+{
+  return _widget;
+}
+
+bool SavitzkyGolayFilter::xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const
+{
+  QDomElement widget_el = doc.createElement("options");
+  widget_el.setAttribute("window", ui->spinBoxWindow->value());
+  widget_el.setAttribute("order", ui->spinBoxOrder->value());
+  widget_el.setAttribute("derivative", ui->comboDerivative->currentIndex());
+  parent_element.appendChild(widget_el);
+  return true;
+}
+
+bool SavitzkyGolayFilter::xmlLoadState(const QDomElement& parent_element)
+{
+  QDomElement widget_el = parent_element.firstChildElement("options");
+  if (widget_el.isNull())
+  {
+    return false;
+  }
+  ui->spinBoxWindow->setValue(widget_el.attribute("window").toInt());
+  ui->spinBoxOrder->setValue(widget_el.attribute("order").toInt());
+  ui->comboDerivative->setCurrentIndex(widget_el.attribute("derivative").toInt());
+  return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SAVITZKY_GOLAY_H
+#define SAVITZKY_GOLAY_H
+
+#include <QWidget>
+#include "PlotJuggler/transform_function.h"
+
+using namespace PJ;
+
+namespace Ui
+{
+class SavitzkyGolayFilter;
+}
+
+/**
+ * Savitzky-Golay filter: value, or first/second derivative, at the center of a
+ * window of 2M+1 samples, of the polynomial fitted to them with least squares.
+ *
+ * The output of a sample is available when the following M samples are
+ * received. The derivatives assume a constant dT, estimated in each window.
+ */
+class SavitzkyGolayFilter : public TransformFunction_SISO
+{
+  Q_OBJECT
+
+public:
+  explicit SavitzkyGolayFilter();
+
+  ~SavitzkyGolayFilter() override;
+
+  static const char* transformName()
+  {
+    return "Savitzky-Golay Filter";
+  }
+
+  const char* name() const override
+  {
+    return transformName();
+  }
+
+  void calculate() override;
+
+  bool isStateless() const override
+  {
+    return true;
+  }
+
+  QWidget* optionsWidget() override;
+
+  bool xmlSaveState(QDomDocument& doc, QDomElement& parent_element) const override;
+
+  bool xmlLoadState(const QDomElement& parent_element) override;
+
+  /// Weights of the 2 * half_window + 1 samples, for a window of unit spacing.
+  static std::vector<double> coefficients(int half_window, int order, int derivative);
+
+private:
+  Ui::SavitzkyGolayFilter* ui;
+  QWidget* _widget;
+
+  int _half_window = 0;
+  int _derivative = 0;
+  std::vector<double> _coefficients;
+
+  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
+};
+
+#endif  // SAVITZKY_GOLAY_H
@@ -75,3 +75,21 @@ std::optional<PlotData::Point> ScaleTransform::calculateNextPoint(size_t index)
   PlotData::Point out = { p.x + off_x, scale * p.y + off_y };
   return out;
 }
+
+void ScaleTransform::calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out)
+{
+  // read the widgets once per batch, not once per point
+  const double off_x = ui->lineEditTimeOffset->text().toDouble();
+  const double off_y = ui->lineEditValueOffset->text().toDouble();
+  const double scale = ui->lineEditValueScale->text().toDouble();
+
+  const size_t offset = out.size();
+  out.resize(offset + (last - first));
+  PlotData::Point* dst = out.data() + offset;
+
+  auto it = dataSource()->begin() + first;
+  for (size_t i = 0; i < last - first; i++, ++it)
+  {
+    dst[i] = { it->x + off_x, scale * it->y + off_y };
+  }
+}
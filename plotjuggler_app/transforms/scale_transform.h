@@ -34,11 +34,18 @@ public:
 
   bool xmlLoadState(const QDomElement& parent_element) override;
 
+  bool isStateless() const override
+  {
+    return true;
+  }
+
 private:
   QWidget* _widget;
   Ui::ScaleTransform* ui;
 
   std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
 };
 
 #endif  // SCALE_TRANSFORM_H
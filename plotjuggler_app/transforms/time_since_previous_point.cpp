@@ -17,3 +17,24 @@ std::optional<PlotData::Point> TimeSincePreviousPointTranform::calculateNextPoin
   PlotData::Point out = { p.x, dt };
   return out;
 }
+
+void TimeSincePreviousPointTranform::calculateBatch(size_t first, size_t last,
+                                                    std::vector<PlotData::Point>& out)
+{
+  // the first point has no predecessor
+  first = std::max<size_t>(first, 1);
+  if (first >= last)
+  {
+    return;
+  }
+  const size_t offset = out.size();
+  out.resize(offset + (last - first));
+  PlotData::Point* dst = out.data() + offset;
+
+  auto prev = dataSource()->begin() + (first - 1);
+  for (size_t i = 0; i < last - first; i++, ++prev)
+  {
+    const auto& p = *(prev + 1);
+    dst[i] = { p.x, p.x - prev->x };
+  }
+}
@@ -22,8 +22,15 @@ public:
     return transformName();
   }
 
+  bool isStateless() const override
+  {
+    return true;
+  }
+
 private:
   std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
 };
 
 #endif  // TIME_SINCE_LAST_DATA_POINT_TRANSFORM_H
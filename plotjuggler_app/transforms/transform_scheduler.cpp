@@ -0,0 +1,139 @@
+#include "transform_scheduler.h"
+#include <exception>
+#include <unordered_map>
+#include <QtConcurrent>
+#include "PlotJuggler/performance_monitor.h"
+
+std::vector<std::vector<TransformScheduler::Task>>
+TransformScheduler::buildLevels(const std::vector<Task>& tasks)
+{
+  // which task writes each series
+  std::unordered_map<const PJ::PlotData*, size_t> producer;
+  for (size_t i = 0; i < tasks.size(); i++)
+  {
+    for (const PJ::PlotData* dst : tasks[i].function->dataDestinations())
+    {
+      producer[dst] = i;
+    }
+  }
+
+  std::vector<std::vector<size_t>> inputs(tasks.size());
+  for (size_t i = 0; i < tasks.size(); i++)
+  {
+    for (const PJ::PlotData* src : tasks[i].function->dependencies())
+    {
+      auto it = producer.find(src);
+      if (it != producer.end() && it->second != i)
+      {
+        inputs[i].push_back(it->second);
+      }
+    }
+  }
+
+  // level of a task: 1 + the maximum level of its inputs.
+  // Iterative longest path, that stops at tasks.size() iterations if there is
+  // a cycle; tasks in a cycle keep the level reached at that point.
+  std::vector<size_t> level(tasks.size(), 0);
+  for (size_t iteration = 0; iteration < tasks.size(); iteration++)
+  {
+    bool changed = false;
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+      for (size_t input : inputs[i])
+      {
+        if (level[i] < level[input] + 1)
+        {
+          level[i] = level[input] + 1;
+          changed = true;
+        }
+      }
+    }
+    if (!changed)
+    {
+      break;
+    }
+  }
+
+  std::vector<std::vector<Task>> levels;
+  for (size_t i = 0; i < tasks.size(); i++)
+  {
+    if (levels.size() <= level[i])
+    {
+      levels.resize(level[i] + 1);
+    }
+    // preserves the order() of the tasks inside each level
+    levels[level[i]].push_back(tasks[i]);
+  }
+  return levels;
+}
+
+void TransformScheduler::run(const std::vector<Task>& tasks, bool parallel)
+{
+  auto calculate = [](const Task& task) {
+    PJ::PerformanceMonitor::ScopedTimer timer("Transform", *task.id);
+    task.function->calculate();
+  };
+
+  if (!parallel || tasks.size() < 2)
+  {
+    for (const auto& task : tasks)
+    {
+      calculate(task);
+    }
+    return;
+  }
+
+  for (const auto& level : buildLevels(tasks))
+  {
+    if (level.size() == 1)
+    {
+      calculate(level.front());
+      continue;
+    }
+    // exceptions can not cross the thread pool: store and rethrow the first one
+    std::vector<std::exception_ptr> errors(level.size());
+    auto calculateAt = [&](size_t i) {
+      try
+      {
+        calculate(level[i]);
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+      }
+    };
+    // only the transforms that declare it are moved to the thread pool;
+    // the others are calculated on this thread, in the meantime.
+    std::vector<size_t> pool_indices;
+    std::vector<size_t> local_indices;
+    for (size_t i = 0; i < level.size(); i++)
+    {
+      if (level[i].function->isThreadSafe())
+      {
+        pool_indices.push_back(i);
+      }
+      else
+      {
+        local_indices.push_back(i);
+      }
+    }
+    QFuture<void> pool_future;
+    if (!pool_indices.empty())
+    {
+      pool_future = QtConcurrent::map(pool_indices, calculateAt);
+    }
+    for (size_t i : local_indices)
+    {
+      calculateAt(i);
+    }
+    pool_future.waitForFinished();
+
+    for (const auto& error : errors)
+    {
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+}
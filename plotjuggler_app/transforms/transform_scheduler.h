@@ -0,0 +1,33 @@
+#ifndef TRANSFORM_SCHEDULER_H
+#define TRANSFORM_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include "PlotJuggler/transform_function.h"
+
+// Evaluates a set of transforms respecting the dependencies between them:
+// a transform is calculated after the transforms that produce its inputs
+// (see TransformFunction::dependencies()).
+//
+// The transforms are grouped in levels of the dependency graph; the
+// transforms of the same level are independent and, when parallel is true,
+// the ones that are thread safe (TransformFunction::isThreadSafe()) are
+// calculated concurrently on the global QThreadPool, while the others are
+// calculated on the calling thread. run() returns when all of them are done.
+class TransformScheduler
+{
+public:
+  struct Task
+  {
+    const std::string* id;
+    PJ::TransformFunction* function;
+  };
+
+  // tasks must be sorted by TransformFunction::order()
+  static void run(const std::vector<Task>& tasks, bool parallel);
+
+private:
+  static std::vector<std::vector<Task>> buildLevels(const std::vector<Task>& tasks);
+};
+
+#endif  // TRANSFORM_SCHEDULER_H
@@ -25,6 +25,12 @@ public:
   MessageParserPtr createParser(const std::string& topic_name, const std::string& type_name,
                                 const std::string& schema, PlotDataMapRef& data) override;
 
+  // all the parsers use the same WasmRuntime
+  bool parsersShareState() const override
+  {
+    return true;
+  }
+
 private:
   std::shared_ptr<WasmRuntime> _runtime;
   QString _plugin_name;
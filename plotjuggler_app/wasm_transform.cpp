@@ -0,0 +1,119 @@
+#include "wasm_transform.hpp"
+
+#include <cstring>
+
+namespace PJ
+{
+
+TransformWASM::TransformWASM(std::string module_path, std::string transform_name)
+  : _module_path(std::move(module_path)), _name(std::move(transform_name))
+{
+  initRuntime();
+}
+
+TransformWASM::~TransformWASM()
+{
+  if (_runtime)
+  {
+    _runtime->freeWasmMemory(_input_ptr);
+    _runtime->freeWasmMemory(_output_ptr);
+  }
+}
+
+void TransformWASM::initRuntime()
+{
+  _transform_func.reset();
+  _input_ptr = 0;
+  _output_ptr = 0;
+  _capacity = 0;
+  _runtime = std::make_unique<WasmRuntime>(_module_path);
+  _transform_func = _runtime->getFunc("pj_transform");
+}
+
+void TransformWASM::reset()
+{
+  TransformFunction_SISO::reset();
+  try
+  {
+    auto reset_func = _runtime->getFunc("pj_transform_reset");
+    reset_func.call(_runtime->store(), {}).unwrap();
+  }
+  catch (const std::exception&)
+  {
+    // no reset function: a new instance of the module is the only way
+    // to be sure that its state is clean
+    initRuntime();
+  }
+}
+
+void TransformWASM::reserve(size_t num_points)
+{
+  if (num_points <= _capacity)
+  {
+    return;
+  }
+  if (_input_ptr != 0)
+  {
+    _runtime->freeWasmMemory(_input_ptr);
+    _runtime->freeWasmMemory(_output_ptr);
+    _input_ptr = 0;
+    _output_ptr = 0;
+  }
+  const size_t bytes = num_points * 2 * sizeof(double);
+  _input_ptr = _runtime->allocateBuffer(nullptr, bytes);
+  _output_ptr = _runtime->allocateBuffer(nullptr, bytes);
+  _capacity = num_points;
+}
+
+std::optional<PlotData::Point> TransformWASM::calculateNextPoint(size_t index)
+{
+  std::vector<PlotData::Point> out;
+  calculateBatch(index, index + 1, out);
+  if (out.empty())
+  {
+    return std::nullopt;
+  }
+  return out.front();
+}
+
+void TransformWASM::calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out)
+{
+  const size_t count = last - first;
+  if (count == 0)
+  {
+    return;
+  }
+  reserve(count);
+
+  // write the samples straight into the linear memory of the module
+  const PlotData& src_data = *dataSource();
+  double* input = reinterpret_cast<double*>(_runtime->memoryPointer(_input_ptr));
+  for (size_t i = 0; i < count; i++)
+  {
+    const auto& p = src_data.at(first + i);
+    input[2 * i] = p.x;
+    input[2 * i + 1] = p.y;
+  }
+
+  std::vector<wasmtime::Val> params = { _input_ptr, int32_t(count), _output_ptr };
+  auto results = _transform_func->call(_runtime->store(), params);
+  if (!results)
+  {
+    throw std::runtime_error(_name + ": " + results.err().message());
+  }
+  const int32_t out_count = results.ok().empty() ? int32_t(count) : results.ok()[0].i32();
+  if (out_count < 0 || size_t(out_count) > count)
+  {
+    throw std::runtime_error(_name + ": pj_transform returned an invalid number of points");
+  }
+
+  // the memory may have grown during the call: get the pointer again
+  const double* output = reinterpret_cast<const double*>(_runtime->memoryPointer(_output_ptr));
+  out.reserve(out.size() + size_t(out_count));
+  for (int32_t i = 0; i < out_count; i++)
+  {
+    out.push_back({ output[2 * i], output[2 * i + 1] });
+  }
+}
+
+}  // namespace PJ
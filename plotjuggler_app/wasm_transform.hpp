@@ -0,0 +1,58 @@
+#pragma once
+
+#include "PlotJuggler/transform_function.h"
+#include "wasm_runtime.hpp"
+
+namespace PJ
+{
+
+/**
+ * Single input / single output transform implemented by a WASM module, that exports:
+ *
+ *   // process n points; input and output are arrays of n pairs [time, value].
+ *   // Returns the number of points written in output (at most n).
+ *   int32_t pj_transform(const double* input, uint32_t n, double* output);
+ *
+ *   // optional: clear the internal state of the filter.
+ *   void pj_transform_reset();
+ *
+ * Each instance has its own WASM runtime, therefore the state of the module
+ * is not shared between series. The host writes the samples directly into the
+ * linear memory of the module and reads the results from it.
+ */
+class TransformWASM : public TransformFunction_SISO
+{
+public:
+  TransformWASM(std::string module_path, std::string transform_name);
+
+  ~TransformWASM() override;
+
+  const char* name() const override
+  {
+    return _name.c_str();
+  }
+
+  void reset() override;
+
+private:
+  std::string _module_path;
+  std::string _name;
+
+  std::unique_ptr<WasmRuntime> _runtime;
+  std::optional<wasmtime::Func> _transform_func;
+
+  // buffers allocated in the linear memory of the module, in number of points
+  int32_t _input_ptr = 0;
+  int32_t _output_ptr = 0;
+  size_t _capacity = 0;
+
+  void initRuntime();
+
+  void reserve(size_t num_points);
+
+  std::optional<PlotData::Point> calculateNextPoint(size_t index) override;
+
+  void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out) override;
+};
+
+}  // namespace PJ
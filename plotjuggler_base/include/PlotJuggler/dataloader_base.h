@@ -62,7 +62,7 @@ using DataLoaderPtr = std::shared_ptr<DataLoader>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define DataRead_iid "facontidavide.PlotJuggler3.DataLoader"
+#define DataRead_iid "facontidavide.PlotJuggler3.DataLoader/2"
 Q_DECLARE_INTERFACE(PJ::DataLoader, DataRead_iid)
 QT_END_NAMESPACE
 
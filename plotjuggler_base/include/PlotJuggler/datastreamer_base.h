@@ -112,7 +112,7 @@ using DataStreamerPtr = std::shared_ptr<DataStreamer>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define DataStream_iid "facontidavide.PlotJuggler3.DataStreamer"
+#define DataStream_iid "facontidavide.PlotJuggler3.DataStreamer/2"
 Q_DECLARE_INTERFACE(PJ::DataStreamer, DataStream_iid)
 QT_END_NAMESPACE
 
@@ -0,0 +1,44 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PJ_LUA_ENGINE_H
+#define PJ_LUA_ENGINE_H
+
+struct lua_State;
+
+namespace PJ
+{
+/**
+ * @brief Settings of the Lua engine shared by the custom functions,
+ * the reactive scripts and the colormaps.
+ *
+ * PlotJuggler is linked either to the reference Lua interpreter or, when built
+ * with the CMake option PJ_USE_LUAJIT, to LuaJIT. In the latter case, the JIT
+ * compiler can be disabled at runtime; the setting is applied to the Lua states
+ * created (or re-initialized) afterwards.
+ */
+namespace LuaEngine
+{
+/// Name and version of the Lua implementation, for instance "Lua 5.4".
+const char* name();
+
+/// True if built with LuaJIT (the "ffi" and "jit" libraries are available).
+bool isLuaJIT();
+
+void setJitEnabled(bool enabled);
+
+bool isJitEnabled();
+
+/// Apply the current settings to a new state, and make the functions of the
+/// standard libraries used by the snippets available in both engines
+/// (math.atan2). Call it after open_libraries().
+void configure(lua_State* state);
+
+}  // namespace LuaEngine
+
+}  // namespace PJ
+
+#endif  // PJ_LUA_ENGINE_H
@@ -148,6 +148,13 @@ public:
   // decode a specific schema.
   virtual MessageParserPtr createParser(const std::string& topic_name, const std::string& type_name,
                                         const std::string& schema, PlotDataMapRef& data) = 0;
+
+  // true if the parsers created by this factory share a state (for instance a runtime
+  // that is not thread safe): they must not be used by different threads at the same time.
+  virtual bool parsersShareState() const
+  {
+    return false;
+  }
 };
 
 using ParserFactoryPtr = std::shared_ptr<ParserFactoryPlugin>;
@@ -156,6 +163,6 @@ using ParserFactories = std::map<QString, ParserFactoryPtr>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define ParserFactoryPlugin_iid "facontidavide.PlotJuggler3.ParserFactoryPlugin"
+#define ParserFactoryPlugin_iid "facontidavide.PlotJuggler3.ParserFactoryPlugin/2"
 Q_DECLARE_INTERFACE(PJ::ParserFactoryPlugin, ParserFactoryPlugin_iid)
 QT_END_NAMESPACE
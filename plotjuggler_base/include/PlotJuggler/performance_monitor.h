@@ -0,0 +1,126 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PJ_PERFORMANCE_MONITOR_H
+#define PJ_PERFORMANCE_MONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace PJ
+{
+/**
+ * @brief Collects the duration of the stages of the ingest -> transform -> render
+ * pipeline (and a few counters, like the number of points drawn) in a rolling window.
+ *
+ * It is disabled by default; when disabled, ScopedTimer and addSample() cost
+ * a single atomic load, as long as the label of the ScopedTimer is a literal, an
+ * existing string or a function that builds it (called only if enabled).
+ * It can be used from any thread.
+ */
+class PerformanceMonitor
+{
+public:
+  // category and label, for instance {"Transform", "my_series[Derivative]"}
+  using Key = std::pair<std::string, std::string>;
+
+  struct Statistics
+  {
+    double last = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+    size_t count = 0;
+  };
+
+  static PerformanceMonitor& instance();
+
+  bool isEnabled() const
+  {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+
+  void setEnabled(bool enabled);
+
+  void addSample(const std::string& category, const std::string& label, double value);
+
+  std::map<Key, Statistics> statistics() const;
+
+  void clear();
+
+  /// Measure the lifetime of the object, in milliseconds.
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(const char* category, const char* label)
+      : ScopedTimer(category, [label]() { return std::string(label); })
+    {
+    }
+
+    ScopedTimer(const char* category, const std::string& label)
+      : ScopedTimer(category, [&label]() { return label; })
+    {
+    }
+
+    /// make_label returns the label. It is not called if the monitor is disabled.
+    template <typename LabelFunction,
+              typename = std::enable_if_t<std::is_invocable_r_v<std::string, LabelFunction>>>
+    ScopedTimer(const char* category, LabelFunction&& make_label) : _category(category)
+    {
+      if (PerformanceMonitor::instance().isEnabled())
+      {
+        _label = make_label();
+        _active = true;
+        _start = std::chrono::steady_clock::now();
+      }
+    }
+
+    ~ScopedTimer()
+    {
+      if (_active)
+      {
+        auto elapsed = std::chrono::steady_clock::now() - _start;
+        double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        PerformanceMonitor::instance().addSample(_category, _label, ms);
+      }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    const char* _category;
+    std::string _label;
+    bool _active = false;
+    std::chrono::steady_clock::time_point _start;
+  };
+
+private:
+  PerformanceMonitor() = default;
+
+  static constexpr size_t WINDOW_SIZE = 256;
+
+  struct Window
+  {
+    std::vector<double> samples;
+    size_t next = 0;
+    size_t count = 0;
+    double last = 0;
+  };
+
+  std::atomic_bool _enabled{ false };
+  mutable std::mutex _mutex;
+  std::map<Key, Window> _windows;
+};
+
+}  // namespace PJ
+
+#endif  // PJ_PERFORMANCE_MONITOR_H
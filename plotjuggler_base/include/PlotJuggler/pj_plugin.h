@@ -18,6 +18,12 @@ namespace PJ
 
 /**
  * @brief The PlotJugglerPlugin is the base class of all the plugins.
+ *
+ * The IIDs of the plugin interfaces (DataRead_iid, Toolbox_iid, etc.) end with the
+ * version of their binary interface. It is incremented when a plugin interface, or a
+ * data structure they share like PlotDataMapRef, changes its layout: the plugins built
+ * with the older headers are then ignored by qobject_cast, instead of crashing.
+ * The plugins must use these macros in Q_PLUGIN_METADATA.
  */
 class PlotJugglerPlugin : public QObject
 {
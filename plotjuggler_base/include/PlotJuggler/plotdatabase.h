@@ -117,6 +117,37 @@ private:
   Attributes _attributes;
 };
 
+/**
+ * @brief Identity of a series object. Unlike its address, it can not be reused by
+ * another series after this one is destroyed: the weak reference returned by
+ * token() simply expires.
+ * Copying or moving a series creates a new identity.
+ */
+class SeriesIdentity
+{
+public:
+  SeriesIdentity() : _token(std::make_shared<char>())
+  {
+  }
+
+  SeriesIdentity(const SeriesIdentity&) : SeriesIdentity()
+  {
+  }
+
+  SeriesIdentity& operator=(const SeriesIdentity&)
+  {
+    return *this;
+  }
+
+  std::weak_ptr<const void> token() const
+  {
+    return _token;
+  }
+
+private:
+  std::shared_ptr<char> _token;
+};
+
 // A Generic series of points
 template <typename TypeX, typename Value>
 class PlotDataBase
@@ -184,6 +215,11 @@ public:
     return _group;
   }
 
+  const SeriesIdentity& identity() const
+  {
+    return _identity;
+  }
+
   void changeGroup(PlotGroup::Ptr group)
   {
     _group = group;
@@ -403,6 +439,28 @@ public:
     _points.pop_front();
   }
 
+  virtual void popBack()
+  {
+    const auto& p = _points.back();
+
+    if constexpr (std::is_arithmetic_v<TypeX>)
+    {
+      if (!_range_x_dirty && (p.x == _range_x.max || p.x == _range_x.min))
+      {
+        _range_x_dirty = true;
+      }
+    }
+
+    if constexpr (std::is_arithmetic_v<Value>)
+    {
+      if (!_range_y_dirty && (p.y == _range_y.max || p.y == _range_y.min))
+      {
+        _range_y_dirty = true;
+      }
+    }
+    _points.pop_back();
+  }
+
 protected:
   std::string _name;
   Attributes _attributes;
@@ -413,6 +471,7 @@ protected:
   mutable bool _range_x_dirty;
   mutable bool _range_y_dirty;
   mutable std::shared_ptr<PlotGroup> _group;
+  SeriesIdentity _identity;
 
   // template specialization for types that support compare operator
   virtual void pushUpdateRangeX(const Point& p)
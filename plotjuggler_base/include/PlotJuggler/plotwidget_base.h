@@ -34,7 +34,8 @@ public:
     LINES_AND_DOTS,
     STICKS,
     STEPS,
-    STEPSINV
+    STEPSINV,
+    DENSITY  // 2D histogram of the samples, meant for XY plots
   };
 
   struct CurveInfo
@@ -99,6 +100,35 @@ public:
 
   void setAcceptDrops(bool accept);
 
+  // When enabled, a replot that only slides the X axis forward (follow-mode
+  // streaming) reuses the previous frame and paints only the new samples.
+  // Any change of zoom, autoscale or canvas size falls back to a full repaint.
+  void setScrollBlitEnabled(bool enabled);
+
+  bool isScrollBlitEnabled() const;
+
+  // Force the next replot to repaint all the samples, for instance
+  // when the content of the series changed without appending.
+  void invalidateScrollBlit();
+
+  // If enabled, the curves of the widgets replotted inside a ReplotBatch are
+  // rasterized off-screen by a pool of worker threads, using a copy of the
+  // visible samples, and then blitted on the canvas by the GUI thread.
+  static void setParallelRendering(bool enable);
+
+  static bool parallelRendering();
+
+  // RAII scope: the calls to replot() are deferred until the outermost
+  // batch is destroyed. It has no effect if parallel rendering is disabled.
+  class ReplotBatch
+  {
+  public:
+    ReplotBatch();
+    ~ReplotBatch();
+    ReplotBatch(const ReplotBatch&) = delete;
+    ReplotBatch& operator=(const ReplotBatch&) = delete;
+  };
+
 public slots:
 
   void replot();
@@ -138,6 +168,8 @@ protected:
   bool eventFilter(QObject* obj, QEvent* event);
 
 private:
+  static void flushPendingReplots();
+
   bool _xy_mode;
 
   QRectF _max_zoom_rect;
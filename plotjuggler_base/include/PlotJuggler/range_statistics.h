@@ -0,0 +1,313 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PJ_RANGE_STATISTICS_H
+#define PJ_RANGE_STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace PJ
+{
+/**
+ * @brief Mergeable aggregates of a set of values.
+ */
+struct RangeStatistics
+{
+  size_t count = 0;
+  double sum = 0;
+  double sum_sq = 0;
+  double min = std::numeric_limits<double>::max();
+  double max = std::numeric_limits<double>::lowest();
+
+  // time of the first and last sample, filled by TimeseriesBase::statistics()
+  double first_time = 0;
+  double last_time = 0;
+
+  void add(double value)
+  {
+    count++;
+    sum += value;
+    sum_sq += value * value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+
+  void merge(const RangeStatistics& other)
+  {
+    count += other.count;
+    sum += other.sum;
+    sum_sq += other.sum_sq;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+
+  double mean() const
+  {
+    return count > 0 ? sum / double(count) : 0.0;
+  }
+
+  double variance() const
+  {
+    if (count == 0)
+    {
+      return 0.0;
+    }
+    const double m = mean();
+    // clamp the rounding errors of sum_sq - N*mean^2
+    return std::max(0.0, sum_sq / double(count) - m * m);
+  }
+
+  double stdDev() const
+  {
+    return std::sqrt(variance());
+  }
+
+  double rms() const
+  {
+    return count > 0 ? std::sqrt(sum_sq / double(count)) : 0.0;
+  }
+};
+
+/**
+ * @brief Pyramid of RangeStatistics over the samples of a series, used to get
+ * the statistics of an arbitrary range of indices in O(log N).
+ *
+ * The lowest level stores the aggregates of chunks of CHUNK_SIZE samples, each
+ * upper level merges FANOUT entries of the level below. The index is built
+ * lazily by query() and follows the series through these notifications:
+ *
+ * - samples appended at the back: nothing to do.
+ * - popFront(): a sample was removed from the front.
+ * - invalidateFrom(): the samples from that index changed (out of order insertion).
+ * - reset(): the series was cleared.
+ *
+ * query() is const for the series, but it updates the index: a mutex allows
+ * concurrent queries, as long as the samples are not modified at the same time.
+ * The notifications come from the thread that modifies the series, that can't run
+ * concurrently with the queries: they don't lock it, to keep the writes cheap.
+ */
+class StatisticsIndex
+{
+public:
+  static constexpr size_t CHUNK_SIZE = 256;
+  static constexpr size_t FANOUT = 16;
+
+  StatisticsIndex() = default;
+
+  // the mutex is not movable: only the content is moved
+  StatisticsIndex(StatisticsIndex&& other)
+    : _popped(other._popped), _levels(std::move(other._levels))
+  {
+  }
+
+  StatisticsIndex& operator=(StatisticsIndex&& other)
+  {
+    if (this != &other)
+    {
+      _popped = other._popped;
+      _levels = std::move(other._levels);
+    }
+    return *this;
+  }
+
+  void reset()
+  {
+    _levels.clear();
+    _popped = 0;
+  }
+
+  void popFront()
+  {
+    _popped++;
+  }
+
+  void invalidateFrom(size_t index)
+  {
+    const size_t abs_index = _popped + index;
+    size_t span = CHUNK_SIZE;
+    for (auto& level : _levels)
+    {
+      // keep only the entries that end before abs_index
+      const size_t keep_end = abs_index / span;
+      const size_t keep = (keep_end > level.first) ? keep_end - level.first : 0;
+      if (keep < level.entries.size())
+      {
+        level.entries.resize(keep);
+      }
+      span *= FANOUT;
+    }
+  }
+
+  /// Statistics of the values in the range of indices [first, last).
+  /// ValueOf is a functor that returns the value of the sample at a given index.
+  template <typename ValueOf>
+  RangeStatistics query(size_t series_size, size_t first, size_t last, ValueOf value_of)
+  {
+    RangeStatistics out;
+    last = std::min(last, series_size);
+    if (first >= last)
+    {
+      return out;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    update(series_size, value_of);
+
+    auto scan = [&](size_t abs_from, size_t abs_to) {
+      for (size_t i = abs_from; i < abs_to; i++)
+      {
+        out.add(value_of(i - _popped));
+      }
+    };
+
+    const size_t a = _popped + first;
+    const size_t b = _popped + last;
+    const size_t c0 = (a + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const size_t c1 = b / CHUNK_SIZE;
+    if (c0 >= c1 || _levels.empty())
+    {
+      scan(a, b);
+      return out;
+    }
+    scan(a, c0 * CHUNK_SIZE);
+    scan(c1 * CHUNK_SIZE, b);
+    queryLevel(0, c0, c1, out);
+    return out;
+  }
+
+private:
+  struct Level
+  {
+    // absolute index of entries.front()
+    size_t first = 0;
+    std::deque<RangeStatistics> entries;
+
+    size_t end() const
+    {
+      return first + entries.size();
+    }
+    const RangeStatistics& at(size_t abs_index) const
+    {
+      return entries[abs_index - first];
+    }
+  };
+
+  std::mutex _mutex;
+  // absolute index of the first sample of the series
+  size_t _popped = 0;
+  std::vector<Level> _levels;
+
+  template <typename ValueOf>
+  void update(size_t series_size, ValueOf& value_of)
+  {
+    // level 0: complete chunks
+    if (_levels.empty())
+    {
+      _levels.emplace_back();
+    }
+    const size_t complete_chunks = (_popped + series_size) / CHUNK_SIZE;
+    const size_t first_chunk = (_popped + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    extendLevel(
+        _levels[0], first_chunk, CHUNK_SIZE,
+        [&](size_t chunk) { return chunk < complete_chunks; },
+        [&](size_t chunk) {
+          RangeStatistics stat;
+          const size_t begin = chunk * CHUNK_SIZE - _popped;
+          for (size_t i = begin; i < begin + CHUNK_SIZE; i++)
+          {
+            stat.add(value_of(i));
+          }
+          return stat;
+        });
+
+    // upper levels: FANOUT complete entries of the level below
+    size_t span = CHUNK_SIZE;
+    for (size_t L = 1;; L++)
+    {
+      // copies: emplace_back may reallocate _levels
+      const size_t child_first = _levels[L - 1].first;
+      const size_t child_end = _levels[L - 1].end();
+      if (child_end - child_first < FANOUT && L >= _levels.size())
+      {
+        break;
+      }
+      if (L >= _levels.size())
+      {
+        _levels.emplace_back();
+      }
+      span *= FANOUT;
+      extendLevel(_levels[L], (child_first + FANOUT - 1) / FANOUT, span,
+                  [&](size_t parent) { return (parent + 1) * FANOUT <= child_end; },
+                  [&](size_t parent) {
+                    const Level& lower = _levels[L - 1];
+                    RangeStatistics stat;
+                    for (size_t c = parent * FANOUT; c < (parent + 1) * FANOUT; c++)
+                    {
+                      stat.merge(lower.at(c));
+                    }
+                    return stat;
+                  });
+    }
+  }
+
+  // append the entries [max(level.end(), start), ...) while is_complete(),
+  // after removing the entries that cover only samples already popped.
+  template <typename IsComplete, typename Compute>
+  void extendLevel(Level& level, size_t start, size_t span, IsComplete is_complete,
+                   Compute compute)
+  {
+    while (!level.entries.empty() && (level.first + 1) * span <= _popped)
+    {
+      level.entries.pop_front();
+      level.first++;
+    }
+    if (level.end() < start)
+    {
+      level.entries.clear();
+      level.first = start;
+    }
+    while (is_complete(level.end()))
+    {
+      level.entries.push_back(compute(level.end()));
+    }
+  }
+
+  void queryLevel(size_t L, size_t lo, size_t hi, RangeStatistics& out) const
+  {
+    const Level& level = _levels[L];
+    if (L + 1 < _levels.size())
+    {
+      const size_t p0 = (lo + FANOUT - 1) / FANOUT;
+      const size_t p1 = hi / FANOUT;
+      const Level& parent = _levels[L + 1];
+      if (p0 < p1 && parent.first <= p0 && p1 <= parent.end())
+      {
+        for (size_t i = lo; i < p0 * FANOUT; i++)
+        {
+          out.merge(level.at(i));
+        }
+        for (size_t i = p1 * FANOUT; i < hi; i++)
+        {
+          out.merge(level.at(i));
+        }
+        queryLevel(L + 1, p0, p1, out);
+        return;
+      }
+    }
+    for (size_t i = lo; i < hi; i++)
+    {
+      out.merge(level.at(i));
+    }
+  }
+};
+
+}  // namespace PJ
+
+#endif  // PJ_RANGE_STATISTICS_H
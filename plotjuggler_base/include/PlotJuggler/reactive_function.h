@@ -8,6 +8,8 @@
 #define REACTIVE_FUNCTION_H
 
 #include "PlotJuggler/transform_function.h"
+#include <map>
+#include <memory>
 #include <sol/sol.hpp>
 
 class TimeseriesRef;
@@ -38,7 +40,8 @@ struct TimeseriesRef
 
 struct CreatedSeriesBase
 {
-  CreatedSeriesBase(PlotDataMapRef* data_map, const std::string& name, bool timeseries);
+  CreatedSeriesBase(PlotDataMapRef* data_map, const std::string& name, bool timeseries,
+                    bool incremental = false);
 
   std::pair<double, double> at(unsigned i) const;
 
@@ -46,19 +49,32 @@ struct CreatedSeriesBase
 
   void push_back(double x, double y);
 
+  void pop_back();
+
   unsigned size() const;
 
+  // Incremental mode: clear() only moves the write position to the beginning and
+  // push_back() skips the points that are equal to the existing ones, so that a
+  // script rebuilding the whole series modifies only the points that changed.
+  void beginWrite();
+
+  // Remove the points after the write position (incremental mode only).
+  void finishWrite();
+
   PJ::PlotDataXY* _plot_data = nullptr;
+
+  // shared by the copies of this object, nullptr if not incremental
+  std::shared_ptr<size_t> _write_index;
 };
 
 struct CreatedSeriesTime : public CreatedSeriesBase
 {
-  CreatedSeriesTime(PlotDataMapRef* data_map, const std::string& name);
+  CreatedSeriesTime(PlotDataMapRef* data_map, const std::string& name, bool incremental = false);
 };
 
 struct CreatedSeriesXY : public CreatedSeriesBase
 {
-  CreatedSeriesXY(PlotDataMapRef* data_map, const std::string& name);
+  CreatedSeriesXY(PlotDataMapRef* data_map, const std::string& name, bool incremental = false);
 };
 
 //-----------------------
@@ -66,8 +82,10 @@ struct CreatedSeriesXY : public CreatedSeriesBase
 class ReactiveLuaFunction : public PJ::TransformFunction
 {
 public:
+  /// With incremental_outputs, the created series are patched instead of being
+  /// rebuilt: see CreatedSeriesBase::beginWrite().
   ReactiveLuaFunction(PlotDataMapRef* data_map, QString lua_global, QString lua_function,
-                      QString lua_library);
+                      QString lua_library, bool incremental_outputs = false);
 
   const char* name() const override
   {
@@ -90,6 +108,32 @@ public:
 
   void calculate() override;
 
+  /// True if the tracker time, or one of the series read by the script, changed
+  /// since the last execution.
+  bool needsUpdate() const;
+
+  /// Execute calculate() only if needsUpdate(). Return true if it was executed.
+  bool calculateIfNeeded();
+
+  struct ExecutionStats
+  {
+    size_t runs = 0;
+    size_t skipped = 0;
+    double last_ms = 0;
+    double max_ms = 0;
+    double total_ms = 0;
+  };
+
+  const ExecutionStats& executionStats() const
+  {
+    return _stats;
+  }
+
+  bool incrementalOutputs() const
+  {
+    return _incremental_outputs;
+  }
+
   const std::vector<std::string>& createdCurves() const
   {
     return _created_curves;
@@ -128,6 +172,40 @@ protected:
 
 private:
   void init();
+
+  // what is compared to detect that a series read by the script changed
+  struct InputState
+  {
+    bool exists = false;
+    uint64_t revision = 0;
+    size_t size = 0;
+    double front = 0;
+    double back = 0;
+
+    bool operator==(const InputState& other) const
+    {
+      return exists == other.exists && revision == other.revision && size == other.size &&
+             front == other.front && back == other.back;
+    }
+  };
+
+  InputState inputState(const std::string& name) const;
+
+  // add the series to _outputs, unless it is already there: in that case, series
+  // shares the write position of the existing one
+  void addOutput(CreatedSeriesBase& series, const std::string& name);
+
+  bool _incremental_outputs = false;
+  std::vector<CreatedSeriesBase> _outputs;
+
+  // series searched with TimeseriesView.find(), also the ones not found
+  std::map<std::string, InputState> _inputs;
+  bool _reads_series_names = false;
+  size_t _series_count = 0;
+
+  bool _has_run = false;
+  double _last_run_tracker = 0;
+  ExecutionStats _stats;
 };
 
 }  // namespace PJ
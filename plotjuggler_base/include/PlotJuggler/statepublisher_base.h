@@ -57,7 +57,7 @@ using StatePublisherPtr = std::shared_ptr<StatePublisher>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define StatePublisher_iid "facontidavide.PlotJuggler3.StatePublisher"
+#define StatePublisher_iid "facontidavide.PlotJuggler3.StatePublisher/2"
 Q_DECLARE_INTERFACE(PJ::StatePublisher, StatePublisher_iid)
 QT_END_NAMESPACE
 
@@ -0,0 +1,91 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PJ_TIME_ALIGNMENT_H
+#define PJ_TIME_ALIGNMENT_H
+
+#include <limits>
+#include <vector>
+#include "PlotJuggler/plotdata.h"
+
+namespace PJ
+{
+/// How the value of a series is obtained at a time that is not one of its samples.
+enum InterpolationMode
+{
+  NEAREST,          // closest sample, like PlotData::getYfromX()
+  ZERO_ORDER_HOLD,  // last sample with time <= t, NaN before the first one
+  LINEAR            // between the samples around t, first/last value outside the series
+};
+
+/**
+ * @brief Values of a series at the sorted times [times, times + count).
+ *
+ * The samples around each time are found with a single merge pass, O(N + M),
+ * then the interpolation is applied to contiguous arrays, in a loop that the
+ * compiler can vectorize. The values are NaN if the series is empty.
+ */
+void AlignSeries(const PlotData& series, const double* times, size_t count,
+                 InterpolationMode mode, double* out);
+
+/// Times t_min + k * period, up to t_max: a common grid to resample several series.
+std::vector<double> RegularTimeGrid(double t_min, double t_max, double period);
+
+/**
+ * @brief k-way merge of the timestamps of several series.
+ *
+ * Each call to next() moves to the following time of the union of the series;
+ * sample(i) returns the sample of the i-th series at that time, if any.
+ * Samples closer than the tolerance are considered simultaneous.
+ */
+class TimeMerger
+{
+public:
+  /// Only the samples with time in [t_min, t_max] are visited.
+  TimeMerger(const std::vector<const PlotData*>& series,
+             double t_min = std::numeric_limits<double>::lowest(),
+             double t_max = std::numeric_limits<double>::max(), double tolerance = 0.0);
+
+  /// Return false when all the samples were visited.
+  bool next();
+
+  double time() const
+  {
+    return _time;
+  }
+
+  /// Sample of the i-th series at time(), nullptr if it has none.
+  const PlotData::Point* sample(size_t i) const
+  {
+    return _current[i];
+  }
+
+private:
+  struct Entry
+  {
+    double time;
+    size_t series;
+    bool operator>(const Entry& other) const
+    {
+      return time > other.time || (time == other.time && series > other.series);
+    }
+  };
+
+  std::vector<const PlotData*> _series;
+  std::vector<size_t> _cursors;
+  std::vector<const PlotData::Point*> _current;
+  // min-heap of the next sample of each series
+  std::vector<Entry> _heap;
+  double _t_max;
+  double _tolerance;
+  double _time = 0;
+
+  void push(size_t series);
+};
+
+}  // namespace PJ
+
+#endif  // PJ_TIME_ALIGNMENT_H
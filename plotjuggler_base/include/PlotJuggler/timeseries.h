@@ -8,7 +8,9 @@
 #define PJ_TIMESERIES_H
 
 #include "plotdatabase.h"
+#include "range_statistics.h"
 #include <algorithm>
+#include <deque>
 
 namespace PJ
 {
@@ -18,6 +20,14 @@ class TimeseriesBase : public PlotDataBase<double, Value>
 protected:
   double _max_range_x;
   using PlotDataBase<double, Value>::_points;
+  mutable StatisticsIndex _statistics_index;
+
+  // see revision() and earliestChangeSince()
+  uint64_t _revision = 0;
+  // _changes contains all the changes after this revision
+  uint64_t _log_start = 0;
+  std::deque<std::pair<uint64_t, double>> _changes;
+  static constexpr size_t MAX_CHANGES_LOG = 64;
 
 public:
   using Point = typename PlotDataBase<double, Value>::Point;
@@ -31,7 +41,18 @@ public:
   TimeseriesBase(TimeseriesBase&& other) = default;
 
   TimeseriesBase& operator=(const TimeseriesBase& other) = delete;
-  TimeseriesBase& operator=(TimeseriesBase&& other) = default;
+  TimeseriesBase& operator=(TimeseriesBase&& other)
+  {
+    const uint64_t revision = std::max(_revision, other._revision) + 1;
+    PlotDataBase<double, Value>::operator=(std::move(other));
+    _max_range_x = other._max_range_x;
+    _statistics_index = std::move(other._statistics_index);
+    // all the points were replaced, as if the series was cleared
+    _revision = revision;
+    _log_start = revision;
+    _changes.clear();
+    return *this;
+  }
 
   virtual bool isTimeseries() const override
   {
@@ -57,6 +78,122 @@ public:
     return (index < 0) ? std::nullopt : std::optional(_points[index].y);
   }
 
+  /**
+   * @brief Replace the point at the given index, recording the change like an insertion
+   * out of order: see revision() and earliestChangeSince().
+   * The points must be modified only with this method, not through at() or operator[],
+   * that would leave statistics() and the incremental consumers out of date.
+   */
+  void set(size_t index, const Point& p)
+  {
+    _statistics_index.invalidateFrom(index);
+    Point& point = _points[index];
+    logChange(std::min(point.x, p.x));
+    point = p;
+  }
+
+  /**
+   * @brief Statistics of the values with time in [t_min, t_max], in O(log N).
+   * Available only for numeric values.
+   * It can be called concurrently from multiple threads, but not while the
+   * series is being modified.
+   */
+  RangeStatistics statistics(double t_min, double t_max) const
+  {
+    static_assert(std::is_arithmetic_v<Value>, "statistics() requires numeric values");
+    auto first = std::lower_bound(_points.begin(), _points.end(), Point(t_min, {}), TimeCompare);
+    auto last = std::upper_bound(first, _points.end(), Point(t_max, {}), TimeCompare);
+    const size_t first_index = std::distance(_points.begin(), first);
+    const size_t last_index = std::distance(_points.begin(), last);
+
+    auto stat = _statistics_index.query(_points.size(), first_index, last_index,
+                                        [this](size_t i) { return double(_points[i].y); });
+    if (stat.count > 0)
+    {
+      stat.first_time = _points[first_index].x;
+      stat.last_time = _points[last_index - 1].x;
+    }
+    return stat;
+  }
+
+  /**
+   * @brief Counter incremented when a point is inserted out of order, replaced with set()
+   * or removed from the back, and when the series is cleared. Appending points at the back and
+   * trimming the front do not change it.
+   * Incremental consumers, like the transforms, use it with earliestChangeSince().
+   */
+  uint64_t revision() const
+  {
+    return _revision;
+  }
+
+  /**
+   * @brief Time of the oldest point inserted out of order (or replaced, or removed from
+   * the back) after the given revision: std::nullopt if nothing changed, lowest() if the series
+   * was cleared (or replaced) or the changes are too many to be tracked.
+   */
+  std::optional<double> earliestChangeSince(uint64_t revision) const
+  {
+    if (revision == _revision)
+    {
+      return std::nullopt;
+    }
+    // the revision must be one of the logged ones: the series may have been
+    // cleared, moved or swapped with another one in the meantime.
+    bool known = (revision == _log_start);
+    double earliest = std::numeric_limits<double>::max();
+    for (const auto& [change_revision, time] : _changes)
+    {
+      if (change_revision == revision)
+      {
+        known = true;
+      }
+      else if (change_revision > revision)
+      {
+        earliest = std::min(earliest, time);
+      }
+    }
+    return known ? earliest : std::numeric_limits<double>::lowest();
+  }
+
+  void clonePoints(const TimeseriesBase& other)
+  {
+    markCleared();
+    PlotDataBase<double, Value>::clonePoints(other);
+  }
+
+  void clonePoints(TimeseriesBase&& other)
+  {
+    markCleared();
+    PlotDataBase<double, Value>::clonePoints(std::move(other));
+  }
+
+  void clear() override
+  {
+    markCleared();
+    PlotDataBase<double, Value>::clear();
+  }
+
+  void popFront() override
+  {
+    _statistics_index.popFront();
+    PlotDataBase<double, Value>::popFront();
+  }
+
+  void popBack() override
+  {
+    _statistics_index.invalidateFrom(_points.size() - 1);
+    logChange(_points.back().x);
+    PlotDataBase<double, Value>::popBack();
+  }
+
+  void insert(typename PlotDataBase<double, Value>::Iterator it, Point&& p) override
+  {
+    _statistics_index.invalidateFrom(std::distance(_points.begin(), it));
+    logChange(p.x);
+    PlotDataBase<double, Value>::insert(it, std::move(p));
+  }
+
   void pushBack(const Point& p) override
   {
     auto temp = p;
@@ -71,7 +208,7 @@ public:
     {
       auto it = std::upper_bound(_points.begin(), _points.end(), p,
                                  [](const auto& a, const auto& b) { return a.x < b.x; });
-      PlotDataBase<double, Value>::insert(it, std::move(p));
+      insert(it, std::move(p));
     }
     else
     {
@@ -81,6 +218,23 @@ public:
   }
 
 private:
+  void logChange(double time)
+  {
+    _changes.push_back({ ++_revision, time });
+    if (_changes.size() > MAX_CHANGES_LOG)
+    {
+      _log_start = _changes.front().first;
+      _changes.pop_front();
+    }
+  }
+
+  void markCleared()
+  {
+    _statistics_index.reset();
+    _log_start = ++_revision;
+    _changes.clear();
+  }
+
   void trimRange()
   {
     if (_max_range_x < std::numeric_limits<double>::max() && !_points.empty())
@@ -67,7 +67,7 @@ using ToolboxPluginPtr = std::shared_ptr<ToolboxPlugin>;
 }  // namespace PJ
 
 QT_BEGIN_NAMESPACE
-#define Toolbox_iid "facontidavide.PlotJuggler3.Toolbox"
+#define Toolbox_iid "facontidavide.PlotJuggler3.Toolbox/2"
 Q_DECLARE_INTERFACE(PJ::ToolboxPlugin, Toolbox_iid)
 QT_END_NAMESPACE
 
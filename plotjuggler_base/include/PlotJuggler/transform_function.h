@@ -8,6 +8,8 @@
 #define PJ_TRANSFORM_FUNCTION_H
 
 #include <QApplication>
+#include <any>
+#include <deque>
 #include <set>
 #include <functional>
 #include "PlotJuggler/plotdata.h"
@@ -61,6 +63,13 @@ public:
 
   std::vector<const PlotData*>& dataSources();
 
+  std::vector<PlotData*>& dataDestinations();
+
+  /** Series read by calculate(). It is used to evaluate a transform after the
+   * ones that produce its inputs. By default, it is the same as dataSources().
+   */
+  virtual std::vector<const PlotData*> dependencies();
+
   virtual void setData(PlotDataMapRef* data, const std::vector<const PlotData*>& src_vect,
                        std::vector<PlotData*>& dst_vect);
 
@@ -71,6 +80,43 @@ public:
     return _order;
   }
 
+  /** Lazy evaluation: limit calculate() to the points of the (main) source with
+   * time in [range.min, range.max]. The points older than range.min are skipped,
+   * the ones newer than range.max are processed by a later call of calculate(),
+   * after the range is extended or cleared.
+   *
+   * It is used only if supportsEvaluationRange() returns true; the other
+   * transforms always process the entire source.
+   */
+  virtual bool supportsEvaluationRange() const
+  {
+    return false;
+  }
+
+  void setEvaluationRange(Range range)
+  {
+    _evaluation_range = range;
+  }
+
+  void clearEvaluationRange()
+  {
+    _evaluation_range.reset();
+  }
+
+  const std::optional<Range>& evaluationRange() const
+  {
+    return _evaluation_range;
+  }
+
+  /** Return true if calculate() can run on a worker thread, concurrently with
+   * other transforms: it must not use widgets or any state shared with other
+   * instances. The transforms that return false are calculated on the GUI thread.
+   */
+  virtual bool isThreadSafe() const
+  {
+    return false;
+  }
+
 signals:
   void parametersChanged();
 
@@ -80,6 +126,8 @@ protected:
   PlotDataMapRef* _data;
 
   unsigned _order;
+
+  std::optional<Range> _evaluation_range;
 };
 
 using TransformsMap = std::unordered_map<std::string, std::shared_ptr<TransformFunction>>;
@@ -105,14 +153,85 @@ public:
 
   void calculate() override;
 
+  bool supportsEvaluationRange() const override
+  {
+    return true;
+  }
+
   /// Method to be implemented by the user to apply a statefull function to each point.
   /// Index will increase monotonically, unless reset() is used.
   virtual std::optional<PlotData::Point> calculateNextPoint(size_t index) = 0;
 
+  /// Batch version of calculateNextPoint(), used by calculate(): process the
+  /// points of dataSource() in the range [first, last) and append the results to out.
+  /// The default implementation calls calculateNextPoint() for each point;
+  /// override it to avoid a virtual call and a std::optional per point.
+  virtual void calculateBatch(size_t first, size_t last, std::vector<PlotData::Point>& out);
+
   const PlotData* dataSource() const;
 
+  /** Checkpoints: calculate() stores a snapshot of the state of the transform
+   * every few thousands points of the source. When the source changes before the
+   * last processed point (out of order insertion or reload), the calculation
+   * restarts from the newest checkpoint older than the change, instead of the
+   * first point.
+   *
+   * A transform supports them by overriding saveState() and restoreState(), or
+   * isStateless(); by default, it is reset() and the whole source is processed again.
+   */
+  virtual std::any saveState() const
+  {
+    return isStateless() ? std::any(true) : std::any();
+  }
+
+  /// Restore a value returned by saveState(). Return false if it is not possible.
+  /// It is called after the checkpoint position is restored: the state may omit the
+  /// samples that can be read again from the source, see lastProcessedIndex().
+  virtual bool restoreState(const std::any& /*state*/)
+  {
+    return isStateless();
+  }
+
+  /// Return true if each output point depends only on the source, not on the
+  /// points processed before: any checkpoint can be restored.
+  virtual bool isStateless() const
+  {
+    return false;
+  }
+
+  /// Discard the output of the source points with time >= source_time and restore
+  /// the nearest checkpoint before it (or reset(), if there is none).
+  void rewind(double source_time);
+
 protected:
+  // time of the last processed point of the source and number of processed
+  // points with that time, since the timestamps may be repeated.
   double _last_timestamp = std::numeric_limits<double>::lowest();
+  size_t _last_timestamp_count = 0;
+
+  /// Index in dataSource() of the last processed point, if it is still there.
+  std::optional<size_t> lastProcessedIndex() const;
+
+private:
+  struct Checkpoint
+  {
+    double source_time;
+    size_t source_count;
+    // last point of the destination, when the checkpoint was created
+    double dst_time;
+    size_t dst_count;
+    std::any state;
+  };
+
+  static constexpr size_t CHECKPOINT_INTERVAL = 4096;
+  static constexpr size_t MAX_CHECKPOINTS = 32;
+
+  std::deque<Checkpoint> _checkpoints;
+  size_t _checkpoint_interval = CHECKPOINT_INTERVAL;
+  size_t _since_checkpoint = 0;
+  uint64_t _source_revision = 0;
+
+  void addCheckpoint();
 };
 
 ///------ The factory to create instances of a SeriesTransform -------------
@@ -164,6 +283,11 @@ public:
     };
   }
 
+  /// Register a transform that is known only at runtime, for instance
+  /// the one provided by a WASM plugin.
+  static void registerTransform(const std::string& name,
+                                std::function<TransformFunction::Ptr()> creator);
+
   static TransformFunction::Ptr create(const std::string& name);
 };
 
@@ -175,10 +299,10 @@ Q_GLOBAL_STATIC(PJ::TransformFactory, _transform_factory_ptr_from_macro)
 
 QT_BEGIN_NAMESPACE
 
-#define TransformFunction_iid "facontidavide.PlotJuggler3.TransformFunction"
+#define TransformFunction_iid "facontidavide.PlotJuggler3.TransformFunction/2"
 Q_DECLARE_INTERFACE(PJ::TransformFunction, TransformFunction_iid)
 
-#define TransformFunctionSISO_iid "facontidavide.PlotJuggler3.TransformFunctionSISO"
+#define TransformFunctionSISO_iid "facontidavide.PlotJuggler3.TransformFunctionSISO/2"
 Q_DECLARE_INTERFACE(PJ::TransformFunction_SISO, TransformFunctionSISO_iid)
 
 QT_END_NAMESPACE
@@ -0,0 +1,77 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "PlotJuggler/lua_engine.h"
+#include <atomic>
+
+extern "C" {
+#include <lua.h>
+#ifdef PJ_USE_LUAJIT
+#include <luajit.h>
+#endif
+}
+
+namespace PJ
+{
+namespace LuaEngine
+{
+static std::atomic_bool _jit_enabled{ true };
+
+const char* name()
+{
+#ifdef PJ_USE_LUAJIT
+  return LUAJIT_VERSION;
+#else
+  return LUA_RELEASE;
+#endif
+}
+
+bool isLuaJIT()
+{
+#ifdef PJ_USE_LUAJIT
+  return true;
+#else
+  return false;
+#endif
+}
+
+void setJitEnabled(bool enabled)
+{
+  _jit_enabled = enabled;
+}
+
+bool isJitEnabled()
+{
+  return isLuaJIT() && _jit_enabled;
+}
+
+void configure(lua_State* state)
+{
+#ifdef PJ_USE_LUAJIT
+  const int mode = _jit_enabled ? LUAJIT_MODE_ON : LUAJIT_MODE_OFF;
+  luaJIT_setmode(state, 0, LUAJIT_MODE_ENGINE | mode);
+#else
+  // math.atan2 was removed in Lua 5.3 (math.atan accepts two arguments), but the
+  // snippets written for LuaJIT use it: keep them portable.
+  lua_getglobal(state, "math");
+  if (lua_istable(state, -1))
+  {
+    lua_getfield(state, -1, "atan2");
+    const bool missing = lua_isnil(state, -1);
+    lua_pop(state, 1);
+    if (missing)
+    {
+      lua_getfield(state, -1, "atan");
+      lua_setfield(state, -2, "atan2");
+    }
+  }
+  lua_pop(state, 1);
+#endif
+}
+
+}  // namespace LuaEngine
+
+}  // namespace PJ
@@ -0,0 +1,82 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "PlotJuggler/performance_monitor.h"
+#include <algorithm>
+
+namespace PJ
+{
+PerformanceMonitor& PerformanceMonitor::instance()
+{
+  static PerformanceMonitor monitor;
+  return monitor;
+}
+
+void PerformanceMonitor::setEnabled(bool enabled)
+{
+  _enabled = enabled;
+}
+
+void PerformanceMonitor::addSample(const std::string& category, const std::string& label,
+                                   double value)
+{
+  if (!isEnabled())
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto& window = _windows[{ category, label }];
+  if (window.samples.size() < WINDOW_SIZE)
+  {
+    window.samples.push_back(value);
+  }
+  else
+  {
+    window.samples[window.next] = value;
+  }
+  window.next = (window.next + 1) % WINDOW_SIZE;
+  window.count++;
+  window.last = value;
+}
+
+std::map<PerformanceMonitor::Key, PerformanceMonitor::Statistics>
+PerformanceMonitor::statistics() const
+{
+  std::map<Key, Statistics> out;
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  std::vector<double> sorted;
+  for (const auto& [key, window] : _windows)
+  {
+    sorted = window.samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto percentile = [&sorted](double p) {
+      size_t index = static_cast<size_t>(p * double(sorted.size() - 1) + 0.5);
+      return sorted[index];
+    };
+
+    Statistics stats;
+    stats.last = window.last;
+    stats.count = window.count;
+    if (!sorted.empty())
+    {
+      stats.p50 = percentile(0.50);
+      stats.p99 = percentile(0.99);
+      stats.max = sorted.back();
+    }
+    out[key] = stats;
+  }
+  return out;
+}
+
+void PerformanceMonitor::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _windows.clear();
+}
+
+}  // namespace PJ
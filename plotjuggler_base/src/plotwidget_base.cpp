@@ -5,6 +5,7 @@
  */
 
 #include "PlotJuggler/plotwidget_base.h"
+#include "PlotJuggler/performance_monitor.h"
 #include "timeseries_qwt.h"
 
 #include "plotmagnifier.h"
@@ -37,11 +38,229 @@
 #include <QDragEnterEvent>
 #include <QDropEvent>
 #include <QHBoxLayout>
+#include <QPainter>
+#include <QPixmap>
+#include <QImage>
+#include <QApplication>
+#include <QtConcurrent>
+#include <cmath>
 
 #include "plotpanner.h"
 
 static int _global_color_index_ = 0;
 
+struct CurveKey
+{
+  const QwtPlotCurve* curve;
+  const void* data;
+  QRgb color;
+  qreal width;
+  int style;
+  bool inverted;
+
+  bool operator==(const CurveKey& other) const
+  {
+    return curve == other.curve && data == other.data && color == other.color &&
+           width == other.width && style == other.style && inverted == other.inverted;
+  }
+};
+
+// Samples of a curve when the scroll-blit layer was painted
+struct CurveExtent
+{
+  size_t size = 0;
+  double last_x = 0;
+  // revision of the PlotData, if the curve is a timeseries
+  uint64_t revision = 0;
+};
+
+// Raster of the curves painted in the previous frame. During streaming the
+// view only slides to the right: the raster is scrolled and only the newly
+// exposed strip is painted.
+struct ScrollBlitLayer
+{
+  QPixmap pixmap;
+  // scale value of the x axis mapped to the left border of the pixmap
+  double x_origin = 0;
+  QwtScaleMap x_map;
+  QwtScaleMap y_map;
+  std::vector<CurveKey> curves;
+  // same order as curves
+  std::vector<CurveExtent> extents;
+  bool valid = false;
+};
+
+// Immutable copy of the visible samples of a curve, that can be
+// rasterized by a worker thread.
+struct CurveSnapshot
+{
+  QPen pen;
+  QwtPlotCurve::CurveStyle style;
+  bool inverted;
+  bool antialiased;
+  QVector<QPointF> points;
+};
+
+// Curves of a plot rasterized off-screen, ready to be blitted on the canvas
+// if the scale maps didn't change in the meantime.
+struct PrerenderedCurves
+{
+  QImage image;
+  QwtScaleMap x_map;
+  QwtScaleMap y_map;
+  std::vector<CurveKey> curves;
+};
+
+struct RenderJob
+{
+  QSize size;
+  qreal dpr = 1.0;
+  QRectF canvas_rect;
+  QwtScaleMap x_map;
+  QwtScaleMap y_map;
+  std::vector<CurveKey> keys;
+  std::vector<CurveSnapshot> curves;
+  std::optional<PrerenderedCurves> result;
+};
+
+static bool _parallel_rendering_ = false;
+static int _replot_batch_depth_ = 0;
+static std::vector<PJ::PlotWidgetBase*> _pending_replots_;
+
+static bool SameScaleMap(const QwtScaleMap& a, const QwtScaleMap& b)
+{
+  return a.s1() == b.s1() && a.s2() == b.s2() && a.p1() == b.p1() && a.p2() == b.p2();
+}
+
+// first index with x >= value. Samples of a timeseries are sorted by x
+static int LowerBoundX(const QwtSeriesData<QPointF>* series, double value)
+{
+  int first = 0;
+  int count = static_cast<int>(series->size());
+  while (count > 0)
+  {
+    int step = count / 2;
+    int it = first + step;
+    if (series->sample(it).x() < value)
+    {
+      first = it + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first;
+}
+
+// Executed by the worker threads: it must not touch anything but the job.
+static void RasterizeCurves(RenderJob& job)
+{
+  PrerenderedCurves result;
+  result.image = QImage(job.size * job.dpr, QImage::Format_ARGB32_Premultiplied);
+  result.image.setDevicePixelRatio(job.dpr);
+  result.image.fill(Qt::transparent);
+
+  QPainter painter(&result.image);
+  for (auto& snapshot : job.curves)
+  {
+    QwtPlotCurve curve;
+    curve.setPen(snapshot.pen);
+    curve.setStyle(snapshot.style);
+    curve.setCurveAttribute(QwtPlotCurve::Inverted, snapshot.inverted);
+    curve.setPaintAttribute(QwtPlotCurve::ClipPolygons, true);
+    curve.setPaintAttribute(QwtPlotCurve::FilterPointsAggressive, true);
+    curve.setSamples(std::move(snapshot.points));
+
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing, snapshot.antialiased);
+    curve.draw(&painter, job.x_map, job.y_map, job.canvas_rect);
+    painter.restore();
+  }
+  painter.end();
+
+  result.x_map = job.x_map;
+  result.y_map = job.y_map;
+  result.curves = std::move(job.keys);
+  job.result = std::move(result);
+}
+
+// Density (heatmap) rendering: the samples are binned into cells of
+// DENSITY_BIN_SIZE pixels and each cell is painted with the color of the
+// curve, with an opacity proportional to log(count).
+// Cost is O(N) without any per-point painting, useful with millions of points.
+static constexpr int DENSITY_BIN_SIZE = 2;
+
+static void DrawDensity(QPainter* painter, const QwtScaleMap& x_map, const QwtScaleMap& y_map,
+                        const QRectF& canvas_rect, const QwtPlotCurve* curve)
+{
+  const QRect rect = canvas_rect.toAlignedRect();
+  const int cols = (rect.width() + DENSITY_BIN_SIZE - 1) / DENSITY_BIN_SIZE;
+  const int rows = (rect.height() + DENSITY_BIN_SIZE - 1) / DENSITY_BIN_SIZE;
+  if (cols <= 0 || rows <= 0)
+  {
+    return;
+  }
+
+  std::vector<uint32_t> bins(size_t(cols) * size_t(rows), 0);
+  uint32_t max_count = 0;
+
+  const auto* series = curve->data();
+  const size_t size = series->size();
+  for (size_t i = 0; i < size; i++)
+  {
+    const QPointF p = series->sample(i);
+    const double px = x_map.transform(p.x()) - rect.left();
+    const double py = y_map.transform(p.y()) - rect.top();
+    if (!(px >= 0 && py >= 0 && px < rect.width() && py < rect.height()))
+    {
+      continue;  // also skips NaN
+    }
+    auto& bin = bins[size_t(py / DENSITY_BIN_SIZE) * size_t(cols) + size_t(px / DENSITY_BIN_SIZE)];
+    max_count = std::max(max_count, ++bin);
+  }
+  if (max_count == 0)
+  {
+    return;
+  }
+
+  const QColor color = curve->pen().color();
+  const double log_max = std::log1p(double(max_count));
+
+  // a small lookup table, because many cells share the same count
+  std::vector<QRgb> lut(std::min<uint32_t>(max_count, 4096) + 1, qRgba(0, 0, 0, 0));
+  auto colorOf = [&](uint32_t count) -> QRgb {
+    // at least 25% opacity, to make isolated samples visible
+    const double ratio = 0.25 + 0.75 * std::log1p(double(count)) / log_max;
+    const int alpha = std::clamp(int(ratio * 255.0), 0, 255);
+    return qPremultiply(qRgba(color.red(), color.green(), color.blue(), alpha));
+  };
+  for (uint32_t c = 1; c < lut.size(); c++)
+  {
+    lut[c] = colorOf(c);
+  }
+
+  QImage image(cols, rows, QImage::Format_ARGB32_Premultiplied);
+  for (int r = 0; r < rows; r++)
+  {
+    auto line = reinterpret_cast<QRgb*>(image.scanLine(r));
+    const uint32_t* bin_row = &bins[size_t(r) * size_t(cols)];
+    for (int c = 0; c < cols; c++)
+    {
+      const uint32_t count = bin_row[c];
+      line[c] = (count < lut.size()) ? lut[count] : colorOf(count);
+    }
+  }
+
+  painter->save();
+  painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+  painter->drawImage(QRectF(rect.left(), rect.top(), cols * DENSITY_BIN_SIZE,
+                            rows * DENSITY_BIN_SIZE),
+                     image);
+  painter->restore();
+}
+
 class PlotWidgetBase::QwtPlotPimpl : public QwtPlot
 {
 public:
@@ -140,6 +359,382 @@ public:
 
   bool zoom_enabled = true;
 
+  bool scroll_blit_enabled = false;
+
+  mutable ScrollBlitLayer scroll_blit;
+
+  mutable std::optional<PrerenderedCurves> prerendered;
+
+  void drawItems(QPainter* painter, const QRectF& canvasRect,
+                 const QwtScaleMap maps[QwtAxis::AxisPositions]) const override
+  {
+    auto& monitor = PerformanceMonitor::instance();
+    PerformanceMonitor::ScopedTimer timer("Render",
+                                        [this]() { return parent->objectName().toStdString(); });
+    if (monitor.isEnabled())
+    {
+      monitor.addSample("Points drawn", parent->objectName().toStdString(),
+                        visiblePoints(maps[QwtPlot::xBottom]));
+    }
+
+    if (curve_style == DENSITY)
+    {
+      scroll_blit.valid = false;
+      prerendered.reset();
+      drawItemsDensity(painter, canvasRect, maps);
+      return;
+    }
+
+    const bool use_layer = (scroll_blit_enabled && !parent->isXYPlot()) || prerendered;
+    if (!use_layer || !isPaintingCanvas(painter))
+    {
+      scroll_blit.valid = false;
+      prerendered.reset();
+      QwtPlot::drawItems(painter, canvasRect, maps);
+      return;
+    }
+
+    bool layer_drawn = false;
+    for (QwtPlotItem* item : itemList())
+    {
+      if (!item || !item->isVisible())
+      {
+        continue;
+      }
+      if (item->rtti() == QwtPlotItem::Rtti_PlotCurve)
+      {
+        // all the curves are rendered at once, at the position of the first one
+        if (!layer_drawn)
+        {
+          drawCurvesLayer(painter, canvasRect, maps[QwtPlot::xBottom], maps[QwtPlot::yLeft]);
+          layer_drawn = true;
+        }
+        continue;
+      }
+      painter->save();
+      painter->setRenderHint(QPainter::Antialiasing,
+                             item->testRenderHint(QwtPlotItem::RenderAntialiased));
+      item->draw(painter, maps[item->xAxis()], maps[item->yAxis()], canvasRect);
+      painter->restore();
+    }
+    prerendered.reset();
+  }
+
+  void drawItemsDensity(QPainter* painter, const QRectF& canvasRect,
+                        const QwtScaleMap maps[QwtAxis::AxisPositions]) const
+  {
+    for (QwtPlotItem* item : itemList())
+    {
+      if (!item || !item->isVisible())
+      {
+        continue;
+      }
+      if (item->rtti() == QwtPlotItem::Rtti_PlotCurve)
+      {
+        DrawDensity(painter, maps[item->xAxis()], maps[item->yAxis()], canvasRect,
+                    static_cast<const QwtPlotCurve*>(item));
+        continue;
+      }
+      painter->save();
+      painter->setRenderHint(QPainter::Antialiasing,
+                             item->testRenderHint(QwtPlotItem::RenderAntialiased));
+      item->draw(painter, maps[item->xAxis()], maps[item->yAxis()], canvasRect);
+      painter->restore();
+    }
+  }
+
+  // the layer must not be used when rendering to images, printers or SVG
+  bool isPaintingCanvas(const QPainter* painter) const
+  {
+    const QPaintDevice* device = painter->device();
+    if (device == canvas())
+    {
+      return true;
+    }
+    if (auto plot_canvas = qobject_cast<const QwtPlotCanvas*>(canvas()))
+    {
+      return device == plot_canvas->backingStore();
+    }
+    return false;
+  }
+
+  std::vector<const QwtPlotCurve*> visibleCurves() const
+  {
+    std::vector<const QwtPlotCurve*> curves;
+    for (const QwtPlotItem* item : itemList(QwtPlotItem::Rtti_PlotCurve))
+    {
+      if (item->isVisible())
+      {
+        curves.push_back(static_cast<const QwtPlotCurve*>(item));
+      }
+    }
+    return curves;
+  }
+
+  // number of samples inside the visible range of the X axis
+  size_t visiblePoints(const QwtScaleMap& x_map) const
+  {
+    const double x_min = std::min(x_map.s1(), x_map.s2());
+    const double x_max = std::max(x_map.s1(), x_map.s2());
+    size_t count = 0;
+    for (const auto* curve : visibleCurves())
+    {
+      const auto* series = curve->data();
+      if (parent->isXYPlot())
+      {
+        count += series->size();
+      }
+      else
+      {
+        count += LowerBoundX(series, x_max) - LowerBoundX(series, x_min);
+      }
+    }
+    return count;
+  }
+
+  static std::vector<CurveKey> curveKeys(const std::vector<const QwtPlotCurve*>& curves)
+  {
+    std::vector<CurveKey> keys;
+    keys.reserve(curves.size());
+    for (const auto* curve : curves)
+    {
+      keys.push_back({ curve, curve->data(), curve->pen().color().rgba(), curve->pen().widthF(),
+                       int(curve->style()), curve->testCurveAttribute(QwtPlotCurve::Inverted) });
+    }
+    return keys;
+  }
+
+  static CurveExtent curveExtent(const QwtPlotCurve* curve)
+  {
+    CurveExtent extent;
+    const auto* series = curve->data();
+    extent.size = series->size();
+    if (extent.size > 0)
+    {
+      extent.last_x = series->sample(extent.size - 1).x();
+    }
+    auto timeseries = dynamic_cast<const QwtTimeseries*>(series);
+    if (timeseries && timeseries->timeseriesData())
+    {
+      extent.revision = timeseries->timeseriesData()->revision();
+    }
+    return extent;
+  }
+
+  // True if, since the layer was painted, the curve only received samples newer
+  // than its previous last one (and possibly lost the oldest ones). Anything else,
+  // like late samples inserted in the middle, changes pixels that were already
+  // painted in the layer.
+  static bool appendedOnly(const QwtPlotCurve* curve, const CurveExtent& previous)
+  {
+    const auto current = curveExtent(curve);
+    if (current.revision != previous.revision)
+    {
+      return false;
+    }
+    if (previous.size == 0)
+    {
+      return current.size == 0;
+    }
+    const double after_last = std::nextafter(previous.last_x, std::numeric_limits<double>::max());
+    const size_t not_newer = LowerBoundX(curve->data(), after_last);
+    return not_newer <= previous.size;
+  }
+
+  QSize layerSize() const
+  {
+    return canvas()->size() * canvas()->devicePixelRatioF();
+  }
+
+  // Number of pixels the scroll-blit layer must be shifted to match the new
+  // scale maps, or nullopt if it must be repainted from scratch.
+  std::optional<int> scrollShift(const QwtScaleMap& x_map, const QwtScaleMap& y_map,
+                                 const std::vector<CurveKey>& keys) const
+  {
+    const auto& layer = scroll_blit;
+    const double x_span = x_map.s2() - x_map.s1();
+    const double px_per_unit = (x_map.p2() - x_map.p1()) / x_span;
+
+    if (!scroll_blit_enabled || parent->isXYPlot() || !layer.valid ||
+        !std::isfinite(px_per_unit) || layer.pixmap.size() != layerSize() ||
+        layer.curves != keys || !SameScaleMap(layer.y_map, y_map) ||
+        layer.x_map.p1() != x_map.p1() || layer.x_map.p2() != x_map.p2() ||
+        !qFuzzyCompare(layer.x_map.s2() - layer.x_map.s1(), x_span))
+    {
+      return std::nullopt;
+    }
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+      if (!appendedOnly(keys[i].curve, layer.extents[i]))
+      {
+        return std::nullopt;
+      }
+    }
+    // only scrolling forward by less than half the canvas is worth it
+    const int shift_px = qRound((x_map.s1() - layer.x_origin) * px_per_unit);
+    if (shift_px < 0 || shift_px >= canvas()->width() / 2)
+    {
+      return std::nullopt;
+    }
+    return shift_px;
+  }
+
+  bool usePrerendered(const QwtScaleMap& x_map, const QwtScaleMap& y_map,
+                      const std::vector<CurveKey>& keys) const
+  {
+    return prerendered && prerendered->image.size() == layerSize() &&
+           prerendered->curves == keys && SameScaleMap(prerendered->x_map, x_map) &&
+           SameScaleMap(prerendered->y_map, y_map);
+  }
+
+  // Called on the GUI thread, right before the replot. Copy the visible samples,
+  // unless the scroll-blit layer is going to be used anyway.
+  RenderJob snapshotCurves()
+  {
+    updateAxes();
+    QApplication::sendPostedEvents(this, QEvent::LayoutRequest);
+
+    RenderJob job;
+    job.size = canvas()->size();
+    job.dpr = canvas()->devicePixelRatioF();
+    job.canvas_rect = canvas()->contentsRect();
+    job.x_map = canvasMap(QwtPlot::xBottom);
+    job.y_map = canvasMap(QwtPlot::yLeft);
+
+    const auto curves = visibleCurves();
+    job.keys = curveKeys(curves);
+
+    // density plots are rasterized in drawItems; nothing to prerender
+    if (curves.empty() || curve_style == DENSITY ||
+        scrollShift(job.x_map, job.y_map, job.keys))
+    {
+      return job;
+    }
+
+    const double x_min = std::min(job.x_map.s1(), job.x_map.s2());
+    const double x_max = std::max(job.x_map.s1(), job.x_map.s2());
+
+    for (const auto* curve : curves)
+    {
+      const auto* series = curve->data();
+      int from = 0;
+      int to = static_cast<int>(series->size());
+      // samples of the XY curves are not sorted: copy all of them
+      if (!parent->isXYPlot())
+      {
+        from = std::max(0, LowerBoundX(series, x_min) - 1);
+        to = std::min(to, LowerBoundX(series, x_max) + 1);
+      }
+      CurveSnapshot snapshot;
+      snapshot.pen = curve->pen();
+      snapshot.style = curve->style();
+      snapshot.inverted = curve->testCurveAttribute(QwtPlotCurve::Inverted);
+      snapshot.antialiased = curve->testRenderHint(QwtPlotItem::RenderAntialiased);
+      snapshot.points.reserve(std::max(0, to - from));
+      for (int i = from; i < to; i++)
+      {
+        snapshot.points.push_back(series->sample(i));
+      }
+      job.curves.push_back(std::move(snapshot));
+    }
+    return job;
+  }
+
+  void drawCurvesLayer(QPainter* painter, const QRectF& canvasRect, const QwtScaleMap& x_map,
+                       const QwtScaleMap& y_map) const
+  {
+    auto& layer = scroll_blit;
+    const auto curves = visibleCurves();
+    auto keys = curveKeys(curves);
+
+    const double x_span = x_map.s2() - x_map.s1();
+    const double px_per_unit = (x_map.p2() - x_map.p1()) / x_span;
+    const auto shift_px = scrollShift(x_map, y_map, keys);
+
+    if (!shift_px && usePrerendered(x_map, y_map, keys))
+    {
+      layer.pixmap = QPixmap::fromImage(std::move(prerendered->image));
+      layer.x_origin = x_map.s1();
+    }
+    else if (!shift_px)
+    {
+      layer.pixmap = QPixmap(layerSize());
+      layer.pixmap.setDevicePixelRatio(canvas()->devicePixelRatioF());
+      layer.pixmap.fill(Qt::transparent);
+      layer.x_origin = x_map.s1();
+
+      QPainter layer_painter(&layer.pixmap);
+      for (const auto* curve : curves)
+      {
+        layer_painter.save();
+        layer_painter.setRenderHint(QPainter::Antialiasing,
+                                    curve->testRenderHint(QwtPlotItem::RenderAntialiased));
+        curve->draw(&layer_painter, x_map, y_map, canvasRect);
+        layer_painter.restore();
+      }
+    }
+    else
+    {
+      if (*shift_px > 0)
+      {
+        layer.pixmap.scroll(-qRound(*shift_px * layer.pixmap.devicePixelRatio()), 0,
+                            layer.pixmap.rect());
+        layer.x_origin += *shift_px / px_per_unit;
+      }
+      QwtScaleMap layer_x_map = x_map;
+      layer_x_map.setScaleInterval(layer.x_origin, layer.x_origin + x_span);
+
+      // repaint the exposed area plus a few pixels, to join the new segments
+      // with the old ones and to include the samples received without scrolling.
+      // The strip starts at the last sample previously painted, at the latest.
+      double strip_left = canvasRect.right() - *shift_px - 3;
+      for (const auto& extent : layer.extents)
+      {
+        if (extent.size > 0)
+        {
+          strip_left = std::min(strip_left, layer_x_map.transform(extent.last_x) - 3);
+        }
+      }
+      strip_left = std::max(strip_left, canvasRect.left());
+      const QRectF strip(strip_left, 0, canvas()->width() - strip_left, canvas()->height());
+      const double strip_min_x = layer_x_map.invTransform(strip_left);
+
+      QPainter layer_painter(&layer.pixmap);
+      layer_painter.setCompositionMode(QPainter::CompositionMode_Source);
+      layer_painter.fillRect(strip, Qt::transparent);
+      layer_painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+      layer_painter.setClipRect(strip);
+
+      for (const auto* curve : curves)
+      {
+        const int size = static_cast<int>(curve->dataSize());
+        if (size == 0)
+        {
+          continue;
+        }
+        const int from = std::max(0, LowerBoundX(curve->data(), strip_min_x) - 1);
+        layer_painter.save();
+        layer_painter.setRenderHint(QPainter::Antialiasing,
+                                    curve->testRenderHint(QwtPlotItem::RenderAntialiased));
+        curve->drawSeries(&layer_painter, layer_x_map, y_map, canvasRect, from, size - 1);
+        layer_painter.restore();
+      }
+    }
+
+    layer.x_map = x_map;
+    layer.y_map = y_map;
+    layer.curves = std::move(keys);
+    layer.extents.clear();
+    for (const auto* curve : curves)
+    {
+      layer.extents.push_back(curveExtent(curve));
+    }
+    layer.valid = true;
+
+    const double offset = shift_px ? (layer.x_origin - x_map.s1()) * px_per_unit : 0.0;
+    painter->drawPixmap(QPointF(offset, 0), layer.pixmap);
+  }
+
   void dragEnterEvent(QDragEnterEvent* event) override
   {
     event_callback(event);
@@ -374,6 +969,8 @@ PlotWidgetBase::PlotWidgetBase(QWidget* parent) : _xy_mode(false), _keep_aspect_
 
 PlotWidgetBase::~PlotWidgetBase()
 {
+  _pending_replots_.erase(std::remove(_pending_replots_.begin(), _pending_replots_.end(), this),
+                          _pending_replots_.end());
   if (p)
   {
     delete p;
@@ -709,6 +1306,10 @@ void PlotWidgetBase::setStyle(QwtPlotCurve* curve, CurveStyle style)
       curve->setStyle(QwtPlotCurve::Steps);
       curve->setCurveAttribute(QwtPlotCurve::Inverted, true);
       break;
+    case DENSITY:
+      // the curve is rasterized by the plot; Dots is used by the legend
+      curve->setStyle(QwtPlotCurve::Dots);
+      break;
   }
 }
 
@@ -771,9 +1372,91 @@ void PlotWidgetBase::replot()
   {
     p->zoomer->setZoomBase(false);
   }
+  if (_parallel_rendering_ && _replot_batch_depth_ > 0)
+  {
+    if (std::find(_pending_replots_.begin(), _pending_replots_.end(), this) ==
+        _pending_replots_.end())
+    {
+      _pending_replots_.push_back(this);
+    }
+    return;
+  }
   qwtPlot()->replot();
 }
 
+void PlotWidgetBase::setParallelRendering(bool enable)
+{
+  _parallel_rendering_ = enable;
+}
+
+bool PlotWidgetBase::parallelRendering()
+{
+  return _parallel_rendering_;
+}
+
+PlotWidgetBase::ReplotBatch::ReplotBatch()
+{
+  _replot_batch_depth_++;
+}
+
+PlotWidgetBase::ReplotBatch::~ReplotBatch()
+{
+  if (--_replot_batch_depth_ == 0)
+  {
+    PlotWidgetBase::flushPendingReplots();
+  }
+}
+
+void PlotWidgetBase::flushPendingReplots()
+{
+  std::vector<PlotWidgetBase*> plots;
+  std::swap(plots, _pending_replots_);
+
+  std::vector<RenderJob> jobs;
+  jobs.reserve(plots.size());
+  for (auto plot : plots)
+  {
+    jobs.push_back(plot->p->snapshotCurves());
+  }
+
+  PerformanceMonitor::ScopedTimer timer("Render", "parallel rasterization");
+  QtConcurrent::blockingMap(jobs, [](RenderJob& job) {
+    if (!job.curves.empty())
+    {
+      RasterizeCurves(job);
+    }
+  });
+
+  for (size_t i = 0; i < plots.size(); i++)
+  {
+    plots[i]->p->prerendered = std::move(jobs[i].result);
+    plots[i]->qwtPlot()->replot();
+  }
+}
+
+void PlotWidgetBase::setScrollBlitEnabled(bool enabled)
+{
+  if (p->scroll_blit_enabled != enabled)
+  {
+    p->scroll_blit_enabled = enabled;
+    invalidateScrollBlit();
+  }
+}
+
+bool PlotWidgetBase::isScrollBlitEnabled() const
+{
+  return p->scroll_blit_enabled;
+}
+
+void PlotWidgetBase::invalidateScrollBlit()
+{
+  p->scroll_blit.valid = false;
+  if (!p->scroll_blit_enabled)
+  {
+    p->scroll_blit.pixmap = QPixmap();
+  }
+}
+
 void PlotWidgetBase::removeAllCurves()
 {
   for (auto& it : curveList())
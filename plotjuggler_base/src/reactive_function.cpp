@@ -5,9 +5,11 @@
  */
 
 #include "PlotJuggler/reactive_function.h"
+#include "PlotJuggler/lua_engine.h"
 #include <sol/sol.hpp>
 #include "fmt/format.h"
 #include <QMessageBox>
+#include <chrono>
 
 namespace PJ
 {
@@ -20,6 +22,7 @@ void ReactiveLuaFunction::init()
   _lua_engine.open_libraries(sol::lib::string);
   _lua_engine.open_libraries(sol::lib::math);
   _lua_engine.open_libraries(sol::lib::table);
+  LuaEngine::configure(_lua_engine.lua_state());
 
   _lua_engine.script(_library_code);
 
@@ -47,13 +50,21 @@ void ReactiveLuaFunction::init()
     throw std::runtime_error(std::string("Error in Function part:\n") + err.what());
   }
   _lua_function = _lua_engine["calc"];
+
+  // apply the clear() of the series created by the global code
+  for (auto& output : _outputs)
+  {
+    output.finishWrite();
+  }
 }
 
 ReactiveLuaFunction::ReactiveLuaFunction(PlotDataMapRef* data_map, QString lua_global,
-                                         QString lua_function, QString lua_library)
+                                         QString lua_function, QString lua_library,
+                                         bool incremental_outputs)
   : _global_code(lua_global.toStdString())
   , _function_code(lua_function.toStdString())
   , _library_code(lua_library.toStdString())
+  , _incremental_outputs(incremental_outputs)
 {
   _data = data_map;
   init();
@@ -61,6 +72,7 @@ ReactiveLuaFunction::ReactiveLuaFunction(PlotDataMapRef* data_map, QString lua_g
 
 void ReactiveLuaFunction::reset()
 {
+  _has_run = false;
 }
 
 void ReactiveLuaFunction::setTimeTracker(double time_tracker_value)
@@ -70,6 +82,12 @@ void ReactiveLuaFunction::setTimeTracker(double time_tracker_value)
 
 void ReactiveLuaFunction::calculate()
 {
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto& output : _outputs)
+  {
+    output.beginWrite();
+  }
   try
   {
     auto result = _lua_function(_tracker_value);
@@ -84,6 +102,76 @@ void ReactiveLuaFunction::calculate()
     QMessageBox::warning(nullptr, "Error in Reactive Script", QString(err.what()),
                          QMessageBox::Cancel);
   }
+  for (auto& output : _outputs)
+  {
+    output.finishWrite();
+  }
+
+  // the state of the inputs is taken after the execution, that may modify them
+  for (auto& [name, state] : _inputs)
+  {
+    state = inputState(name);
+  }
+  _series_count = plotData()->numeric.size();
+  _last_run_tracker = _tracker_value;
+  _has_run = true;
+
+  const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  _stats.runs++;
+  _stats.last_ms = elapsed_ms;
+  _stats.max_ms = std::max(_stats.max_ms, elapsed_ms);
+  _stats.total_ms += elapsed_ms;
+}
+
+bool ReactiveLuaFunction::needsUpdate() const
+{
+  if (!_has_run || _tracker_value != _last_run_tracker)
+  {
+    return true;
+  }
+  if (_reads_series_names && _data->numeric.size() != _series_count)
+  {
+    return true;
+  }
+  for (const auto& [name, state] : _inputs)
+  {
+    if (!(inputState(name) == state))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReactiveLuaFunction::calculateIfNeeded()
+{
+  if (!needsUpdate())
+  {
+    _stats.skipped++;
+    return false;
+  }
+  calculate();
+  return true;
+}
+
+ReactiveLuaFunction::InputState ReactiveLuaFunction::inputState(const std::string& name) const
+{
+  InputState state;
+  auto it = _data->numeric.find(name);
+  if (it != _data->numeric.end())
+  {
+    const PlotData& data = it->second;
+    state.exists = true;
+    state.revision = data.revision();
+    state.size = data.size();
+    if (data.size() > 0)
+    {
+      state.front = data.front().x;
+      state.back = data.back().x;
+    }
+  }
+  return state;
 }
 
 bool ReactiveLuaFunction::xmlSaveState(QDomDocument&, QDomElement&) const
@@ -102,6 +190,8 @@ void ReactiveLuaFunction::prepareLua()
 
   _timeseries_ref["find"] = [this](sol::object name) {
     auto str = name.as<std::string>();
+    // a dependency of the script, even if it doesn't exist yet
+    _inputs.insert({ str, inputState(str) });
     auto it = plotData()->numeric.find(str);
     if (it == plotData()->numeric.end())
     {
@@ -125,9 +215,9 @@ void ReactiveLuaFunction::prepareLua()
       return sol::make_object(_lua_engine, sol::lua_nil);
     }
     auto str_name = name.as<std::string>();
-    auto series = CreatedSeriesTime(plotData(), str_name);
+    auto series = CreatedSeriesTime(plotData(), str_name, _incremental_outputs);
+    addOutput(series, str_name);
     series.clear();
-    _created_curves.push_back(str_name);
     return sol::object(_lua_engine, sol::in_place, series);
   };
 
@@ -135,6 +225,7 @@ void ReactiveLuaFunction::prepareLua()
   _created_timeseries["size"] = &CreatedSeriesTime::size;
   _created_timeseries["clear"] = &CreatedSeriesTime::clear;
   _created_timeseries["push_back"] = &CreatedSeriesTime::push_back;
+  _created_timeseries["pop_back"] = &CreatedSeriesTime::pop_back;
 
   //---------------------------------------
   _created_scatter = _lua_engine.new_usertype<CreatedSeriesXY>("ScatterXY");
@@ -145,9 +236,9 @@ void ReactiveLuaFunction::prepareLua()
       return sol::make_object(_lua_engine, sol::lua_nil);
     }
     auto str_name = name.as<std::string>();
-    auto series = CreatedSeriesXY(plotData(), str_name);
+    auto series = CreatedSeriesXY(plotData(), str_name, _incremental_outputs);
+    addOutput(series, str_name);
     series.clear();
-    _created_curves.push_back(str_name);
     return sol::object(_lua_engine, sol::in_place, series);
   };
 
@@ -155,9 +246,11 @@ void ReactiveLuaFunction::prepareLua()
   _created_scatter["size"] = &CreatedSeriesXY::size;
   _created_scatter["clear"] = &CreatedSeriesXY::clear;
   _created_scatter["push_back"] = &CreatedSeriesXY::push_back;
+  _created_scatter["pop_back"] = &CreatedSeriesXY::pop_back;
 
   //---------------------------------------
   auto GetSeriesNames = [this]() {
+    _reads_series_names = true;
     std::vector<std::string> names;
     for (const auto& it : plotData()->numeric)
     {
@@ -180,8 +273,7 @@ std::pair<double, double> TimeseriesRef::at(unsigned i) const
 
 void TimeseriesRef::set(unsigned index, double x, double y)
 {
-  auto& p = _plot_data->at(index);
-  p = { x, y };
+  _plot_data->set(index, { x, y });
 }
 
 double TimeseriesRef::atTime(double t) const
@@ -200,8 +292,23 @@ void TimeseriesRef::clear() const
   _plot_data->clear();
 }
 
+void ReactiveLuaFunction::addOutput(CreatedSeriesBase& series, const std::string& name)
+{
+  // new() may be called by calc(), at each execution: the series is registered once
+  for (const auto& output : _outputs)
+  {
+    if (output._plot_data == series._plot_data)
+    {
+      series._write_index = output._write_index;
+      return;
+    }
+  }
+  _outputs.push_back(series);
+  _created_curves.push_back(name);
+}
+
 CreatedSeriesBase::CreatedSeriesBase(PlotDataMapRef* data_map, const std::string& name,
-                                     bool timeseries)
+                                     bool timeseries, bool incremental)
 {
   if (timeseries)
   {
@@ -211,6 +318,10 @@ CreatedSeriesBase::CreatedSeriesBase(PlotDataMapRef* data_map, const std::string
   {
     _plot_data = &(data_map->getOrCreateScatterXY(name));
   }
+  if (incremental)
+  {
+    _write_index = std::make_shared<size_t>(_plot_data->size());
+  }
 }
 
 std::pair<double, double> CreatedSeriesBase::at(unsigned i) const
@@ -221,26 +332,92 @@ std::pair<double, double> CreatedSeriesBase::at(unsigned i) const
 
 void CreatedSeriesBase::clear()
 {
+  if (_write_index)
+  {
+    *_write_index = 0;
+    return;
+  }
   _plot_data->clear();
 }
 
 void CreatedSeriesBase::push_back(double x, double y)
 {
+  if (_write_index)
+  {
+    size_t& index = *_write_index;
+    if (index < _plot_data->size())
+    {
+      const auto& p = _plot_data->at(index);
+      if (p.x == x && p.y == y)
+      {
+        index++;
+        return;
+      }
+      // first difference: the following points are written again
+      while (_plot_data->size() > index)
+      {
+        _plot_data->popBack();
+      }
+    }
+    index++;
+  }
   _plot_data->pushBack({ x, y });
 }
 
+void CreatedSeriesBase::pop_back()
+{
+  if (_write_index)
+  {
+    // removed by finishWrite(), unless push_back() writes it again
+    if (*_write_index > 0)
+    {
+      (*_write_index)--;
+    }
+    return;
+  }
+  if (_plot_data->size() > 0)
+  {
+    _plot_data->popBack();
+  }
+}
+
 unsigned CreatedSeriesBase::size() const
 {
+  if (_write_index)
+  {
+    return *_write_index;
+  }
   return _plot_data->size();
 }
 
-CreatedSeriesTime::CreatedSeriesTime(PlotDataMapRef* data_map, const std::string& name)
-  : CreatedSeriesBase(data_map, name, true)
+void CreatedSeriesBase::beginWrite()
+{
+  if (_write_index)
+  {
+    *_write_index = _plot_data->size();
+  }
+}
+
+void CreatedSeriesBase::finishWrite()
+{
+  if (_write_index)
+  {
+    while (_plot_data->size() > *_write_index)
+    {
+      _plot_data->popBack();
+    }
+  }
+}
+
+CreatedSeriesTime::CreatedSeriesTime(PlotDataMapRef* data_map, const std::string& name,
+                                     bool incremental)
+  : CreatedSeriesBase(data_map, name, true, incremental)
 {
 }
 
-CreatedSeriesXY::CreatedSeriesXY(PlotDataMapRef* data_map, const std::string& name)
-  : CreatedSeriesBase(data_map, name, false)
+CreatedSeriesXY::CreatedSeriesXY(PlotDataMapRef* data_map, const std::string& name,
+                                 bool incremental)
+  : CreatedSeriesBase(data_map, name, false, incremental)
 {
 }
 
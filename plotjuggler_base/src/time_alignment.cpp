@@ -0,0 +1,171 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "PlotJuggler/time_alignment.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace PJ
+{
+void AlignSeries(const PlotData& series, const double* times, size_t count,
+                 InterpolationMode mode, double* out)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  const size_t size = series.size();
+  if (size == 0)
+  {
+    std::fill(out, out + count, std::numeric_limits<double>::quiet_NaN());
+    return;
+  }
+
+  auto after = [](double t, const PlotData::Point& p) { return t < p.x; };
+
+  // merge pass: the samples before (x0 <= t) and after (x1 > t) each time.
+  // Before the first and after the last sample, both are that sample and x1 is
+  // moved forward, so that the interpolation doesn't need a special case.
+  std::vector<double> x0(count), y0(count), x1(count), y1(count);
+  size_t upper = std::distance(series.begin(),
+                               std::upper_bound(series.begin(), series.end(), times[0], after));
+  for (size_t i = 0; i < count; i++)
+  {
+    const double t = times[i];
+    if (i > 0 && t < times[i - 1])
+    {
+      // not sorted: start again with a binary search
+      upper = std::distance(series.begin(),
+                            std::upper_bound(series.begin(), series.end(), t, after));
+    }
+    while (upper < size && series[upper].x <= t)
+    {
+      upper++;
+    }
+    const bool inside = (upper > 0 && upper < size);
+    const auto& prev = series[upper > 0 ? upper - 1 : 0];
+    const auto& next = series[upper < size ? upper : size - 1];
+    x0[i] = prev.x;
+    y0[i] = prev.y;
+    x1[i] = inside ? next.x : prev.x + 1.0;
+    y1[i] = next.y;
+  }
+
+  // interpolation: no dependencies between the iterations and no branches
+  // (every load and division is unconditional), so that the loops are vectorized.
+  switch (mode)
+  {
+    case NEAREST:
+      for (size_t i = 0; i < count; i++)
+      {
+        const double t = times[i];
+        const double a = y0[i];
+        const double b = y1[i];
+        // the later sample wins a tie, as in PlotData::getIndexFromX()
+        out[i] = (t - x0[i] < x1[i] - t) ? a : b;
+      }
+      break;
+
+    case ZERO_ORDER_HOLD: {
+      const double NaN = std::numeric_limits<double>::quiet_NaN();
+      for (size_t i = 0; i < count; i++)
+      {
+        const double a = y0[i];
+        out[i] = (x0[i] <= times[i]) ? a : NaN;
+      }
+    }
+    break;
+
+    case LINEAR:
+      for (size_t i = 0; i < count; i++)
+      {
+        out[i] = y0[i] + (y1[i] - y0[i]) * (times[i] - x0[i]) / (x1[i] - x0[i]);
+      }
+      break;
+  }
+}
+
+std::vector<double> RegularTimeGrid(double t_min, double t_max, double period)
+{
+  std::vector<double> grid;
+  if (!(period > 0) || t_max < t_min)
+  {
+    return grid;
+  }
+  // computed as t_min + k * period, to avoid accumulating the rounding errors
+  const size_t count = static_cast<size_t>(std::floor((t_max - t_min) / period)) + 1;
+  grid.resize(count);
+  for (size_t k = 0; k < count; k++)
+  {
+    grid[k] = t_min + double(k) * period;
+  }
+  return grid;
+}
+
+TimeMerger::TimeMerger(const std::vector<const PlotData*>& series, double t_min, double t_max,
+                       double tolerance)
+  : _series(series)
+  , _cursors(series.size(), 0)
+  , _current(series.size(), nullptr)
+  , _t_max(t_max)
+  , _tolerance(tolerance)
+{
+  for (size_t i = 0; i < _series.size(); i++)
+  {
+    const PlotData& data = *_series[i];
+    auto first = std::lower_bound(data.begin(), data.end(), t_min,
+                                  [](const PlotData::Point& p, double t) { return p.x < t; });
+    _cursors[i] = std::distance(data.begin(), first);
+    push(i);
+  }
+}
+
+void TimeMerger::push(size_t series)
+{
+  const PlotData& data = *_series[series];
+  const size_t index = _cursors[series];
+  if (index < data.size() && data[index].x <= _t_max)
+  {
+    _heap.push_back({ data[index].x, series });
+    std::push_heap(_heap.begin(), _heap.end(), std::greater<Entry>());
+  }
+}
+
+bool TimeMerger::next()
+{
+  std::fill(_current.begin(), _current.end(), nullptr);
+  if (_heap.empty())
+  {
+    return false;
+  }
+  _time = _heap.front().time;
+
+  // at most one sample per series: repeated timestamps go to the next row
+  std::vector<Entry> postponed;
+  while (!_heap.empty() && _heap.front().time <= _time + _tolerance)
+  {
+    std::pop_heap(_heap.begin(), _heap.end(), std::greater<Entry>());
+    const Entry entry = _heap.back();
+    _heap.pop_back();
+    if (_current[entry.series])
+    {
+      postponed.push_back(entry);
+      continue;
+    }
+    _current[entry.series] = &(*_series[entry.series])[_cursors[entry.series]];
+    _cursors[entry.series]++;
+    push(entry.series);
+  }
+  for (const auto& entry : postponed)
+  {
+    _heap.push_back(entry);
+    std::push_heap(_heap.begin(), _heap.end(), std::greater<Entry>());
+  }
+  return true;
+}
+
+}  // namespace PJ
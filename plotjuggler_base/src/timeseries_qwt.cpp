@@ -5,11 +5,17 @@
  */
 
 #include "timeseries_qwt.h"
+#include "PlotJuggler/performance_monitor.h"
 #include <limits>
 #include <stdexcept>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QString>
+#include <QDomDocument>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
 
 RangeOpt QwtSeriesWrapper::getVisualizationRangeY(Range range_x)
 {
@@ -67,8 +73,108 @@ std::optional<QPointF> QwtTimeseries::sampleFromTime(double t)
   return QPointF(p.x, p.y);
 }
 
+SharedTransformCache::SharedTransformCache(const PlotData* source)
+  : _source(source), _data(source->plotName(), {})
+{
+}
+
+SharedTransformCache::Ptr SharedTransformCache::acquire(const PlotData* source,
+                                                        const QString& transform_ID,
+                                                        const QString& params)
+{
+  // The source is identified by its SeriesIdentity, not by its address, that
+  // may be reused by a series created after this one was deleted.
+  struct Key
+  {
+    std::weak_ptr<const void> source;
+    QString transform_ID;
+    QString params;
+
+    bool operator<(const Key& other) const
+    {
+      if (source.owner_before(other.source))
+      {
+        return true;
+      }
+      if (other.source.owner_before(source))
+      {
+        return false;
+      }
+      return std::tie(transform_ID, params) < std::tie(other.transform_ID, other.params);
+    }
+  };
+  static std::mutex registry_mutex;
+  static std::map<Key, std::weak_ptr<SharedTransformCache>> registry;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto it = registry.begin(); it != registry.end();)
+  {
+    const bool stale = it->second.expired() || it->first.source.expired();
+    it = stale ? registry.erase(it) : std::next(it);
+  }
+
+  Key key{ source->identity().token(), transform_ID, params };
+  if (auto cache = registry[key].lock())
+  {
+    return cache;
+  }
+
+  auto transform = std::dynamic_pointer_cast<TransformFunction_SISO>(
+      TransformFactory::create(transform_ID.toStdString()));
+  if (!transform)
+  {
+    return {};
+  }
+  QDomDocument doc;
+  if (doc.setContent(params))
+  {
+    QSignalBlocker block(transform.get());
+    transform->xmlLoadState(doc.documentElement());
+  }
+
+  auto cache = std::make_shared<SharedTransformCache>(source);
+  cache->_transform = transform;
+  std::vector<PlotData*> dest = { &cache->_data };
+  transform->setData(nullptr, { source }, dest);
+  cache->update();
+
+  registry[key] = cache;
+  return cache;
+}
+
+void SharedTransformCache::update()
+{
+  if (_source->size() == _source_size && _source->revision() == _source_revision &&
+      (_source_size == 0 ||
+       (_source->front().x == _source_front && _source->back().x == _source_back)))
+  {
+    // already updated by another curve sharing this cache, or a reload of the
+    // layout that didn't change the data
+    return;
+  }
+
+  PerformanceMonitor::ScopedTimer timer("Transform", [this]() {
+    return _source->plotName() + "[" + _transform->name() + "]";
+  });
+  // incremental: only the points newer than the last computed one are processed,
+  // while the older ones are trimmed following the maximum range of the source.
+  // If the source changed before that point, the transform restarts from its
+  // nearest checkpoint (see TransformFunction_SISO::rewind).
+  _transform->calculate();
+
+  _source_size = _source->size();
+  _source_revision = _source->revision();
+  if (_source_size > 0)
+  {
+    _source_front = _source->front().x;
+    _source_back = _source->back().x;
+  }
+}
+
+//------------------------------------
+
 TransformedTimeseries::TransformedTimeseries(const PlotData* source_data)
-  : QwtTimeseries(&_dst_data), _dst_data(source_data->plotName(), {}), _src_data(source_data)
+  : QwtTimeseries(source_data), _src_data(source_data)
 {
 }
 
@@ -83,9 +189,12 @@ bool TransformedTimeseries::setTransform(QString transform_ID)
   {
     return true;
   }
+  _shared_cache.reset();
+  _transform.reset();
+  setDataSource(_src_data);
+
   if (transform_ID.isEmpty())
   {
-    _transform.reset();
     return false;
   }
 
@@ -94,32 +203,47 @@ bool TransformedTimeseries::setTransform(QString transform_ID)
   {
     return false;
   }
-  std::vector<PlotData*> dest = { &_dst_data };
-  _dst_data.clear();
-  _transform->setData(nullptr, { _src_data }, dest);
+  acquireSharedCache();
   return true;
 }
 
+bool TransformedTimeseries::acquireSharedCache()
+{
+  QDomDocument doc;
+  auto root = doc.createElement("root");
+  doc.appendChild(root);
+  _transform->xmlSaveState(doc, root);
+
+  auto cache = SharedTransformCache::acquire(_src_data, transformName(), doc.toString(-1));
+  if (!cache)
+  {
+    // should never happen, since _transform was created by the same factory
+    _shared_cache.reset();
+    setDataSource(_src_data);
+    return true;
+  }
+  bool changed = (cache != _shared_cache);
+  _shared_cache = cache;
+  setDataSource(&_shared_cache->data());
+  return changed;
+}
+
 void TransformedTimeseries::updateCache(bool reset_old_data)
 {
-  if (_transform)
+  // Without transform, the source is accessed directly: nothing to do
+  if (!_transform)
   {
-    if (reset_old_data)
-    {
-      _dst_data.clear();
-      _transform->reset();
-    }
-    std::vector<PlotData*> dest = { &_dst_data };
-    _transform->calculate();
+    return;
   }
-  else
+  // the parameters of the transform may have changed. If a different cache
+  // was acquired, it is either new or already up to date.
+  if (reset_old_data && acquireSharedCache())
   {
-    // TODO: optimize ??
-    _dst_data.clear();
-    for (size_t i = 0; i < _src_data->size(); i++)
-    {
-      _dst_data.pushBack(_src_data->at(i));
-    }
+    return;
+  }
+  if (_shared_cache)
+  {
+    _shared_cache->update();
   }
 }
 
@@ -39,6 +39,12 @@ public:
   virtual void updateCache(bool reset_old_data)
   {
   }
+
+protected:
+  void setDataSource(const PlotDataXY* data)
+  {
+    _data = data;
+  }
 };
 
 class QwtTimeseries : public QwtSeriesWrapper
@@ -64,13 +70,63 @@ public:
   {
   }
 
+  // may be nullptr, if the samples are not a timeseries (XY curves)
+  const PlotData* timeseriesData() const
+  {
+    return _ts_data;
+  }
+
+  double timeOffset() const
+  {
+    return _time_offset;
+  }
+
 protected:
+  void setDataSource(const PlotData* data)
+  {
+    QwtSeriesWrapper::setDataSource(data);
+    _ts_data = data;
+  }
+
   const PlotData* _ts_data;
   double _time_offset = 0.0;
 };
 
 //------------------------------------
 
+// Result of a transform applied to a series. It is shared by all the curves
+// (possibly in different plots) that use the same source, transform and
+// parameters, and released when the last of them is destroyed.
+class SharedTransformCache
+{
+public:
+  using Ptr = std::shared_ptr<SharedTransformCache>;
+
+  static Ptr acquire(const PlotData* source, const QString& transform_ID, const QString& params);
+
+  const PlotData& data() const
+  {
+    return _data;
+  }
+
+  // incremental: calculate() follows the points appended, trimmed or inserted in the source.
+  // Nothing else can change, since the parameters are part of the key of the cache.
+  void update();
+
+  SharedTransformCache(const PlotData* source);
+
+private:
+  const PlotData* _source;
+  PlotData _data;
+  TransformFunction_SISO::Ptr _transform;
+
+  // state of the source when calculate() was called the last time
+  size_t _source_size = 0;
+  uint64_t _source_revision = 0;
+  double _source_front = 0;
+  double _source_back = 0;
+};
+
 class TransformedTimeseries : public QwtTimeseries
 {
 public:
@@ -91,9 +147,14 @@ public:
 
 protected:
   QString _alias;
-  PlotData _dst_data;
   const PlotData* _src_data;
+  // not executed: it stores the parameters and provides the options widget.
+  // The data is computed by _shared_cache.
   TransformFunction_SISO::Ptr _transform;
+  SharedTransformCache::Ptr _shared_cache;
+
+  // return true if a different cache was acquired
+  bool acquireSharedCache();
 };
 
 //---------------------------------------------------------
@@ -5,6 +5,7 @@
  */
 
 #include "PlotJuggler/transform_function.h"
+#include <algorithm>
 
 namespace PJ
 {
@@ -19,6 +20,16 @@ std::vector<const PlotData*>& TransformFunction::dataSources()
   return _src_vector;
 }
 
+std::vector<PlotData*>& TransformFunction::dataDestinations()
+{
+  return _dst_vector;
+}
+
+std::vector<const PlotData*> TransformFunction::dependencies()
+{
+  return _src_vector;
+}
+
 void TransformFunction::setData(PlotDataMapRef* data, const std::vector<const PlotData*>& src_vect,
                                 std::vector<PlotData*>& dst_vect)
 {
@@ -39,40 +50,214 @@ void TransformFunction::setData(PlotDataMapRef* data, const std::vector<const Pl
 void TransformFunction_SISO::reset()
 {
   _last_timestamp = std::numeric_limits<double>::lowest();
+  _last_timestamp_count = 0;
+  _checkpoints.clear();
+  _checkpoint_interval = CHECKPOINT_INTERVAL;
+  _since_checkpoint = 0;
 }
 
 void TransformFunction_SISO::calculate()
 {
   const PlotData* src_data = _src_vector.front();
   PlotData* dst_data = _dst_vector.front();
+  dst_data->setMaximumRangeX(src_data->maximumRangeX());
+
+  // the points following these checkpoints were trimmed: they can't be used anymore
+  while (!_checkpoints.empty() &&
+         (src_data->size() == 0 || _checkpoints.front().source_time < src_data->front().x))
+  {
+    _checkpoints.pop_front();
+  }
+
+  // points inserted or removed before the last processed one
+  auto changed_time = src_data->earliestChangeSince(_source_revision);
+  _source_revision = src_data->revision();
+  if (changed_time && _last_timestamp_count > 0 && *changed_time <= _last_timestamp)
+  {
+    rewind(*changed_time);
+  }
+
   if (src_data->size() == 0)
   {
     return;
   }
-  dst_data->setMaximumRangeX(src_data->maximumRangeX());
-  if (dst_data->size() != 0)
+
+  // resume after the last processed point. The source is sorted and, if it was
+  // trimmed, the points older than _last_timestamp are simply missing.
+  auto it = std::lower_bound(src_data->begin(), src_data->end(), _last_timestamp,
+                             [](const PlotData::Point& p, double x) { return p.x < x; });
+  size_t index = std::distance(src_data->begin(), it);
+  for (size_t n = 0; n < _last_timestamp_count && index < src_data->size() &&
+                     src_data->at(index).x == _last_timestamp;
+       n++)
+  {
+    index++;
+  }
+
+  // lazy evaluation: only the points inside the evaluation range
+  size_t src_size = src_data->size();
+  if (_evaluation_range)
   {
-    _last_timestamp = dst_data->back().x;
+    auto first = std::lower_bound(src_data->begin(), src_data->end(), _evaluation_range->min,
+                                  [](const PlotData::Point& p, double x) { return p.x < x; });
+    index = std::max<size_t>(index, std::distance(src_data->begin(), first));
+    auto last = std::upper_bound(src_data->begin(), src_data->end(), _evaluation_range->max,
+                                 [](double x, const PlotData::Point& p) { return x < p.x; });
+    src_size = std::distance(src_data->begin(), last);
   }
 
-  int pos = src_data->getIndexFromX(_last_timestamp);
-  size_t index = pos < 0 ? 0 : static_cast<size_t>(pos);
+  // process the points in blocks, to bound the size of the temporary buffer
+  static constexpr size_t BLOCK_SIZE = 4096;
+  std::vector<PlotData::Point> out_points;
+  out_points.reserve(BLOCK_SIZE);
 
-  while (index < src_data->size())
+  while (index < src_size)
   {
-    const auto& in_point = src_data->at(index);
+    const size_t last = std::min(index + BLOCK_SIZE, src_size);
+    out_points.clear();
+    calculateBatch(index, last, out_points);
+    for (auto& out_point : out_points)
+    {
+      dst_data->pushBack(std::move(out_point));
+    }
 
-    if (in_point.x >= _last_timestamp)
+    const double last_time = src_data->at(last - 1).x;
+    size_t count = 0;
+    size_t i = last;
+    while (i > index && src_data->at(i - 1).x == last_time)
     {
-      auto out_point = calculateNextPoint(index);
-      if (out_point)
-      {
-        dst_data->pushBack(std::move(out_point.value()));
-      }
-      _last_timestamp = in_point.x;
+      i--;
+      count++;
+    }
+    if (i == index && last_time == _last_timestamp)
+    {
+      count += _last_timestamp_count;
+    }
+    _last_timestamp = last_time;
+    _last_timestamp_count = count;
+
+    _since_checkpoint += last - index;
+    if (_since_checkpoint >= _checkpoint_interval)
+    {
+      addCheckpoint();
+    }
+    index = last;
+  }
+}
+
+void TransformFunction_SISO::addCheckpoint()
+{
+  _since_checkpoint = 0;
+  std::any state = saveState();
+  if (!state.has_value())
+  {
+    return;
+  }
+  const PlotData* dst_data = _dst_vector.front();
+
+  Checkpoint checkpoint;
+  checkpoint.source_time = _last_timestamp;
+  checkpoint.source_count = _last_timestamp_count;
+  checkpoint.dst_time = std::numeric_limits<double>::lowest();
+  checkpoint.dst_count = 0;
+  if (dst_data->size() > 0)
+  {
+    checkpoint.dst_time = dst_data->back().x;
+    for (size_t i = dst_data->size(); i > 0 && dst_data->at(i - 1).x == checkpoint.dst_time; i--)
+    {
+      checkpoint.dst_count++;
     }
-    index++;
   }
+  checkpoint.state = std::move(state);
+  _checkpoints.push_back(std::move(checkpoint));
+
+  // keep one checkpoint every two (including the newest one) and double the
+  // interval: the number of checkpoints grows logarithmically with the source.
+  if (_checkpoints.size() > MAX_CHECKPOINTS)
+  {
+    std::deque<Checkpoint> thinned;
+    for (size_t i = _checkpoints.size() % 2 == 0 ? 1 : 0; i < _checkpoints.size(); i += 2)
+    {
+      thinned.push_back(std::move(_checkpoints[i]));
+    }
+    _checkpoints = std::move(thinned);
+    _checkpoint_interval *= 2;
+  }
+}
+
+void TransformFunction_SISO::rewind(double source_time)
+{
+  PlotData* dst_data = _dst_vector.front();
+  while (!_checkpoints.empty() && _checkpoints.back().source_time >= source_time)
+  {
+    _checkpoints.pop_back();
+  }
+  _since_checkpoint = 0;
+
+  if (!_checkpoints.empty())
+  {
+    // restoreState() may read the source up to the checkpoint
+    _last_timestamp = _checkpoints.back().source_time;
+    _last_timestamp_count = _checkpoints.back().source_count;
+  }
+  if (_checkpoints.empty() || !restoreState(_checkpoints.back().state))
+  {
+    reset();
+    dst_data->clear();
+    return;
+  }
+  const Checkpoint& checkpoint = _checkpoints.back();
+
+  // discard the output calculated after the checkpoint
+  while (dst_data->size() > 0 && dst_data->back().x > checkpoint.dst_time)
+  {
+    dst_data->popBack();
+  }
+  size_t equal_count = 0;
+  for (size_t i = dst_data->size(); i > 0 && dst_data->at(i - 1).x == checkpoint.dst_time; i--)
+  {
+    equal_count++;
+  }
+  for (; equal_count > checkpoint.dst_count; equal_count--)
+  {
+    dst_data->popBack();
+  }
+}
+
+std::optional<size_t> TransformFunction_SISO::lastProcessedIndex() const
+{
+  const PlotData* src_data = dataSource();
+  if (!src_data || _last_timestamp_count == 0)
+  {
+    return std::nullopt;
+  }
+  auto it = std::lower_bound(src_data->begin(), src_data->end(), _last_timestamp,
+                             [](const PlotData::Point& p, double x) { return p.x < x; });
+  const size_t index = std::distance(src_data->begin(), it) + _last_timestamp_count - 1;
+  if (index >= src_data->size() || src_data->at(index).x != _last_timestamp)
+  {
+    return std::nullopt;
+  }
+  return index;
+}
+
+void TransformFunction_SISO::calculateBatch(size_t first, size_t last,
+                                            std::vector<PlotData::Point>& out)
+{
+  for (size_t index = first; index < last; index++)
+  {
+    if (auto out_point = calculateNextPoint(index))
+    {
+      out.push_back(std::move(out_point.value()));
+    }
+  }
+}
+
+void TransformFactory::registerTransform(const std::string& name,
+                                         std::function<TransformFunction::Ptr()> creator)
+{
+  instance()->names_.insert(name);
+  instance()->creators_[name] = std::move(creator);
 }
 
 TransformFunction::Ptr TransformFactory::create(const std::string& name)
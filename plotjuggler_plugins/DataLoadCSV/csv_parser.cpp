@@ -0,0 +1,678 @@
+#include "csv_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <QDateTime>
+#include <QLocale>
+
+// smaller files are parsed by a single thread
+static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+// lines parsed between two updates of the progress
+static constexpr size_t PROGRESS_LINES = 4096;
+// lines used to infer the format of the columns
+static constexpr size_t SAMPLE_LINES = 100;
+
+static bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static std::string_view Trimmed(std::string_view str)
+{
+  while (!str.empty() && IsSpace(str.front()))
+  {
+    str.remove_prefix(1);
+  }
+  while (!str.empty() && IsSpace(str.back()))
+  {
+    str.remove_suffix(1);
+  }
+  return str;
+}
+
+void SplitLineView(std::string_view line, char separator, std::vector<std::string_view>& parts,
+                   const std::vector<bool>* keep)
+{
+  parts.clear();
+  bool inside_quotes = false;
+  bool quoted_word = false;
+  size_t start_pos = 0;
+
+  size_t quote_start = 0;
+  size_t quote_end = 0;
+
+  const size_t size = line.size();
+  for (size_t pos = 0; pos < size; pos++)
+  {
+    const char c = line[pos];
+    if (c == '"')
+    {
+      if (inside_quotes)
+      {
+        quoted_word = true;
+        quote_end = pos;
+      }
+      else
+      {
+        quote_start = pos + 1;
+      }
+      inside_quotes = !inside_quotes;
+    }
+
+    bool part_completed = false;
+    bool add_empty = false;
+    size_t end_pos = pos;
+
+    if (!inside_quotes && c == separator)
+    {
+      part_completed = true;
+    }
+    if (pos + 1 == size)
+    {
+      part_completed = true;
+      end_pos = pos + 1;
+      // special case
+      if (c == separator)
+      {
+        end_pos = pos;
+        add_empty = true;
+      }
+    }
+
+    if (part_completed)
+    {
+      const size_t index = parts.size();
+      if (keep && (index >= keep->size() || !(*keep)[index]))
+      {
+        parts.push_back({});
+      }
+      else if (quoted_word)
+      {
+        // like QString::mid(), a negative length means "until the end"
+        const size_t length = quote_end >= quote_start ? quote_end - quote_start : size;
+        parts.push_back(Trimmed(line.substr(quote_start, length)));
+      }
+      else
+      {
+        parts.push_back(Trimmed(line.substr(start_pos, end_pos - start_pos)));
+      }
+      start_pos = pos + 1;
+      quoted_word = false;
+      inside_quotes = false;
+    }
+    if (add_empty)
+    {
+      parts.push_back({});
+    }
+  }
+}
+
+static double IntegerTimestamp(int64_t ts)
+{
+  const int64_t first_ts = 1400000000;  // July 14, 2017
+  const int64_t last_ts = 2000000000;   // May 18, 2033
+
+  // check if it is an absolute time in nanoseconds.
+  // convert to seconds if it is
+  if (ts > first_ts * 1e9 && ts < last_ts * 1e9)
+  {
+    return double(ts) * 1e-9;
+  }
+  // check if it is an absolute time in microseconds.
+  // convert to seconds if it is
+  if (ts > first_ts * 1e6 && ts < last_ts * 1e6)
+  {
+    return double(ts) * 1e-6;
+  }
+  return double(ts);
+}
+
+std::optional<double> AutoParseTimestamp(const QString& str)
+{
+  bool is_number = false;
+  double val = 0.0;
+
+  // Support the case where the timestamp is in nanoseconds / microseconds
+  int64_t ts = str.toLong(&is_number);
+  if (is_number)
+  {
+    val = IntegerTimestamp(ts);
+  }
+  else
+  {
+    // Try a double value (seconds)
+    val = str.toDouble(&is_number);
+  }
+
+  // handle numbers with comma instead of point as decimal separator
+  if (!is_number)
+  {
+    static QLocale locale_with_comma(QLocale::German);
+    val = locale_with_comma.toDouble(str, &is_number);
+  }
+  if (!is_number)
+  {
+    QDateTime ts = QDateTime::fromString(str, Qt::ISODateWithMs);
+    if (ts.isValid())
+    {
+      return double(ts.toMSecsSinceEpoch()) / 1000.0;
+    }
+    else
+    {
+      return std::nullopt;
+    }
+  }
+  return is_number ? std::optional<double>(val) : std::nullopt;
+}
+
+std::optional<double> FormatParseTimestamp(const QString& str, const QString& format)
+{
+  QDateTime ts = QDateTime::fromString(str, format);
+  if (ts.isValid())
+  {
+    return double(ts.toMSecsSinceEpoch()) / 1000.0;
+  }
+  return std::nullopt;
+}
+
+static QString ToQString(std::string_view str)
+{
+  return QString::fromUtf8(str.data(), int(str.size()));
+}
+
+// QString::toDouble() and toLong() accept a leading '+', std::from_chars doesn't
+static bool SkipPlusSign(const char*& first, const char* last)
+{
+  if (first != last && *first == '+')
+  {
+    first++;
+    return first != last && *first != '-';
+  }
+  return first != last;
+}
+
+static bool ParseInteger(std::string_view str, int64_t& value)
+{
+  const char* first = str.data();
+  const char* last = first + str.size();
+  if (!SkipPlusSign(first, last))
+  {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(first, last, value);
+  return ec == std::errc() && ptr == last;
+}
+
+static bool ParseDouble(std::string_view str, double& value)
+{
+  const char* first = str.data();
+  const char* last = first + str.size();
+  if (!SkipPlusSign(first, last))
+  {
+    return false;
+  }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  auto [ptr, ec] = std::from_chars(first, last, value);
+  return ec == std::errc() && ptr == last;
+#else
+  // standard library without std::from_chars for floating point
+  bool is_number = false;
+  value = QString::fromLatin1(first, int(last - first)).toDouble(&is_number);
+  return is_number;
+#endif
+}
+
+static bool ParseCommaNumber(const QString& str, double& value)
+{
+  static QLocale locale_with_comma(QLocale::German);
+  bool is_number = false;
+  value = locale_with_comma.toDouble(str, &is_number);
+  return is_number;
+}
+
+static bool ParseDate(const QString& str, const CSVParserOptions& options, double& value)
+{
+  QDateTime ts;
+  if (options.custom_date_format)
+  {
+    ts = QDateTime::fromString(str, options.date_format);
+  }
+  else
+  {
+    ts = QDateTime::fromString(str, Qt::ISODateWithMs);
+  }
+  if (ts.isValid())
+  {
+    value = ts.toMSecsSinceEpoch() / 1000.0;
+    return true;
+  }
+  return false;
+}
+
+// How the fields of a column are parsed; inferred from the first lines
+enum ValueFormat
+{
+  VALUE_NUMBER,
+  VALUE_COMMA_NUMBER,
+  VALUE_DATE,
+  VALUE_TEXT
+};
+
+enum TimeFormat
+{
+  TIME_NUMBER,
+  TIME_COMMA_NUMBER,
+  TIME_DATE
+};
+
+struct Formats
+{
+  TimeFormat time = TIME_NUMBER;
+  // one per CSVParserOptions::columns
+  std::vector<ValueFormat> columns;
+};
+
+// the conversion of QString, more permissive than ParseDouble()
+static bool ParseQtNumber(const QString& str, double& value)
+{
+  bool is_number = false;
+  value = str.toDouble(&is_number);
+  return is_number;
+}
+
+// all the conversions, in order; returns the first one that succeeded
+static ValueFormat ClassifyValue(std::string_view str, const CSVParserOptions& options,
+                                 double& value)
+{
+  if (ParseDouble(str, value))
+  {
+    return VALUE_NUMBER;
+  }
+  const QString qstr = ToQString(str);
+  if (ParseQtNumber(qstr, value))
+  {
+    return VALUE_NUMBER;
+  }
+  // handle numbers with comma instead of point as decimal separator
+  if (ParseCommaNumber(qstr, value))
+  {
+    return VALUE_COMMA_NUMBER;
+  }
+  if (ParseDate(qstr, options, value))
+  {
+    return VALUE_DATE;
+  }
+  return VALUE_TEXT;
+}
+
+// only the format inferred for the column is tried: the other cells are texts
+static bool ParseValue(std::string_view str, ValueFormat format, const CSVParserOptions& options,
+                       double& value)
+{
+  // missing value: no point in the numeric series
+  if (str.empty())
+  {
+    return false;
+  }
+  // plain numbers are cheap to detect, in any column
+  if (ParseDouble(str, value))
+  {
+    return true;
+  }
+  switch (format)
+  {
+    case VALUE_NUMBER:
+      return ParseQtNumber(ToQString(str), value);
+    case VALUE_COMMA_NUMBER:
+      return ParseCommaNumber(ToQString(str), value);
+    case VALUE_DATE:
+      return ParseDate(ToQString(str), options, value);
+    case VALUE_TEXT:
+      break;
+  }
+  return false;
+}
+
+static std::optional<double> ParseTimestamp(std::string_view str, TimeFormat format,
+                                            const CSVParserOptions& options)
+{
+  if (options.custom_date_format)
+  {
+    return FormatParseTimestamp(ToQString(str), options.date_format);
+  }
+  int64_t integer = 0;
+  if (ParseInteger(str, integer))
+  {
+    return IntegerTimestamp(integer);
+  }
+  double value = 0;
+  if (ParseDouble(str, value))
+  {
+    return value;
+  }
+  const QString qstr = ToQString(str);
+  if ((format == TIME_COMMA_NUMBER && ParseCommaNumber(qstr, value)) ||
+      (format == TIME_DATE && ParseDate(qstr, options, value)))
+  {
+    return value;
+  }
+  return AutoParseTimestamp(qstr);
+}
+
+static std::string_view NextLine(const char*& pos, const char* end)
+{
+  auto newline = static_cast<const char*>(std::memchr(pos, '\n', size_t(end - pos)));
+  const char* line_end = newline ? newline : end;
+  std::string_view line(pos, size_t(line_end - pos));
+  if (!line.empty() && line.back() == '\r')
+  {
+    line.remove_suffix(1);
+  }
+  pos = newline ? newline + 1 : end;
+  return line;
+}
+
+static std::vector<bool> KeptFields(const CSVParserOptions& options)
+{
+  std::vector<bool> keep(options.column_count, false);
+  for (size_t index : options.columns)
+  {
+    keep[index] = true;
+  }
+  if (options.time_index >= 0)
+  {
+    keep[options.time_index] = true;
+  }
+  return keep;
+}
+
+// A column is parsed as text only if all the values of the sample are text:
+// otherwise, its most common format is used.
+static Formats InferFormats(const char* begin, const char* end, const CSVParserOptions& options)
+{
+  const std::vector<bool> keep = KeptFields(options);
+  std::vector<std::array<size_t, 4>> value_count(options.columns.size(), { 0, 0, 0, 0 });
+  std::array<size_t, 3> time_count = { 0, 0, 0 };
+
+  std::vector<std::string_view> fields;
+  const char* pos = begin;
+  for (size_t i = 0; i < SAMPLE_LINES && pos < end; i++)
+  {
+    SplitLineView(NextLine(pos, end), options.delimiter, fields, &keep);
+    if (fields.size() != options.column_count)
+    {
+      continue;
+    }
+    for (size_t c = 0; c < options.columns.size(); c++)
+    {
+      const std::string_view field = fields[options.columns[c]];
+      double value = 0;
+      if (!field.empty())
+      {
+        value_count[c][ClassifyValue(field, options, value)]++;
+      }
+    }
+    if (options.time_index >= 0 && !options.custom_date_format)
+    {
+      const std::string_view field = fields[options.time_index];
+      double value = 0;
+      switch (ClassifyValue(field, options, value))
+      {
+        case VALUE_NUMBER:
+          time_count[TIME_NUMBER]++;
+          break;
+        case VALUE_COMMA_NUMBER:
+          time_count[TIME_COMMA_NUMBER]++;
+          break;
+        case VALUE_DATE:
+          time_count[TIME_DATE]++;
+          break;
+        case VALUE_TEXT:
+          break;
+      }
+    }
+  }
+
+  Formats formats;
+  formats.time =
+      TimeFormat(std::max_element(time_count.begin(), time_count.end()) - time_count.begin());
+  for (const auto& count : value_count)
+  {
+    const size_t numbers = count[VALUE_NUMBER] + count[VALUE_COMMA_NUMBER] + count[VALUE_DATE];
+    if (numbers == 0 && count[VALUE_TEXT] > 0)
+    {
+      formats.columns.push_back(VALUE_TEXT);
+    }
+    else
+    {
+      formats.columns.push_back(
+          ValueFormat(std::max_element(count.begin(), count.begin() + VALUE_TEXT) - count.begin()));
+    }
+  }
+  return formats;
+}
+
+static void ParseChunk(const char* begin, const char* end, const CSVParserOptions& options,
+                       const Formats& formats, CSVChunk& chunk, std::atomic<size_t>& parsed_bytes,
+                       const std::atomic<bool>& cancel)
+{
+  chunk.columns.resize(options.columns.size());
+  const std::vector<bool> keep = KeptFields(options);
+  std::vector<std::string_view> fields;
+
+  // the text of the last row is copied only at the end
+  std::string_view last_time_text;
+
+  const char* reported = begin;
+  const char* pos = begin;
+  while (pos < end)
+  {
+    const std::string_view line = NextLine(pos, end);
+    chunk.line_count++;
+
+    if (chunk.line_count % PROGRESS_LINES == 0)
+    {
+      parsed_bytes += size_t(pos - reported);
+      reported = pos;
+      if (cancel)
+      {
+        return;
+      }
+    }
+
+    SplitLineView(line, options.delimiter, fields, &keep);
+
+    // empty line? just try skipping
+    if (fields.empty())
+    {
+      continue;
+    }
+
+    // corrupted line? just try skipping
+    if (fields.size() != options.column_count)
+    {
+      chunk.skipped.push_back(
+          { chunk.line_count, CSVSkippedLine::WRONG_COLUMN_COUNT, fields.size(), {} });
+      continue;
+    }
+
+    const uint32_t row = uint32_t(chunk.time.size());
+    double timestamp = row;
+
+    if (options.time_index >= 0)
+    {
+      const std::string_view time_text = fields[options.time_index];
+      auto ts = ParseTimestamp(time_text, formats.time, options);
+      if (!ts)
+      {
+        chunk.skipped.push_back({ chunk.line_count, CSVSkippedLine::INVALID_TIMESTAMP,
+                                  fields.size(), std::string(time_text) });
+        continue;
+      }
+      timestamp = *ts;
+
+      if (!chunk.first_time)
+      {
+        chunk.first_time = CSVTimeSample{ chunk.line_count, timestamp, std::string(time_text) };
+      }
+      else if (timestamp < chunk.last_time->time && !chunk.non_monotonic)
+      {
+        CSVTimeSample previous = *chunk.last_time;
+        previous.text = std::string(last_time_text);
+        chunk.non_monotonic = { previous,
+                                CSVTimeSample{ chunk.line_count, timestamp,
+                                               std::string(time_text) } };
+      }
+      chunk.last_time = CSVTimeSample{ chunk.line_count, timestamp, {} };
+      last_time_text = time_text;
+    }
+
+    chunk.time.push_back(timestamp);
+    for (size_t c = 0; c < options.columns.size(); c++)
+    {
+      CSVChunk::Column& column = chunk.columns[c];
+      const std::string_view field = fields[options.columns[c]];
+      double value = 0;
+      if (ParseValue(field, formats.columns[c], options, value))
+      {
+        column.values.push_back(value);
+      }
+      else
+      {
+        column.values.push_back(0);
+        column.text_rows.push_back(row);
+        column.texts.emplace_back(field);
+      }
+    }
+  }
+  if (chunk.last_time)
+  {
+    chunk.last_time->text = std::string(last_time_text);
+  }
+  parsed_bytes += size_t(pos - reported);
+}
+
+CSVParseResult ParseCSV(const char* begin, const char* end, const CSVParserOptions& options,
+                        const std::function<bool(size_t)>& progress)
+{
+  CSVParseResult result;
+
+  // ranges of complete lines, one per thread
+  std::vector<std::pair<const char*, const char*>> ranges;
+  const size_t size = size_t(end - begin);
+  const size_t count = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(), size / MIN_CHUNK_SIZE));
+  const char* start = begin;
+  for (size_t i = 1; i < count && start < end; i++)
+  {
+    const char* boundary = begin + size * i / count;
+    if (boundary < start)
+    {
+      continue;
+    }
+    auto newline = static_cast<const char*>(std::memchr(boundary, '\n', size_t(end - boundary)));
+    const char* stop = newline ? newline + 1 : end;
+    ranges.push_back({ start, stop });
+    start = stop;
+  }
+  if (start < end)
+  {
+    ranges.push_back({ start, end });
+  }
+
+  const Formats formats = InferFormats(begin, end, options);
+
+  result.chunks.resize(ranges.size());
+  std::atomic<size_t> parsed_bytes(0);
+  std::atomic<size_t> finished(0);
+  std::atomic<bool> cancel(false);
+
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < ranges.size(); i++)
+  {
+    workers.emplace_back([&, i]() {
+      ParseChunk(ranges[i].first, ranges[i].second, options, formats, result.chunks[i],
+                 parsed_bytes, cancel);
+      finished++;
+    });
+  }
+  // the calling thread reports the progress (and processes the events of the GUI)
+  while (finished < workers.size())
+  {
+    if (!cancel && !progress(parsed_bytes))
+    {
+      cancel = true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  if (cancel)
+  {
+    result.chunks.clear();
+    result.canceled = true;
+    return result;
+  }
+
+  // from the lines and rows of each chunk to the ones of the file
+  size_t line_offset = options.first_line - 1;
+  size_t row_offset = 0;
+  std::optional<CSVTimeSample> previous_time;
+  for (auto& chunk : result.chunks)
+  {
+    for (auto& skipped : chunk.skipped)
+    {
+      skipped.line += line_offset;
+      result.skipped.push_back(std::move(skipped));
+    }
+    chunk.skipped.clear();
+
+    if (options.time_index < 0)
+    {
+      for (double& time : chunk.time)
+      {
+        time += double(row_offset);
+      }
+    }
+    for (auto* sample : { chunk.first_time ? &(*chunk.first_time) : nullptr,
+                          chunk.last_time ? &(*chunk.last_time) : nullptr })
+    {
+      if (sample)
+      {
+        sample->line += line_offset;
+      }
+    }
+    if (chunk.non_monotonic)
+    {
+      chunk.non_monotonic->first.line += line_offset;
+      chunk.non_monotonic->second.line += line_offset;
+    }
+
+    // the first non monotonic time of the file may be the first one of the chunk
+    if (!result.non_monotonic && previous_time && chunk.first_time &&
+        chunk.first_time->time < previous_time->time)
+    {
+      result.non_monotonic = { *previous_time, *chunk.first_time };
+    }
+    if (!result.non_monotonic && chunk.non_monotonic)
+    {
+      result.non_monotonic = chunk.non_monotonic;
+    }
+    if (chunk.last_time)
+    {
+      previous_time = chunk.last_time;
+    }
+
+    line_offset += chunk.line_count;
+    row_offset += chunk.time.size();
+  }
+  return result;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <QString>
+
+/// Same as SplitLine(), but the fields are views of line: nothing is copied.
+/// The separators inside double quotes are ignored and the fields are trimmed.
+/// If keep is not null, the fields with keep[index] == false are only counted:
+/// they are added to parts as empty views.
+void SplitLineView(std::string_view line, char separator, std::vector<std::string_view>& parts,
+                   const std::vector<bool>* keep = nullptr);
+
+/// Parse a timestamp that can be a number (absolute time in nanoseconds and
+/// microseconds is converted to seconds) or a date in ISO format.
+std::optional<double> AutoParseTimestamp(const QString& str);
+
+std::optional<double> FormatParseTimestamp(const QString& str, const QString& format);
+
+struct CSVParserOptions
+{
+  char delimiter = ',';
+  size_t column_count = 0;
+  /// indices of the columns to load, in ascending order; the other fields are skipped
+  std::vector<size_t> columns;
+  /// if negative, the time of a row is its index
+  int time_index = -1;
+  /// parse the dates with date_format, instead of the ISO format
+  bool custom_date_format = false;
+  QString date_format;
+  /// number of the line at the beginning of the data (the first one is 1)
+  size_t first_line = 1;
+};
+
+struct CSVTimeSample
+{
+  size_t line = 0;
+  double time = 0;
+  std::string text;
+};
+
+struct CSVSkippedLine
+{
+  enum Reason
+  {
+    WRONG_COLUMN_COUNT,
+    INVALID_TIMESTAMP
+  };
+  size_t line;
+  Reason reason;
+  size_t column_count;
+  std::string text;
+};
+
+/// Rows parsed by one thread, from a range of complete lines of the file.
+struct CSVChunk
+{
+  struct Column
+  {
+    /// one value per row; the ones of the text rows are not used
+    std::vector<double> values;
+    /// rows that are not numbers, in ascending order, and their text
+    std::vector<uint32_t> text_rows;
+    std::vector<std::string> texts;
+  };
+
+  std::vector<double> time;
+  /// one per CSVParserOptions::columns
+  std::vector<Column> columns;
+
+  size_t line_count = 0;
+  std::vector<CSVSkippedLine> skipped;
+
+  std::optional<CSVTimeSample> first_time;
+  std::optional<CSVTimeSample> last_time;
+  /// the first row with a time lower than the previous one, and the previous one
+  std::optional<std::pair<CSVTimeSample, CSVTimeSample>> non_monotonic;
+};
+
+struct CSVParseResult
+{
+  /// in the same order as the file
+  std::vector<CSVChunk> chunks;
+  /// the line numbers are the ones of the file
+  std::vector<CSVSkippedLine> skipped;
+  std::optional<std::pair<CSVTimeSample, CSVTimeSample>> non_monotonic;
+  bool canceled = false;
+};
+
+/**
+ * Parse the lines of a CSV file in [begin, end) with multiple threads.
+ *
+ * The data is split into ranges of complete lines that are parsed concurrently:
+ * each thread writes the values into the column buffers of its own CSVChunk.
+ * The numbers are parsed with std::from_chars; the fields that are not plain
+ * numbers fall back to the slower QString / QDateTime conversions.
+ *
+ * The format of the timestamps and of each column (number, number with comma
+ * as decimal separator, date or text) is inferred from the first lines, and
+ * tried first in every row. A column of text is not parsed with the slower
+ * conversions: only its plain numbers are loaded as numbers.
+ *
+ * Like QTextStream::readLine(), a newline always ends a line, even between quotes.
+ *
+ * progress is called periodically by the calling thread with the number of bytes
+ * parsed so far; if it returns false, the parsing is canceled.
+ */
+CSVParseResult ParseCSV(const char* begin, const char* end, const CSVParserOptions& options,
+                        const std::function<bool(size_t)>& progress);
@@ -1,5 +1,6 @@
 #include "datetimehelp.h"
 #include "dataload_csv.h"
+#include "csv_parser.h"
 
 #include <QTextStream>
 #include <QFile>
@@ -14,6 +15,7 @@
 #include <QRadioButton>
 
 #include <array>
+#include <cstring>
 #include <set>
 
 #include <QStandardItemModel>
@@ -127,6 +129,17 @@ DataLoadCSV::DataLoadCSV()
 
   connect(_ui->dateTimeHelpButton, &QPushButton::clicked, this,
           [this]() { _dateTime_dialog->show(); });
+
+  auto checkAllColumns = [this](Qt::CheckState state) {
+    for (int i = 0; i < _ui->listWidgetLoad->count(); i++)
+    {
+      _ui->listWidgetLoad->item(i)->setCheckState(state);
+    }
+  };
+  connect(_ui->buttonSelectAll, &QPushButton::clicked, this,
+          [checkAllColumns]() { checkAllColumns(Qt::Checked); });
+  connect(_ui->buttonSelectNone, &QPushButton::clicked, this,
+          [checkAllColumns]() { checkAllColumns(Qt::Unchecked); });
   _ui->rawText->setHighlighter(&_csvHighlighter);
 
   QSizePolicy sp_retain = _ui->tableView->sizePolicy();
@@ -160,6 +173,7 @@ void DataLoadCSV::parseHeader(QFile& file, std::vector<std::string>& column_name
 
   column_names.clear();
   _ui->listWidgetSeries->clear();
+  _ui->listWidgetLoad->clear();
 
   QTextStream inA(&file);
   // The first line should contain the header. If it contains a number, we will
@@ -254,6 +268,10 @@ void DataLoadCSV::parseHeader(QFile& file, std::vector<std::string>& column_name
     auto qname = QString::fromStdString(name);
     _ui->listWidgetSeries->addItem(qname);
     column_labels.push_back(qname);
+
+    auto item = new QListWidgetItem(qname, _ui->listWidgetLoad);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(_skipped_columns.count(name) ? Qt::Unchecked : Qt::Checked);
   }
   _model->setColumnCount(column_labels.size());
   _model->setHorizontalHeaderLabels(column_labels);
@@ -396,6 +414,16 @@ int DataLoadCSV::launchDialog(QFile& file, std::vector<std::string>* column_name
     return TIME_INDEX_NOT_DEFINED;
   }
 
+  _skipped_columns.clear();
+  for (int i = 0; i < _ui->listWidgetLoad->count(); i++)
+  {
+    auto item = _ui->listWidgetLoad->item(i);
+    if (item->checkState() != Qt::Checked)
+    {
+      _skipped_columns.insert(item->text().toStdString());
+    }
+  }
+
   if (_ui->radioButtonIndex->isChecked())
   {
     return TIME_INDEX_GENERATED;
@@ -413,72 +441,6 @@ int DataLoadCSV::launchDialog(QFile& file, std::vector<std::string>* column_name
   return TIME_INDEX_NOT_DEFINED;
 }
 
-std::optional<double> AutoParseTimestamp(const QString& str)
-{
-  bool is_number = false;
-  QString str_trimmed = str.trimmed();
-  double val = 0.0;
-
-  // Support the case where the timestamp is in nanoseconds / microseconds
-  int64_t ts = str.toLong(&is_number);
-  const int64_t first_ts = 1400000000;  // July 14, 2017
-  const int64_t last_ts = 2000000000;   // May 18, 2033
-  if (is_number)
-  {
-    // check if it is an absolute time in nanoseconds.
-    // convert to seconds if it is
-    if (ts > first_ts * 1e9 && ts < last_ts * 1e9)
-    {
-      val = double(ts) * 1e-9;
-    }
-    else if (ts > first_ts * 1e6 && ts < last_ts * 1e6)
-    {
-      // check if it is an absolute time in microseconds.
-      // convert to seconds if it is
-      val = double(ts) * 1e-6;
-    }
-    else
-    {
-      val = double(ts);
-    }
-  }
-  else
-  {
-    // Try a double value (seconds)
-    val = str.toDouble(&is_number);
-  }
-
-  // handle numbers with comma instead of point as decimal separator
-  if (!is_number)
-  {
-    static QLocale locale_with_comma(QLocale::German);
-    val = locale_with_comma.toDouble(str, &is_number);
-  }
-  if (!is_number)
-  {
-    QDateTime ts = QDateTime::fromString(str, Qt::ISODateWithMs);
-    if (ts.isValid())
-    {
-      return double(ts.toMSecsSinceEpoch()) / 1000.0;
-    }
-    else
-    {
-      return std::nullopt;
-    }
-  }
-  return is_number ? std::optional<double>(val) : std::nullopt;
-};
-
-std::optional<double> FormatParseTimestamp(const QString& str, const QString& format)
-{
-  QDateTime ts = QDateTime::fromString(str, format);
-  if (ts.isValid())
-  {
-    return double(ts.toMSecsSinceEpoch()) / 1000.0;
-  }
-  return std::nullopt;
-}
-
 bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data)
 {
   multiple_columns_warning_ = true;
@@ -493,6 +455,7 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
   if (!info->plugin_config.hasChildNodes())
   {
     _default_time_axis.clear();
+    _skipped_columns.clear();
     time_index = launchDialog(file, &column_names);
   }
   else
@@ -521,259 +484,200 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
   }
 
   //-----------------------------------
-  bool interrupted = false;
-
-  // count the number of lines first
-  int tot_lines = 0;
+  if (!file.open(QFile::ReadOnly))
   {
-    file.open(QFile::ReadOnly);
-    QTextStream in(&file);
-    while (!in.atEnd())
-    {
-      in.readLine();
-      tot_lines++;
-    }
-    file.close();
+    return false;
+  }
+  // the file is mapped in memory when possible, read otherwise
+  QByteArray file_content;
+  const char* file_begin = reinterpret_cast<const char*>(file.map(0, file.size()));
+  const char* file_end = nullptr;
+  if (file_begin)
+  {
+    file_end = file_begin + file.size();
+  }
+  else
+  {
+    file_content = file.readAll();
+    file_begin = file_content.constData();
+    file_end = file_begin + file_content.size();
   }
 
+  // remove first line (header)
+  auto header_end = static_cast<const char*>(std::memchr(file_begin, '\n', file_end - file_begin));
+  const char* data_begin = header_end ? header_end + 1 : file_end;
+
   QProgressDialog progress_dialog;
   progress_dialog.setWindowTitle("Loading the CSV file");
   progress_dialog.setLabelText("Loading... please wait");
   progress_dialog.setWindowModality(Qt::ApplicationModal);
-  progress_dialog.setRange(0, tot_lines);
+  progress_dialog.setRange(0, int((file_end - data_begin) / 1024));
   progress_dialog.setAutoClose(true);
   progress_dialog.setAutoReset(true);
   progress_dialog.show();
 
-  //---- build plots_vector from header  ------
-
-  std::vector<PlotData*> plots_vector;
-  std::vector<StringSeries*> string_vector;
-  bool sortRequired = false;
-
-  for (unsigned i = 0; i < column_names.size(); i++)
+  CSVParserOptions options;
+  options.delimiter = _delimiter.toLatin1();
+  options.column_count = column_names.size();
+  for (size_t i = 0; i < column_names.size(); i++)
   {
-    const std::string& field_name = (column_names[i]);
-    auto num_it = plot_data.addNumeric(field_name);
-    plots_vector.push_back(&(num_it->second));
-
-    auto str_it = plot_data.addStringSeries(field_name);
-    string_vector.push_back(&(str_it->second));
-  }
-
-  //-----------------
-  double prev_time = std::numeric_limits<double>::lowest();
-  const QString format_string = _ui->lineEditDateFormat->text();
-  const bool parse_date_format = _ui->radioCustomTime->isChecked();
-
-  auto ParseNumber = [&](QString str, bool& is_number) {
-    QString str_trimmed = str.trimmed();
-    double val = val = str_trimmed.toDouble(&is_number);
-    // handle numbers with comma instead of point as decimal separator
-    if (!is_number)
+    if (_skipped_columns.count(column_names[i]) == 0)
     {
-      static QLocale locale_with_comma(QLocale::German);
-      val = locale_with_comma.toDouble(str_trimmed, &is_number);
+      options.columns.push_back(i);
     }
-    if (!is_number)
-    {
-      QDateTime ts;
-      if (parse_date_format)
-      {
-        ts = QDateTime::fromString(str_trimmed, format_string);
-      }
-      else
-      {
-        ts = QDateTime::fromString(str_trimmed, Qt::ISODateWithMs);
-      }
-      is_number = ts.isValid();
-      if (is_number)
-      {
-        val = ts.toMSecsSinceEpoch() / 1000.0;
-      }
-    }
-    return val;
-  };
-
-  file.open(QFile::ReadOnly);
-  QTextStream in(&file);
-  // remove first line (header)
-  QString header_str = in.readLine();
-  QStringList string_items;
-  QStringList header_string_items;
-
-  SplitLine(header_str, _delimiter, header_string_items);
-  QString time_header_str;
-  QString t_str;
-  QString prev_t_str;
-
-  int linenumber = 1;
-  int samplecount = 0;
+  }
+  options.time_index = time_index;
+  options.custom_date_format = _ui->radioCustomTime->isChecked();
+  options.date_format = _ui->lineEditDateFormat->text();
+  options.first_line = 2;
 
-  std::vector<std::pair<long, QString>> skipped_lines;
-  bool skipped_wrong_column = false;
-  bool skipped_invalid_timestamp = false;
+  CSVParseResult result =
+      ParseCSV(data_begin, file_end, options, [&](size_t parsed_bytes) {
+        progress_dialog.setValue(int(parsed_bytes / 1024));
+        QApplication::processEvents();
+        return !progress_dialog.wasCanceled();
+      });
+  file.close();
+  progress_dialog.cancel();
 
-  while (!in.atEnd())
+  if (result.canceled)
   {
-    QString line = in.readLine();
-    linenumber++;
-    SplitLine(line, _delimiter, string_items);
-
-    // empty line? just try skipping
-    if (string_items.size() == 0)
-    {
-      continue;
-    }
-
-    // corrupted line? just try skipping
-    if (string_items.size() != column_names.size())
-    {
-      if (!skipped_wrong_column)
-      {
-        auto ret = QMessageBox::warning(nullptr, "Unexpected column count",
-                                        tr("Line %1 has %2 columns, but the expected number of "
-                                           "columns is %3.\n Do you want to continue?")
-                                            .arg(linenumber)
-                                            .arg(string_items.size())
-                                            .arg(column_names.size()),
-                                        QMessageBox::Yes | QMessageBox::Abort, QMessageBox::Yes);
-        if (ret == QMessageBox::Abort)
-        {
-          return false;
-        }
-      }
-      skipped_wrong_column = true;
-      skipped_lines.emplace_back(linenumber, "wrong column count");
-      continue;
-    }
-
-    double timestamp = samplecount;
+    return false;
+  }
 
-    if (time_index >= 0)
+  //---- warn about the first occurrence of each problem, in the order of the file ----
+  std::optional<CSVSkippedLine> wrong_column;
+  std::optional<CSVSkippedLine> invalid_timestamp;
+  for (const auto& skipped : result.skipped)
+  {
+    auto& first = (skipped.reason == CSVSkippedLine::WRONG_COLUMN_COUNT) ? wrong_column :
+                                                                           invalid_timestamp;
+    if (!first)
+    {
+      first = skipped;
+    }
+  }
+
+  std::vector<std::pair<size_t, std::function<bool()>>> warnings;
+  if (wrong_column)
+  {
+    warnings.push_back({ wrong_column->line, [&]() {
+                          auto ret = QMessageBox::warning(
+                              nullptr, "Unexpected column count",
+                              tr("Line %1 has %2 columns, but the expected number of "
+                                 "columns is %3.\n Do you want to continue?")
+                                  .arg(wrong_column->line)
+                                  .arg(wrong_column->column_count)
+                                  .arg(column_names.size()),
+                              QMessageBox::Yes | QMessageBox::Abort, QMessageBox::Yes);
+                          return ret != QMessageBox::Abort;
+                        } });
+  }
+  if (invalid_timestamp)
+  {
+    warnings.push_back({ invalid_timestamp->line, [&]() {
+                          auto ret = QMessageBox::warning(
+                              nullptr, "Error parsing timestamp",
+                              tr("Line %1 has an invalid timestamp: "
+                                 "\"%2\".\n Do you want to continue?")
+                                  .arg(invalid_timestamp->line)
+                                  .arg(QString::fromStdString(invalid_timestamp->text)),
+                              QMessageBox::Yes | QMessageBox::Abort, QMessageBox::Yes);
+                          return ret != QMessageBox::Abort;
+                        } });
+  }
+  if (result.non_monotonic)
+  {
+    const CSVTimeSample& previous = result.non_monotonic->first;
+    const CSVTimeSample& current = result.non_monotonic->second;
+    warnings.push_back({ current.line, [&]() {
+                          QMessageBox msgBox;
+                          QString timeName = QString::fromStdString(column_names[time_index]);
+
+                          msgBox.setWindowTitle(tr("Selected time is not monotonic"));
+                          msgBox.setText(
+                              tr("PlotJuggler detected that the time in this file is "
+                                 "non-monotonic. This may indicate an issue with the input "
+                                 "data. Continue? (Input file will not be modified but data "
+                                 "will be sorted by PlotJuggler)"));
+                          msgBox.setDetailedText(tr("File: \"%1\" \n\n"
+                                                    "Selected time is not monotonic\n"
+                                                    "Time Index: %6 [%7]\n"
+                                                    "Time at line %2 : %3\n"
+                                                    "Time at line %4 : %5")
+                                                     .arg(_fileInfo->filename)
+                                                     .arg(previous.line)
+                                                     .arg(QString::fromStdString(previous.text))
+                                                     .arg(current.line)
+                                                     .arg(QString::fromStdString(current.text))
+                                                     .arg(time_index)
+                                                     .arg(timeName));
+
+                          QPushButton* sortButton =
+                              msgBox.addButton(tr("Continue"), QMessageBox::ActionRole);
+                          msgBox.addButton(QMessageBox::Abort);
+                          msgBox.setIcon(QMessageBox::Warning);
+                          msgBox.exec();
+                          return msgBox.clickedButton() == sortButton;
+                        } });
+  }
+  std::sort(warnings.begin(), warnings.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  for (const auto& warning : warnings)
+  {
+    if (!warning.second())
+    {
+      return false;
+    }
+  }
+
+  //---- one series per column: numeric, unless it contains only strings ----
+  for (size_t c = 0; c < options.columns.size(); c++)
+  {
+    const std::string& field_name = column_names[options.columns[c]];
+    size_t row_count = 0;
+    size_t text_count = 0;
+    for (const auto& chunk : result.chunks)
+    {
+      row_count += chunk.time.size();
+      text_count += chunk.columns[c].texts.size();
+    }
+    const bool is_numeric = (text_count == 0 || text_count < row_count);
+
+    // copy the column parsed by each thread, in the order of the file
+    if (is_numeric)
     {
-      t_str = string_items[time_index];
-      const auto time_trimm = t_str.trimmed();
-      bool is_number = false;
-      if (parse_date_format)
+      PlotData& plot = plot_data.addNumeric(field_name)->second;
+      for (auto& chunk : result.chunks)
       {
-        if (auto ts = FormatParseTimestamp(time_trimm, format_string))
+        auto& column = chunk.columns[c];
+        size_t next_text = 0;
+        for (size_t row = 0; row < chunk.time.size(); row++)
         {
-          is_number = true;
-          timestamp = *ts;
-        }
-      }
-      else
-      {
-        if (auto ts = AutoParseTimestamp(time_trimm))
-        {
-          is_number = true;
-          timestamp = *ts;
-        }
-      }
-
-      time_header_str = header_string_items[time_index];
-
-      if (!is_number)
-      {
-        if (!skipped_invalid_timestamp)
-        {
-          auto ret = QMessageBox::warning(nullptr, "Error parsing timestamp",
-                                          tr("Line %1 has an invalid timestamp: "
-                                             "\"%2\".\n Do you want to continue?")
-                                              .arg(linenumber)
-                                              .arg(t_str),
-                                          QMessageBox::Yes | QMessageBox::Abort, QMessageBox::Yes);
-          if (ret == QMessageBox::Abort)
+          if (next_text < column.text_rows.size() && column.text_rows[next_text] == row)
           {
-            return false;
+            next_text++;
+            continue;
           }
+          plot.pushBack({ chunk.time[row], column.values[row] });
         }
-        skipped_invalid_timestamp = true;
-        skipped_lines.emplace_back(linenumber, "invalid timestamp");
-        continue;
-      }
-
-      if (prev_time > timestamp && !sortRequired)
-      {
-        QMessageBox msgBox;
-        QString timeName;
-        timeName = time_header_str;
-
-        msgBox.setWindowTitle(tr("Selected time is not monotonic"));
-        msgBox.setText(tr("PlotJuggler detected that the time in this file is "
-                          "non-monotonic. This may indicate an issue with the input "
-                          "data. Continue? (Input file will not be modified but data "
-                          "will be sorted by PlotJuggler)"));
-        msgBox.setDetailedText(tr("File: \"%1\" \n\n"
-                                  "Selected time is not monotonic\n"
-                                  "Time Index: %6 [%7]\n"
-                                  "Time at line %2 : %3\n"
-                                  "Time at line %4 : %5")
-                                   .arg(_fileInfo->filename)
-                                   .arg(linenumber - 1)
-                                   .arg(prev_t_str)
-                                   .arg(linenumber)
-                                   .arg(t_str)
-                                   .arg(time_index)
-                                   .arg(timeName));
-
-        QPushButton* sortButton = msgBox.addButton(tr("Continue"), QMessageBox::ActionRole);
-        QPushButton* abortButton = msgBox.addButton(QMessageBox::Abort);
-        msgBox.setIcon(QMessageBox::Warning);
-        msgBox.exec();
-
-        if (msgBox.clickedButton() == abortButton)
-        {
-          return false;
-        }
-        else if (msgBox.clickedButton() == sortButton)
-        {
-          sortRequired = true;
-        }
-        else
-        {
-          return false;
-        }
-      }
-
-      prev_time = timestamp;
-      prev_t_str = t_str;
-    }
-
-    for (unsigned i = 0; i < string_items.size(); i++)
-    {
-      bool is_number = false;
-      const auto& str = string_items[i];
-      double y = ParseNumber(str, is_number);
-      if (is_number)
-      {
-        plots_vector[i]->pushBack({ timestamp, y });
-      }
-      else
-      {
-        string_vector[i]->pushBack({ timestamp, str.toStdString() });
+        // release the memory as soon as possible
+        column = CSVChunk::Column();
       }
     }
-
-    if (linenumber % 100 == 0)
+    else
     {
-      progress_dialog.setValue(linenumber);
-      QApplication::processEvents();
-      if (progress_dialog.wasCanceled())
+      StringSeries& strings = plot_data.addStringSeries(field_name)->second;
+      for (auto& chunk : result.chunks)
       {
-        interrupted = true;
-        break;
+        auto& column = chunk.columns[c];
+        for (size_t i = 0; i < column.texts.size(); i++)
+        {
+          strings.pushBack({ chunk.time[column.text_rows[i]], column.texts[i] });
+        }
+        column = CSVChunk::Column();
       }
     }
-    samplecount++;
-  }
-
-  if (interrupted)
-  {
-    progress_dialog.cancel();
-    plot_data.clear();
-    return false;
   }
 
   if (time_index >= 0)
@@ -785,36 +689,20 @@ bool DataLoadCSV::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_data
     _default_time_axis = INDEX_AS_TIME;
   }
 
-  // cleanups
-  for (unsigned i = 0; i < column_names.size(); i++)
-  {
-    const auto& name = column_names[i];
-    bool is_numeric = true;
-    if (plots_vector[i]->size() == 0 && string_vector[i]->size() > 0)
-    {
-      is_numeric = false;
-    }
-    if (is_numeric)
-    {
-      plot_data.strings.erase(plot_data.strings.find(name));
-    }
-    else
-    {
-      plot_data.numeric.erase(plot_data.numeric.find(name));
-    }
-  }
-
   // Warn the user if some lines have been skipped.
-  if (!skipped_lines.empty())
+  if (!result.skipped.empty())
   {
     QMessageBox msgBox;
     msgBox.setWindowTitle(tr("Some lines have been skipped"));
     msgBox.setText(tr("Some lines were not parsed as expected. "
                       "This indicates an issue with the input data."));
     QString detailed_text;
-    for (const auto& line : skipped_lines)
+    for (const auto& line : result.skipped)
     {
-      detailed_text += tr("Line %1: %2\n").arg(line.first).arg(line.second);
+      const char* reason = (line.reason == CSVSkippedLine::WRONG_COLUMN_COUNT) ?
+                               "wrong column count" :
+                               "invalid timestamp";
+      detailed_text += tr("Line %1: %2\n").arg(line.line).arg(reason);
     }
     msgBox.setDetailedText(detailed_text);
     msgBox.addButton(tr("Continue"), QMessageBox::ActionRole);
@@ -836,6 +724,13 @@ bool DataLoadCSV::xmlSaveState(QDomDocument& doc, QDomElement& parent_element) c
   {
     elem.setAttribute("date_format", _ui->lineEditDateFormat->text());
   }
+  // the columns that were not loaded; any new column of the file is loaded
+  for (const auto& name : _skipped_columns)
+  {
+    QDomElement skipped = doc.createElement("skipped_column");
+    skipped.setAttribute("name", QString::fromStdString(name));
+    elem.appendChild(skipped);
+  }
 
   parent_element.appendChild(elem);
   return true;
@@ -852,6 +747,12 @@ bool DataLoadCSV::xmlLoadState(const QDomElement& parent_element)
   {
     _default_time_axis = elem.attribute("time_axis").toStdString();
   }
+  _skipped_columns.clear();
+  for (auto skipped = elem.firstChildElement("skipped_column"); !skipped.isNull();
+       skipped = skipped.nextSiblingElement("skipped_column"))
+  {
+    _skipped_columns.insert(skipped.attribute("name").toStdString());
+  }
   if (elem.hasAttribute("delimiter"))
   {
     int separator_index = elem.attribute("delimiter").toInt();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <set>
 #include <QObject>
 #include <QtPlugin>
 #include <QStandardItemModel>
@@ -14,7 +15,7 @@ class DateTimeHelp;
 class DataLoadCSV : public DataLoader
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader")
+  Q_PLUGIN_METADATA(IID DataRead_iid)
   Q_INTERFACES(PJ::DataLoader)
 
 public:
@@ -45,6 +46,9 @@ private:
 
   std::string _default_time_axis;
 
+  // columns of the file that are not parsed
+  std::set<std::string> _skipped_columns;
+
   QChar _delimiter;
 
   QCSVHighlighter _csvHighlighter;
@@ -18,7 +18,131 @@
 #include <QStandardItemModel>
 #include <QtConcurrent>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <set>
+#include <thread>
+
+// Reads and parses the messages in a range of log time, in its own thread
+struct Worker
+{
+  mcap::ReadMessageOptions options;
+  PlotDataMapRef data;
+  std::unordered_map<int, MessageParserPtr> parsers;  // channel_id
+  // reads the entire time range selected, for the topics that can't be split
+  bool sequential = false;
+  // only the chunks that contain these topics are decompressed
+  std::set<std::string> topics;
+  // The messages before parse_start are parsed by warmup_parsers, whose data is
+  // discarded: they only update the state shared by the parsers of the sequential topics.
+  mcap::Timestamp parse_start = 0;
+  std::unordered_map<int, MessageParserPtr> warmup_parsers;  // channel_id
+  PlotDataMapRef warmup_data;
+};
+
+// Messages whose parsers share a state between messages of different topics, for
+// instance a schema published once and used by the following messages of another
+// topic. They can't be split between threads.
+static bool IsSequentialSchema(const std::string& schema_name)
+{
+  static const std::array<const char*, 4> packages = { "data_tamer_msgs/", "pal_statistics_msgs/",
+                                                       "plotjuggler_msgs/", "tsl_msgs/" };
+  for (const char* package : packages)
+  {
+    if (schema_name.rfind(package, 0) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Split the log time [start_time, end_time) in contiguous ranges that contain about
+// the same amount of data, according to the index of the chunks.
+static std::vector<std::pair<mcap::Timestamp, mcap::Timestamp>>
+SplitTimeRange(const std::vector<mcap::ChunkIndex>& chunk_indexes, size_t count,
+               mcap::Timestamp start_time, mcap::Timestamp end_time)
+{
+  std::vector<std::pair<mcap::Timestamp, mcap::Timestamp>> ranges;
+
+  std::vector<const mcap::ChunkIndex*> chunks;
+  uint64_t total_size = 0;
+  for (const auto& chunk : chunk_indexes)
+  {
+    if (chunk.messageEndTime >= start_time && chunk.messageStartTime < end_time)
+    {
+      chunks.push_back(&chunk);
+      total_size += chunk.uncompressedSize;
+    }
+  }
+  std::sort(chunks.begin(), chunks.end(), [](const auto* a, const auto* b) {
+    return a->messageStartTime < b->messageStartTime;
+  });
+
+  uint64_t size = 0;
+  for (const auto* chunk : chunks)
+  {
+    if (ranges.size() + 1 < count && size >= total_size * (ranges.size() + 1) / count &&
+        chunk->messageStartTime > start_time)
+    {
+      ranges.push_back({ start_time, chunk->messageStartTime });
+      start_time = chunk->messageStartTime;
+    }
+    size += chunk->uncompressedSize;
+  }
+  ranges.push_back({ start_time, end_time });
+  return ranges;
+}
+
+// Append the series of source at the end of the ones with the same name in destination
+template <typename Series>
+static void MergeSeries(std::unordered_map<std::string, Series>& source,
+                        std::unordered_map<std::string, Series>& destination,
+                        PlotDataMapRef& destination_map)
+{
+  for (auto& [name, source_series] : source)
+  {
+    PlotGroup::Ptr group;
+    if (source_series.group())
+    {
+      group = destination_map.getOrCreateGroup(source_series.group()->name());
+      for (const auto& [attr_name, attr] : source_series.group()->attributes())
+      {
+        group->setAttribute(attr_name, attr);
+      }
+    }
+
+    auto it = destination.find(name);
+    if (it == destination.end())
+    {
+      it = destination
+               .emplace(std::piecewise_construct, std::forward_as_tuple(name),
+                        std::forward_as_tuple(source_series.plotName(), group))
+               .first;
+    }
+    auto& destination_series = it->second;
+
+    if (destination_series.size() == 0)
+    {
+      std::swap(destination_series, source_series);
+      if (group)
+      {
+        destination_series.changeGroup(group);
+      }
+      continue;
+    }
+    for (const auto& [attr_name, attr] : source_series.attributes())
+    {
+      destination_series.setAttribute(attr_name, attr);
+    }
+    for (size_t i = 0; i < source_series.size(); i++)
+    {
+      destination_series.pushBack(std::move(source_series.at(i)));
+    }
+    source_series.clear();
+  }
+}
 
 DataLoadMCAP::DataLoadMCAP()
 {
@@ -41,6 +165,11 @@ bool DataLoadMCAP::xmlSaveState(QDomDocument& doc, QDomElement& parent_element)
   elem.setAttribute("clamp_large_arrays", int(params.clamp_large_arrays));
   elem.setAttribute("max_array_size", params.max_array_size);
   elem.setAttribute("selected_topics", params.selected_topics.join(';'));
+  if (params.use_time_range)
+  {
+    elem.setAttribute("start_time", QString::number(params.start_time));
+    elem.setAttribute("end_time", QString::number(params.end_time));
+  }
 
   parent_element.appendChild(elem);
   return true;
@@ -60,6 +189,12 @@ bool DataLoadMCAP::xmlLoadState(const QDomElement& parent_element)
   params.clamp_large_arrays = bool(elem.attribute("clamp_large_arrays").toInt());
   params.max_array_size = elem.attribute("max_array_size").toInt();
   params.selected_topics = elem.attribute("selected_topics").split(';');
+  params.use_time_range = elem.hasAttribute("start_time") && elem.hasAttribute("end_time");
+  if (params.use_time_range)
+  {
+    params.start_time = elem.attribute("start_time").toULongLong();
+    params.end_time = elem.attribute("end_time").toULongLong();
+  }
   _dialog_parameters = params;
   return true;
 }
@@ -103,9 +238,8 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
 
   const std::optional<mcap::Statistics> statistics = reader.statistics();
 
-  std::unordered_map<int, mcap::SchemaPtr> mcap_schemas;         // schema_id
-  std::unordered_map<int, mcap::ChannelPtr> channels;            // channel_id
-  std::unordered_map<int, MessageParserPtr> parsers_by_channel;  // channel_id
+  std::unordered_map<int, mcap::SchemaPtr> mcap_schemas;  // schema_id
+  std::unordered_map<int, mcap::ChannelPtr> channels;     // channel_id
 
   int total_dt_schemas = 0;
 
@@ -135,7 +269,12 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
     {
       msg_count = statistics->channelMessageCounts;
     }
-    DialogMCAP dialog(channels, mcap_schemas, msg_count, _dialog_parameters);
+    std::optional<std::pair<uint64_t, uint64_t>> log_time_range;
+    if (statistics)
+    {
+      log_time_range = { statistics->messageStartTime, statistics->messageEndTime };
+    }
+    DialogMCAP dialog(channels, mcap_schemas, msg_count, log_time_range, _dialog_parameters);
     auto ret = dialog.exec();
     if (ret != QDialog::Accepted)
     {
@@ -157,6 +296,41 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
 
   std::map<std::string, FailedParserInfo> parsers_blacklist;
 
+  // The messages are parsed by multiple threads. Each worker reads a range of log time
+  // with its own McapReader, and parses it with its own parsers, that write into its
+  // own PlotDataMapRef. The series of the workers are merged at the end.
+  mcap::Timestamp start_time = 0;
+  mcap::Timestamp end_time = mcap::MaxTime;
+  if (_dialog_parameters->use_time_range)
+  {
+    start_time = _dialog_parameters->start_time;
+    end_time = std::max(_dialog_parameters->end_time, start_time);
+    // the end of ReadMessageOptions is excluded
+    if (end_time < mcap::MaxTime)
+    {
+      end_time++;
+    }
+  }
+
+  const unsigned thread_count = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (const auto& [range_start, range_end] :
+       SplitTimeRange(reader.chunkIndexes(), thread_count, start_time, end_time))
+  {
+    workers.push_back(std::make_unique<Worker>());
+    workers.back()->options.startTime = range_start;
+    workers.back()->options.endTime = range_end;
+  }
+  // the topics whose parsers share a state (see IsSequentialSchema() and
+  // ParserFactoryPlugin::parsersShareState()) are read in order by a single worker
+  // (from the beginning of the file, since a message may depend on an older one)
+  workers.push_back(std::make_unique<Worker>());
+  workers.back()->options.endTime = end_time;
+  workers.back()->parse_start = start_time;
+  workers.back()->sequential = true;
+
+  std::unordered_set<int> enabled_channels;
+
   for (const auto& [channel_id, channel_ptr] : channels)
   {
     const auto& topic_name = channel_ptr->topic;
@@ -215,13 +389,42 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
 
     try
     {
+      // one parser per channel per worker
       auto& parser_factory = it->second;
-      auto parser = parser_factory->createParser(topic_name, schema->name, definition, plot_data);
-
-      parsers_by_channel.insert({ channel_ptr->id, parser });
+      const bool sequential =
+          IsSequentialSchema(schema->name) || parser_factory->parsersShareState();
+      for (auto& worker : workers)
+      {
+        if (worker->sequential == sequential)
+        {
+          auto parser =
+              parser_factory->createParser(topic_name, schema->name, definition, worker->data);
+          parser->setLargeArraysPolicy(_dialog_parameters->clamp_large_arrays,
+                                       _dialog_parameters->max_array_size);
+          parser->enableEmbeddedTimestamp(_dialog_parameters->use_timestamp);
+          worker->parsers.insert({ channel_ptr->id, parser });
+          worker->topics.insert(topic_name);
+
+          if (worker->parse_start > 0)
+          {
+            auto warmup_parser = parser_factory->createParser(topic_name, schema->name,
+                                                              definition, worker->warmup_data);
+            warmup_parser->setLargeArraysPolicy(_dialog_parameters->clamp_large_arrays,
+                                                _dialog_parameters->max_array_size);
+            worker->warmup_parsers.insert({ channel_ptr->id, warmup_parser });
+          }
+        }
+      }
+      enabled_channels.insert(channel_id);
     }
     catch (std::exception& e)
     {
+      for (auto& worker : workers)
+      {
+        worker->parsers.erase(channel_ptr->id);
+        worker->warmup_parsers.erase(channel_ptr->id);
+        worker->topics.erase(topic_name);
+      }
       FailedParserInfo failed_parser_info;
       failed_parser_info.error_message = e.what();
       failed_parser_info.topics.insert(channel_ptr->topic);
@@ -248,36 +451,50 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
     QMessageBox::warning(nullptr, "Parser Error", error_message);
   }
 
-  std::unordered_set<int> enabled_channels;
   size_t total_msgs = 0;
+  for (int channel_id : enabled_channels)
+  {
+    if (statistics && statistics->channelMessageCounts.count(channel_id) != 0)
+    {
+      total_msgs += statistics->channelMessageCounts.at(channel_id);
+    }
+  }
 
-  for (const auto& [channel_id, parser] : parsers_by_channel)
+  if (statistics && _dialog_parameters->use_time_range &&
+      statistics->messageEndTime > statistics->messageStartTime)
   {
-    parser->setLargeArraysPolicy(_dialog_parameters->clamp_large_arrays,
-                                 _dialog_parameters->max_array_size);
-    parser->enableEmbeddedTimestamp(_dialog_parameters->use_timestamp);
+    const double duration = double(statistics->messageEndTime - statistics->messageStartTime);
+    const double fraction = double(end_time - start_time) / duration;
+    total_msgs = size_t(double(total_msgs) * std::min(1.0, fraction));
+  }
 
-    QString topic_name = QString::fromStdString(channels[channel_id]->topic);
-    if (_dialog_parameters->selected_topics.contains(topic_name))
+  // The message index is used to skip the chunks that don't contain any of the
+  // topics of a worker, or that are outside its time range; without it, the entire
+  // data section in the time range is read.
+  const auto& chunk_indexes = reader.chunkIndexes();
+  const bool has_message_index =
+      !chunk_indexes.empty() &&
+      std::all_of(chunk_indexes.begin(), chunk_indexes.end(),
+                  [](const mcap::ChunkIndex& chunk) { return chunk.messageIndexLength > 0; });
+
+  workers.erase(std::remove_if(workers.begin(), workers.end(),
+                               [](const auto& worker) { return worker->topics.empty(); }),
+                workers.end());
+  for (auto& worker : workers)
+  {
+    const auto& topics = worker->topics;
+    worker->options.topicFilter = [&topics](std::string_view topic) {
+      return topics.count(std::string(topic)) != 0;
+    };
+    if (has_message_index)
     {
-      enabled_channels.insert(channel_id);
-      auto mcap_channel = channels[channel_id]->id;
-      if (statistics->channelMessageCounts.count(mcap_channel) != 0)
-      {
-        total_msgs += statistics->channelMessageCounts.at(channel_id);
-      }
+      worker->options.readOrder = mcap::ReadMessageOptions::ReadOrder::LogTimeOrder;
     }
   }
 
   //-------------------------------------------
   //---------------- Parse messages -----------
 
-  auto onProblem = [](const mcap::Status& problem) {
-    qDebug() << QString::fromStdString(problem.message);
-  };
-
-  auto messages = reader.readMessages(onProblem);
-
   QProgressDialog progress_dialog("Loading... please wait", "Cancel", 0, 0, nullptr);
   progress_dialog.setWindowTitle("Loading the MCAP file");
   progress_dialog.setWindowModality(Qt::ApplicationModal);
@@ -285,47 +502,111 @@ bool DataLoadMCAP::readDataFromFile(FileLoadInfo* info, PlotDataMapRef& plot_dat
   progress_dialog.show();
   progress_dialog.setValue(0);
 
-  size_t msg_count = 0;
+  const std::string filename = info->filename.toStdString();
+  const bool use_mcap_log_time = _dialog_parameters->use_mcap_log_time;
 
-  auto new_progress_update = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+  std::atomic<size_t> msg_count(0);
+  std::atomic<size_t> finished(0);
+  std::atomic<bool> cancel(false);
+  std::vector<std::exception_ptr> errors(workers.size());
 
-  for (const auto& msg_view : messages)
-  {
-    if (enabled_channels.count(msg_view.channel->id) == 0)
-    {
-      continue;
-    }
+  auto readMessages = [&](Worker& worker) {
+    auto onProblem = [](const mcap::Status& problem) {
+      qDebug() << QString::fromStdString(problem.message);
+    };
 
-    // MCAP always represents publishTime in nanoseconds
-    double timestamp_sec = double(msg_view.message.publishTime) * 1e-9;
-    if (_dialog_parameters->use_mcap_log_time)
+    mcap::McapReader worker_reader;
+    auto status = worker_reader.open(filename);
+    if (status.ok())
     {
-      timestamp_sec = double(msg_view.message.logTime) * 1e-9;
+      status = worker_reader.readSummary(mcap::ReadSummaryMethod::NoFallbackScan);
     }
-    auto parser_it = parsers_by_channel.find(msg_view.channel->id);
-    if (parser_it == parsers_by_channel.end())
+    if (!status.ok())
     {
-      qDebug() << "Skipping channeld id: " << msg_view.channel->id;
-      continue;
+      throw std::runtime_error(status.message);
     }
 
-    auto parser = parser_it->second;
-    MessageRef msg(msg_view.message.data, msg_view.message.dataSize);
-    parser->parseMessage(msg, timestamp_sec);
-
-    if (msg_count++ % 100 == 0 && std::chrono::steady_clock::now() > new_progress_update)
+    for (const auto& msg_view : worker_reader.readMessages(onProblem, worker.options))
     {
-      new_progress_update += std::chrono::milliseconds(500);
-      progress_dialog.setValue(msg_count);
-      QApplication::processEvents();
-      if (progress_dialog.wasCanceled())
+      if (cancel)
       {
         break;
       }
+      const bool warmup = msg_view.message.logTime < worker.parse_start;
+      auto& parsers = warmup ? worker.warmup_parsers : worker.parsers;
+      auto parser_it = parsers.find(msg_view.channel->id);
+      if (parser_it == parsers.end())
+      {
+        continue;
+      }
+
+      // MCAP always represents publishTime in nanoseconds
+      double timestamp_sec = double(msg_view.message.publishTime) * 1e-9;
+      if (use_mcap_log_time)
+      {
+        timestamp_sec = double(msg_view.message.logTime) * 1e-9;
+      }
+
+      MessageRef msg(msg_view.message.data, msg_view.message.dataSize);
+      parser_it->second->parseMessage(msg, timestamp_sec);
+      if (!warmup)
+      {
+        msg_count++;
+      }
     }
+    worker_reader.close();
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < workers.size(); i++)
+  {
+    threads.emplace_back([&, i]() {
+      try
+      {
+        readMessages(*workers[i]);
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+        cancel = true;
+      }
+      finished++;
+    });
   }
 
+  while (finished < threads.size())
+  {
+    progress_dialog.setValue(msg_count);
+    QApplication::processEvents();
+    if (progress_dialog.wasCanceled())
+    {
+      cancel = true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
   reader.close();
+
+  for (const auto& error : errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // the workers are sorted by time: the series are appended in order
+  for (auto& worker : workers)
+  {
+    MergeSeries(worker->data.numeric, plot_data.numeric, plot_data);
+    MergeSeries(worker->data.strings, plot_data.strings, plot_data);
+    MergeSeries(worker->data.scatter_xy, plot_data.scatter_xy, plot_data);
+    MergeSeries(worker->data.user_defined, plot_data.user_defined, plot_data);
+  }
+
   qDebug() << "Loaded file in " << timer.elapsed() << "milliseconds";
   return true;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <QStringList>
 
 namespace mcap
@@ -13,6 +14,10 @@ struct LoadParams
   bool use_timestamp = false;
   bool use_mcap_log_time;
   int sorted_column = 0;
+  // load only the messages with log time in [start_time, end_time], in nanoseconds
+  bool use_time_range = false;
+  uint64_t start_time = 0;
+  uint64_t end_time = 0;
 };
 
 }  // namespace mcap
@@ -5,6 +5,7 @@
 #include <QDialogButtonBox>
 #include <QPushButton>
 #include <QElapsedTimer>
+#include <cmath>
 
 #define MCAP_IMPLEMENTATION
 #include <mcap/reader.hpp>
@@ -14,6 +15,7 @@ const QString DialogMCAP::prefix = "DialogLoadMCAP::";
 DialogMCAP::DialogMCAP(const std::unordered_map<int, mcap::ChannelPtr>& channels,
                        const std::unordered_map<int, mcap::SchemaPtr>& schemas,
                        const std::unordered_map<uint16_t, uint64_t>& messages_count_by_channelID,
+                       std::optional<std::pair<uint64_t, uint64_t>> log_time_range,
                        std::optional<mcap::LoadParams> default_parameters, QWidget* parent)
   : QDialog(parent)
   , ui(new Ui::dialog_mcap)
@@ -88,6 +90,39 @@ DialogMCAP::DialogMCAP(const std::unordered_map<int, mcap::ChannelPtr>& channels
     ui->radioPubTime->setChecked(true);
   }
 
+  // the time range is relative to the first message, in seconds
+  if (log_time_range && log_time_range->second > log_time_range->first)
+  {
+    _first_log_time = log_time_range->first;
+    _last_log_time = log_time_range->second;
+    const double duration = double(log_time_range->second - log_time_range->first) * 1e-9;
+    auto toSeconds = [this](uint64_t log_time) {
+      return double(log_time - std::min(log_time, _first_log_time)) * 1e-9;
+    };
+
+    ui->spinBoxStartTime->setRange(0, duration);
+    ui->spinBoxEndTime->setRange(0, duration);
+    ui->spinBoxStartTime->setValue(params.use_time_range ? toSeconds(params.start_time) : 0);
+    ui->spinBoxEndTime->setValue(params.use_time_range ? toSeconds(params.end_time) : duration);
+    ui->checkBoxTimeRange->setChecked(params.use_time_range);
+    ui->spinBoxStartTime->setEnabled(params.use_time_range);
+    ui->spinBoxEndTime->setEnabled(params.use_time_range);
+
+    connect(ui->checkBoxTimeRange, &QCheckBox::toggled, this, [this](bool checked) {
+      ui->spinBoxStartTime->setEnabled(checked);
+      ui->spinBoxEndTime->setEnabled(checked);
+    });
+    connect(ui->spinBoxStartTime, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+            [this](double value) { ui->spinBoxEndTime->setMinimum(value); });
+    connect(ui->spinBoxEndTime, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+            [this](double value) { ui->spinBoxStartTime->setMaximum(value); });
+  }
+  else
+  {
+    // without the statistics of the file, the time range is unknown
+    ui->checkBoxTimeRange->setEnabled(false);
+  }
+
   int row = 0;
   ui->tableWidget->setFocusPolicy(Qt::NoFocus);
   const int columns_count = ui->tableWidget->columnCount();
@@ -143,6 +178,20 @@ mcap::LoadParams DialogMCAP::getParams() const
   params.clamp_large_arrays = ui->radioClamp->isChecked();
   params.use_timestamp = ui->checkBoxUseTimestamp->isChecked();
   params.use_mcap_log_time = ui->radioLogTime->isChecked();
+  params.use_time_range = ui->checkBoxTimeRange->isChecked();
+  if (params.use_time_range)
+  {
+    auto toLogTime = [this](double seconds) {
+      return _first_log_time + uint64_t(std::llround(seconds * 1e9));
+    };
+    params.start_time = toLogTime(ui->spinBoxStartTime->value());
+    params.end_time = toLogTime(ui->spinBoxEndTime->value());
+    // the spin boxes are rounded to the millisecond
+    if (ui->spinBoxEndTime->value() >= ui->spinBoxEndTime->maximum())
+    {
+      params.end_time = _last_log_time;
+    }
+  }
 
   QItemSelectionModel* select = ui->tableWidget->selectionModel();
   QStringList selected_topics;
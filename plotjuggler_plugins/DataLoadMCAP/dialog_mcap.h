@@ -30,6 +30,7 @@ public:
   explicit DialogMCAP(const std::unordered_map<int, mcap::ChannelPtr>& channels,
                       const std::unordered_map<int, mcap::SchemaPtr>& schemas,
                       const std::unordered_map<uint16_t, uint64_t>& messages_count_by_channelID,
+                      std::optional<std::pair<uint64_t, uint64_t>> log_time_range,
                       std::optional<mcap::LoadParams> default_parameters,
                       QWidget* parent = nullptr);
   ~DialogMCAP();
@@ -48,6 +49,10 @@ private:
 
   QShortcut _select_all;
   QShortcut _deselect_all;
+
+  // log time of the first and last message of the file, in nanoseconds
+  uint64_t _first_log_time = 0;
+  uint64_t _last_log_time = 0;
 };
 
 #endif  // DIALOG_MCAP_H
@@ -16,7 +16,7 @@ using namespace PJ;
 class DataLoadParquet : public DataLoader
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader")
+  Q_PLUGIN_METADATA(IID DataRead_iid)
   Q_INTERFACES(PJ::DataLoader)
 
 public:
@@ -24,7 +24,7 @@ public:
 class DataStreamZMQ : public PJ::DataStreamer
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataStreamer")
+  Q_PLUGIN_METADATA(IID DataStream_iid)
   Q_INTERFACES(PJ::DataStreamer)
 
 public:
@@ -9,7 +9,7 @@
 class ParserDataTamer : public PJ::ParserFactoryPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.ParserFactoryPlugin")
+  Q_PLUGIN_METADATA(IID ParserFactoryPlugin_iid)
   Q_INTERFACES(PJ::ParserFactoryPlugin)
 
 public:
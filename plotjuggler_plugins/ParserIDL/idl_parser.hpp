@@ -12,7 +12,7 @@ using namespace PJ;
 class ParserFactoryIDL : public ParserFactoryPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.ParserFactoryPlugin")
+  Q_PLUGIN_METADATA(IID ParserFactoryPlugin_iid)
   Q_INTERFACES(PJ::ParserFactoryPlugin)
 
 public:
@@ -14,7 +14,7 @@ using namespace PJ;
 class ParserFactoryROS1 : public ParserFactoryPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.ParserFactoryPlugin")
+  Q_PLUGIN_METADATA(IID ParserFactoryPlugin_iid)
   Q_INTERFACES(PJ::ParserFactoryPlugin)
 
 public:
@@ -16,7 +16,7 @@ using namespace PJ;
 class DataLoadZcm : public PJ::DataLoader
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.DataLoader")
+  Q_PLUGIN_METADATA(IID DataRead_iid)
   Q_INTERFACES(PJ::DataLoader)
 
 public:
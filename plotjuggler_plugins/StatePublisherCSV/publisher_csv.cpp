@@ -10,6 +10,7 @@
 #include <QSettings>
 #include <QByteArray>
 #include "publisher_csv.h"
+#include "PlotJuggler/time_alignment.h"
 
 StatePublisherCSV::StatePublisherCSV()
 {
@@ -269,83 +270,29 @@ QString StatePublisherCSV::generateRangeCSV(double time_start, double time_end)
   std::sort(ordered_plotdata.begin(), ordered_plotdata.end(),
             [](const PlotPair& a, const PlotPair& b) { return a.first < b.first; });
 
-  // current index per plordata
-  std::vector<size_t> indices(plot_count, 0);
-
-  const auto NaN = std::numeric_limits<double>::quiet_NaN();
-  std::vector<double> row_values(plot_count, NaN);
-
   QString labels;
   labels += "__time,";
+  std::vector<const PJ::PlotData*> series;
   for (size_t i = 0; i < plot_count; i++)
   {
     labels += QString::fromStdString(ordered_plotdata[i].first);
     labels += (i + 1 < plot_count) ? "," : "\n";
-
-    const PJ::PlotData* plotdata = (ordered_plotdata[i].second);
-    int index = plotdata->getIndexFromX(time_start);
-    if (index < 0)
-    {
-      index = plotdata->size();
-    }
-    indices[i] = index + 1;
+    series.push_back(ordered_plotdata[i].second);
   }
 
-  bool done = false;
   QStringList rows = { labels };
 
-  while (!done)
+  // one row for each timestamp of the union of the series, with the values
+  // of the series that have a sample at that time.
+  PJ::TimeMerger merger(series, time_start, time_end, std::numeric_limits<double>::epsilon());
+  while (merger.next())
   {
-    // done will become false if at least one plotdata is not completed
-    done = true;
-    double min_time = std::numeric_limits<double>::max();
-
-    for (size_t i = 0; i < plot_count; i++)
-    {
-      size_t index = indices[i];
-      const PJ::PlotData* plotdata = (ordered_plotdata[i].second);
-      row_values[i] = NaN;
-
-      if (index >= plotdata->size())
-      {
-        continue;
-      }
-      const auto& point = plotdata->at(index);
-      if (point.x > time_end)
-      {
-        continue;
-      }
-
-      done = false;
-
-      if (min_time > point.x)
-      {
-        min_time = point.x;  // new min_time
-        // reset previous flags
-        std::fill(row_values.begin(), row_values.begin() + i, NaN);
-        row_values[i] = point.y;
-      }
-      else if (std::abs(min_time - point.x) < std::numeric_limits<double>::epsilon())
-      {
-        row_values[i] = point.y;
-      }
-    }
-
-    if (min_time > time_end || done)
-    {
-      break;
-    }
-
-    // the row to append to the CSV file
-    QString row_str = QString::number(min_time, 'f', 6) + ",";
-
+    QString row_str = QString::number(merger.time(), 'f', 6) + ",";
     for (size_t i = 0; i < plot_count; i++)
     {
-      if (!std::isnan(row_values[i]))
+      if (const auto* point = merger.sample(i))
       {
-        row_str += QString::number(row_values[i], 'f', 9);
-        // value used, move to the nex index
-        indices[i]++;
+        row_str += QString::number(point->y, 'f', 9);
       }
       row_str += (i + 1 < plot_count) ? "," : "\n";
     }
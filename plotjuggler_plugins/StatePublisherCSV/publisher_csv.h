@@ -13,7 +13,7 @@
 class StatePublisherCSV : public PJ::StatePublisher
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.StatePublisher")
+  Q_PLUGIN_METADATA(IID StatePublisher_iid)
   Q_INTERFACES(PJ::StatePublisher)
 
 public:
@@ -0,0 +1,266 @@
+#include "spectral_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+// below this, starting a thread costs more than the FFTs it would compute
+static constexpr size_t MIN_SEGMENTS_PER_THREAD = 16;
+
+std::vector<double> CreateWindow(WindowType type, size_t size)
+{
+  // periodic windows, the ones used for spectral analysis
+  std::vector<double> window(size, 1.0);
+  const double step = 2.0 * M_PI / double(size);
+  for (size_t n = 0; n < size; n++)
+  {
+    const double phase = step * double(n);
+    switch (type)
+    {
+      case WINDOW_RECTANGULAR:
+        break;
+      case WINDOW_HANN:
+        window[n] = 0.5 - 0.5 * std::cos(phase);
+        break;
+      case WINDOW_BLACKMAN:
+        window[n] = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        break;
+    }
+  }
+  return window;
+}
+
+SegmentFFT::SegmentFFT(size_t size, WindowType window)
+  : _window_type(window)
+  , _window(CreateWindow(window, size))
+  , _input(size)
+  , _output(size / 2 + 1)
+{
+  for (double w : _window)
+  {
+    _window_sum += w;
+    _window_square_sum += w * w;
+  }
+  _config = kiss_fftr_alloc(int(size), false, nullptr, nullptr);
+}
+
+SegmentFFT::~SegmentFFT()
+{
+  kiss_fftr_free(_config);
+}
+
+void SegmentFFT::powerSpectrum(const PJ::PlotData& data, size_t first, bool remove_mean,
+                               double* out)
+{
+  const size_t N = _input.size();
+
+  double average = 0;
+  if (remove_mean)
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      average += data[first + i].y;
+    }
+    average /= double(N);
+  }
+
+  for (size_t i = 0; i < N; i++)
+  {
+    _input[i] = static_cast<kiss_fft_scalar>((data[first + i].y - average) * _window[i]);
+  }
+
+  kiss_fftr(_config, _input.data(), _output.data());
+
+  for (size_t k = 0; k < _output.size(); k++)
+  {
+    const double re = _output[k].r;
+    const double im = _output[k].i;
+    out[k] = re * re + im * im;
+  }
+}
+
+void SpectralAnalyzer::setOptions(const Options& options)
+{
+  if (options == _options)
+  {
+    return;
+  }
+  if (options.segment_size != _options.segment_size || options.window != _options.window)
+  {
+    _plans.clear();
+  }
+  _options = options;
+  reset();
+}
+
+void SpectralAnalyzer::reset()
+{
+  _started = false;
+  _keep_segments = false;
+  _columns_end = 0;
+  _generation++;
+  _segment_count = 0;
+  _sample_rate = 0;
+  _psd_sum.clear();
+  _columns.clear();
+  _last_start_time = 0;
+  _last_time = 0;
+}
+
+size_t SpectralAnalyzer::update(const PJ::PlotData& data, size_t first, size_t last)
+{
+  const size_t L = _options.segment_size;
+  if (L < 2 || last >= data.size() || last < first)
+  {
+    return 0;
+  }
+  const size_t hop =
+      std::max<size_t>(1, size_t(std::lround(double(L) * (1.0 - _options.overlap))));
+
+  if (_started)
+  {
+    // samples were inserted or removed among the ones already processed
+    auto change = data.earliestChangeSince(_revision);
+    if (change && *change <= _last_time)
+    {
+      reset();
+    }
+  }
+  _revision = data.revision();
+
+  size_t start = first;
+  if (_started)
+  {
+    auto it = std::lower_bound(data.begin() + first, data.begin() + last + 1, _last_start_time,
+                               [](const PJ::PlotData::Point& p, double t) { return p.x < t; });
+    start = std::distance(data.begin(), it);
+    if (it != data.begin() + last + 1 && it->x == _last_start_time)
+    {
+      start += hop;
+    }
+  }
+  else
+  {
+    if (last - first + 1 < L)
+    {
+      return 0;
+    }
+    _sample_rate = double(last - first) / (data[last].x - data[first].x);
+    if (!std::isfinite(_sample_rate) || _sample_rate <= 0)
+    {
+      return 0;
+    }
+    _psd_sum.assign(binCount(), 0.0);
+    _keep_segments =
+        _options.keep_columns || data.maximumRangeX() < std::numeric_limits<double>::max();
+  }
+
+  std::vector<size_t> starts;
+  for (size_t s = start; s + L <= last + 1; s += hop)
+  {
+    starts.push_back(s);
+  }
+  if (starts.empty())
+  {
+    return 0;
+  }
+
+  const size_t count = starts.size();
+  const size_t bins = binCount();
+  const size_t thread_count = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(), count / MIN_SEGMENTS_PER_THREAD));
+  while (_plans.size() < thread_count)
+  {
+    _plans.push_back(std::make_unique<SegmentFFT>(L, _options.window));
+  }
+
+  // one-sided PSD: the bins other than DC and Nyquist also contain the negative frequencies
+  const double scale = 1.0 / (_sample_rate * _plans.front()->windowSquareSum());
+
+  std::vector<Column> new_columns(_keep_segments ? count : 0);
+  std::vector<std::vector<double>> partial_sums(thread_count, std::vector<double>(bins, 0.0));
+
+  auto process = [&](size_t thread, size_t begin, size_t end) {
+    SegmentFFT& plan = *_plans[thread];
+    std::vector<double>& sum = partial_sums[thread];
+    std::vector<double> psd(bins);
+    for (size_t i = begin; i < end; i++)
+    {
+      plan.powerSpectrum(data, starts[i], _options.remove_mean, psd.data());
+      for (size_t k = 0; k < bins; k++)
+      {
+        psd[k] *= (k == 0 || k == bins - 1) ? scale : 2.0 * scale;
+        sum[k] += psd[k];
+      }
+      if (_keep_segments)
+      {
+        new_columns[i] = { data[starts[i]].x, data[starts[i] + L / 2].x, psd };
+      }
+    }
+  };
+
+  // contiguous blocks of segments; the calling thread processes the first one
+  const size_t block = (count + thread_count - 1) / thread_count;
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < thread_count; t++)
+  {
+    workers.emplace_back(process, t, std::min(count, t * block), std::min(count, (t + 1) * block));
+  }
+  process(0, 0, std::min(count, block));
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  for (const auto& sum : partial_sums)
+  {
+    for (size_t k = 0; k < bins; k++)
+    {
+      _psd_sum[k] += sum[k];
+    }
+  }
+  for (auto& column : new_columns)
+  {
+    _columns.push_back(std::move(column));
+  }
+  _columns_end += new_columns.size();
+  _started = true;
+  _segment_count += count;
+  _last_start_time = data[starts.back()].x;
+  _last_time = data[starts.back() + L - 1].x;
+  return count;
+}
+
+std::vector<double> SpectralAnalyzer::welchPSD() const
+{
+  std::vector<double> psd(_psd_sum.size(), 0.0);
+  if (_segment_count == 0)
+  {
+    return psd;
+  }
+  for (size_t k = 0; k < psd.size(); k++)
+  {
+    // the sum may become slightly negative, after many segments were subtracted
+    psd[k] = std::max(0.0, _psd_sum[k]) / double(_segment_count);
+  }
+  return psd;
+}
+
+void SpectralAnalyzer::dropSegmentsBefore(double time)
+{
+  while (!_columns.empty() && _columns.front().start_time < time)
+  {
+    const auto& psd = _columns.front().psd;
+    for (size_t k = 0; k < psd.size(); k++)
+    {
+      _psd_sum[k] -= psd[k];
+    }
+    _segment_count--;
+    _columns.pop_front();
+  }
+  if (_segment_count == 0)
+  {
+    std::fill(_psd_sum.begin(), _psd_sum.end(), 0.0);
+  }
+}
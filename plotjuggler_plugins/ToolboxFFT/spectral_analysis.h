@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "PlotJuggler/plotdata.h"
+#include "KissFFT/kiss_fftr.h"
+
+enum WindowType
+{
+  WINDOW_RECTANGULAR,
+  WINDOW_HANN,
+  WINDOW_BLACKMAN
+};
+
+std::vector<double> CreateWindow(WindowType type, size_t size);
+
+/**
+ * Real FFT of a fixed number of samples. The kiss_fftr configuration, the window
+ * and the buffers are allocated once and reused by every call.
+ *
+ * kiss_fftr keeps a scratch buffer inside its configuration: an instance must
+ * not be used by two threads at the same time.
+ */
+class SegmentFFT
+{
+public:
+  /// size must be even
+  SegmentFFT(size_t size, WindowType window);
+
+  ~SegmentFFT();
+
+  SegmentFFT(const SegmentFFT&) = delete;
+  SegmentFFT& operator=(const SegmentFFT&) = delete;
+
+  size_t size() const
+  {
+    return _input.size();
+  }
+
+  WindowType window() const
+  {
+    return _window_type;
+  }
+
+  /// Sum of the window: divide |X_k| by it to obtain the amplitude of a sinusoid.
+  double windowSum() const
+  {
+    return _window_sum;
+  }
+
+  /// Sum of the squares of the window: normalization of the power spectral density.
+  double windowSquareSum() const
+  {
+    return _window_square_sum;
+  }
+
+  /// |X_k|^2, k = 0 .. size/2, of the samples [first, first + size) of data, multiplied
+  /// by the window. If remove_mean, the average of those samples is subtracted first.
+  void powerSpectrum(const PJ::PlotData& data, size_t first, bool remove_mean, double* out);
+
+private:
+  WindowType _window_type;
+  std::vector<double> _window;
+  double _window_sum = 0;
+  double _window_square_sum = 0;
+  kiss_fftr_cfg _config = nullptr;
+  std::vector<kiss_fft_scalar> _input;
+  std::vector<kiss_fft_cpx> _output;
+};
+
+/**
+ * Welch power spectral density and spectrogram (STFT) of a series sampled with
+ * a constant dT.
+ *
+ * The series is split into segments of segment_size samples, overlapping by
+ * overlap * segment_size. The periodograms of the segments are computed in
+ * parallel, with one SegmentFFT per thread; the Welch PSD is their average and
+ * the spectrogram keeps one column per segment.
+ *
+ * update() is incremental: if the samples already processed did not change, only
+ * the new segments are computed, so that it can be called periodically while streaming.
+ * When the oldest samples are trimmed from the buffer, dropSegmentsBefore() removes
+ * their segments from the Welch average and from the spectrogram.
+ */
+class SpectralAnalyzer
+{
+public:
+  struct Options
+  {
+    WindowType window = WINDOW_HANN;
+    size_t segment_size = 1024;
+    double overlap = 0.5;
+    bool remove_mean = false;
+    bool keep_columns = false;
+
+    bool operator==(const Options& other) const
+    {
+      return window == other.window && segment_size == other.segment_size &&
+             overlap == other.overlap && remove_mean == other.remove_mean &&
+             keep_columns == other.keep_columns;
+    }
+    bool operator!=(const Options& other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  /// One-sided PSD of a segment, with the time of its first and central sample
+  struct Column
+  {
+    double start_time;
+    double time;
+    std::vector<double> psd;
+  };
+
+  /// Calls reset() if the options changed.
+  void setOptions(const Options& options);
+
+  const Options& options() const
+  {
+    return _options;
+  }
+
+  void reset();
+
+  /// Process the segments contained in the samples [first, last] of data.
+  /// Returns the number of new segments.
+  size_t update(const PJ::PlotData& data, size_t first, size_t last);
+
+  /// Segments in the Welch average
+  size_t segmentCount() const
+  {
+    return _segment_count;
+  }
+
+  /// Estimated when the first segment is processed
+  double sampleRate() const
+  {
+    return _sample_rate;
+  }
+
+  /// segment_size / 2 + 1
+  size_t binCount() const
+  {
+    return _options.segment_size / 2 + 1;
+  }
+
+  double frequency(size_t bin) const
+  {
+    return double(bin) * _sample_rate / double(_options.segment_size);
+  }
+
+  /// Average of the PSD of the segments processed so far (and not dropped), in units^2 / Hz.
+  std::vector<double> welchPSD() const;
+
+  /// The PSD of each segment. They are kept if Options::keep_columns or if the
+  /// source has a maximum range (the segments will be dropped); empty otherwise.
+  const std::deque<Column>& columns() const
+  {
+    return _columns;
+  }
+
+  /// Number of columns created since the last reset(): it is the index of the
+  /// next column, while columns().front() has index columnsEnd() - columns().size().
+  uint64_t columnsEnd() const
+  {
+    return _columns_end;
+  }
+
+  /// Incremented by reset(): the columns created before are not valid anymore.
+  uint64_t generation() const
+  {
+    return _generation;
+  }
+
+  /// Remove the segments whose first sample is older than time, i.e. not buffered
+  /// anymore, from the Welch average and from columns().
+  void dropSegmentsBefore(double time);
+
+private:
+  Options _options;
+  // one plan per worker thread, kept between the calls of update()
+  std::vector<std::unique_ptr<SegmentFFT>> _plans;
+
+  // true after the first segment: the next update() continues from the last one
+  bool _started = false;
+  // the segments are kept in _columns, to be subtracted from _psd_sum when dropped
+  bool _keep_segments = false;
+  size_t _segment_count = 0;
+  double _sample_rate = 0;
+  std::vector<double> _psd_sum;
+  std::deque<Column> _columns;
+  uint64_t _columns_end = 0;
+  uint64_t _generation = 0;
+
+  // time of the first sample of the last segment and of the last processed sample
+  double _last_start_time = 0;
+  double _last_time = 0;
+  uint64_t _revision = 0;
+};
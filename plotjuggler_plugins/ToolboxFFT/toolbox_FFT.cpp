@@ -7,11 +7,149 @@
 #include <QDebug>
 #include <QDragEnterEvent>
 #include <QSettings>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
 
 #include "PlotJuggler/transform_function.h"
 #include "PlotJuggler/svg_util.h"
 #include "KissFFT/kiss_fftr.h"
 
+#include "qwt_plot.h"
+#include "qwt_plot_spectrogram.h"
+#include "qwt_raster_data.h"
+#include "qwt_color_map.h"
+#include "qwt_scale_widget.h"
+
+// colors of the spectrogram cover this range below the maximum
+static constexpr double SPECTROGRAM_RANGE_DB = 100.0;
+
+static constexpr int STREAMING_UPDATE_PERIOD_MS = 500;
+
+static QColor CurveColor(const PlotData& curve_data)
+{
+  QColor color = Qt::transparent;
+  auto colorHint = curve_data.attribute(COLOR_HINT);
+  if (colorHint.isValid())
+  {
+    color = colorHint.value<QColor>();
+  }
+  return color;
+}
+
+static QwtColorMap* SpectrogramColorMap()
+{
+  auto color_map = new QwtLinearColorMap(Qt::black, Qt::white);
+  color_map->addColorStop(0.25, Qt::darkBlue);
+  color_map->addColorStop(0.5, Qt::darkMagenta);
+  color_map->addColorStop(0.75, Qt::red);
+  color_map->addColorStop(0.9, Qt::yellow);
+  return color_map;
+}
+
+// Spectrogram in dB, one column per segment. While streaming, the columns of
+// the new segments are appended and the ones of the dropped segments removed,
+// instead of converting the entire matrix at each update.
+class SpectrogramRaster : public QwtRasterData
+{
+public:
+  void clear()
+  {
+    _columns.clear();
+    _source = nullptr;
+  }
+
+  void update(const SpectralAnalyzer& analyzer)
+  {
+    if (_source != &analyzer || _generation != analyzer.generation())
+    {
+      _columns.clear();
+      _source = &analyzer;
+      _generation = analyzer.generation();
+      _end = 0;
+    }
+    const auto& source_columns = analyzer.columns();
+    const uint64_t source_first = analyzer.columnsEnd() - source_columns.size();
+
+    while (!_columns.empty() && _end - _columns.size() < source_first)
+    {
+      _columns.pop_front();
+    }
+    if (_columns.empty())
+    {
+      _end = std::max(_end, source_first);
+    }
+    for (; _end < analyzer.columnsEnd(); _end++)
+    {
+      const auto& psd = source_columns[_end - source_first].psd;
+      DbColumn column;
+      column.db.resize(psd.size());
+      column.max_db = std::numeric_limits<double>::lowest();
+      for (size_t k = 0; k < psd.size(); k++)
+      {
+        column.db[k] = 10.0 * std::log10(psd[k] + std::numeric_limits<double>::min());
+        column.max_db = std::max(column.max_db, column.db[k]);
+      }
+      _columns.push_back(std::move(column));
+    }
+  }
+
+  double maxValue() const
+  {
+    double max_db = std::numeric_limits<double>::lowest();
+    for (const auto& column : _columns)
+    {
+      max_db = std::max(max_db, column.max_db);
+    }
+    return _columns.empty() ? 0.0 : max_db;
+  }
+
+  void setIntervals(const QwtInterval& x, const QwtInterval& y, const QwtInterval& z)
+  {
+    _intervals[Qt::XAxis] = x;
+    _intervals[Qt::YAxis] = y;
+    _intervals[Qt::ZAxis] = z;
+  }
+
+  QwtInterval interval(Qt::Axis axis) const override
+  {
+    return _intervals[axis];
+  }
+
+  // nearest column and bin, like QwtMatrixRasterData
+  double value(double x, double y) const override
+  {
+    if (_columns.empty())
+    {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    const QwtInterval& x_range = _intervals[Qt::XAxis];
+    const QwtInterval& y_range = _intervals[Qt::YAxis];
+    const int column_count = int(_columns.size());
+    const int column = std::clamp(
+        int((x - x_range.minValue()) / x_range.width() * column_count), 0, column_count - 1);
+    const auto& db = _columns[size_t(column)].db;
+    const int bin_count = int(db.size());
+    const int bin = std::clamp(int((y - y_range.minValue()) / y_range.width() * bin_count), 0,
+                               bin_count - 1);
+    return db[size_t(bin)];
+  }
+
+private:
+  struct DbColumn
+  {
+    std::vector<double> db;
+    double max_db;
+  };
+  std::deque<DbColumn> _columns;
+  // index of the next column of _source, see SpectralAnalyzer::columnsEnd()
+  uint64_t _end = 0;
+  const SpectralAnalyzer* _source = nullptr;
+  uint64_t _generation = 0;
+  QwtInterval _intervals[3];
+};
+
 ToolboxFFT::ToolboxFFT()
 {
   _widget = new QWidget(nullptr);
@@ -26,6 +164,28 @@ ToolboxFFT::ToolboxFFT()
   connect(ui->pushButtonSave, &QPushButton::clicked, this, &ToolboxFFT::onSaveCurve);
 
   connect(ui->pushButtonClear, &QPushButton::clicked, this, &ToolboxFFT::onClearCurves);
+
+  connect(ui->comboMethod, qOverload<int>(&QComboBox::currentIndexChanged), this,
+          &ToolboxFFT::onMethodChanged);
+
+  _streaming_timer = new QTimer(this);
+  _streaming_timer->setInterval(STREAMING_UPDATE_PERIOD_MS);
+  connect(_streaming_timer, &QTimer::timeout, this, [this]() {
+    if (_widget->isVisible() && !_curve_names.empty())
+    {
+      updateSpectra();
+    }
+  });
+  connect(ui->checkStreaming, &QCheckBox::toggled, this, [this](bool checked) {
+    if (checked)
+    {
+      _streaming_timer->start();
+    }
+    else
+    {
+      _streaming_timer->stop();
+    }
+  });
 }
 
 ToolboxFFT::~ToolboxFFT()
@@ -45,9 +205,25 @@ void ToolboxFFT::init(PJ::PlotDataMapRef& src_data, PJ::TransformsMap& transform
   preview_layout_A->setMargin(6);
   preview_layout_A->addWidget(_plot_widget_A);
 
+  _spectrogram_plot = new QwtPlot(ui->framePlotPreviewB);
+  _spectrogram_plot->setAxisTitle(QwtPlot::xBottom, "Time");
+  _spectrogram_plot->setAxisTitle(QwtPlot::yLeft, "Frequency [Hz]");
+  _spectrogram_plot->setAxisTitle(QwtPlot::yRight, "PSD [dB]");
+  _spectrogram_plot->enableAxis(QwtPlot::yRight);
+  _spectrogram_plot->axisWidget(QwtPlot::yRight)->setColorBarEnabled(true);
+  _spectrogram_plot->hide();
+
+  _spectrogram = new QwtPlotSpectrogram();
+  _spectrogram->setRenderThreadCount(0);  // as many as the cores
+  _spectrogram->setColorMap(SpectrogramColorMap());
+  _spectrogram_raster = new SpectrogramRaster();
+  _spectrogram->setData(_spectrogram_raster);
+  _spectrogram->attach(_spectrogram_plot);
+
   auto preview_layout_B = new QHBoxLayout(ui->framePlotPreviewB);
   preview_layout_B->setMargin(6);
   preview_layout_B->addWidget(_plot_widget_B);
+  preview_layout_B->addWidget(_spectrogram_plot);
 
   _plot_widget_A->setAcceptDrops(true);
 
@@ -72,10 +248,32 @@ bool ToolboxFFT::onShowWidget()
   return true;
 }
 
+SpectralAnalyzer::Options ToolboxFFT::analyzerOptions() const
+{
+  SpectralAnalyzer::Options options;
+  options.window = static_cast<WindowType>(ui->comboWindow->currentIndex());
+  options.segment_size = ui->comboSegmentSize->currentText().toULong();
+  options.overlap = double(ui->spinOverlap->value()) / 100.0;
+  options.remove_mean = ui->checkAverage->isChecked();
+  options.keep_columns = (ui->comboMethod->currentIndex() == METHOD_SPECTROGRAM);
+  return options;
+}
+
 void ToolboxFFT::calculateCurveFFT()
+{
+  QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+  updateSpectra();
+  QApplication::restoreOverrideCursor();
+}
+
+void ToolboxFFT::updateSpectra()
 {
   _plot_widget_B->removeAllCurves();
 
+  const int method = ui->comboMethod->currentIndex();
+  const auto options = analyzerOptions();
+  bool spectrogram_done = false;
+
   for (const auto& curve_id : _curve_names)
   {
     auto it = _plot_data->numeric.find(curve_id);
@@ -99,79 +297,157 @@ void ToolboxFFT::calculateCurveFFT()
       max_index = curve_data.getIndexFromX(_zoom_range.max);
     }
 
-    size_t N = 1 + max_index - min_index;
-
-    if (N & 1)
-    {  // if not even, make it even
-      N--;
-      max_index--;
+    if (method == METHOD_FFT)
+    {
+      calculateFFT(curve_id, curve_data, min_index, max_index);
+      continue;
     }
 
-    if (N < 8)
+    auto& analyzer = _analyzers[curve_id];
+    analyzer.setOptions(options);
+    if (ui->radioZoomed->isChecked())
     {
-      return;
+      // the range follows the zoom: the incremental state is used only with "All Data"
+      analyzer.reset();
     }
-
-    double dT = (curve_data.at(max_index).x - curve_data.at(min_index).x) / double(N - 1);
-
-    std::vector<kiss_fft_scalar> input;
-    input.reserve(curve_data.size());
-
-    double sum = 0;
-    if (ui->checkAverage->isChecked())
+    analyzer.update(curve_data, min_index, max_index);
+    // the segments of the samples trimmed from the buffer leave the average
+    analyzer.dropSegmentsBefore(curve_data.front().x);
+    if (analyzer.segmentCount() == 0)
     {
-      for (size_t i = 0; i < N; i++)
-      {
-        sum += curve_data[i + min_index].y;
-      }
+      continue;
     }
-    double average = sum / double(N);
 
-    for (size_t i = 0; i < N; i++)
+    if (method == METHOD_WELCH)
     {
-      size_t index = i + min_index;
-      const auto& p = curve_data[index];
-      input.push_back(static_cast<kiss_fft_scalar>(p.y - average));
-
-      if (i != 0)
+      const auto psd = analyzer.welchPSD();
+      auto& curve_psd = _local_data.getOrCreateScatterXY(curve_id);
+      curve_psd.clear();
+      for (size_t k = 0; k < psd.size(); k++)
       {
-        double dTi = (p.x - curve_data[index - 1].x);
-        double diff = dTi - dT;
-        // std_dev += diff*diff;
+        curve_psd.pushBack({ analyzer.frequency(k), psd[k] });
       }
+      _plot_widget_B->addCurve(curve_id + "_PSD", curve_psd, CurveColor(curve_data));
+    }
+    else if (!spectrogram_done)
+    {
+      // a single heatmap: the spectrogram of the first curve
+      updateSpectrogramPlot(curve_id, analyzer);
+      spectrogram_done = true;
     }
-    // std_dev = sqrt(std_dev / double(N-1) );
+  }
 
-    std::vector<kiss_fft_cpx> out(N / 2 + 1);
+  _plot_widget_B->resetZoom();
+}
 
-    auto config = kiss_fftr_alloc(N, false, nullptr, nullptr);
+void ToolboxFFT::calculateFFT(const std::string& curve_id, const PlotData& curve_data,
+                              size_t min_index, size_t max_index)
+{
+  size_t N = 1 + max_index - min_index;
 
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    kiss_fftr(config, input.data(), out.data());
-    QApplication::restoreOverrideCursor();
+  if (N & 1)
+  {  // if not even, make it even
+    N--;
+    max_index--;
+  }
 
-    auto& curver_fft = _local_data.getOrCreateScatterXY(curve_id);
-    curver_fft.clear();
-    for (size_t i = 0; i < N / 2; i++)
-    {
-      kiss_fft_scalar Hz = i * (1.0 / dT) / double(N);
-      kiss_fft_scalar amplitude = std::hypot(out[i].r, out[i].i) / N;
-      curver_fft.pushBack({ Hz, amplitude });
-    }
+  if (N < 8)
+  {
+    return;
+  }
 
-    QColor color = Qt::transparent;
-    auto colorHint = curve_data.attribute(COLOR_HINT);
-    if (colorHint.isValid())
-    {
-      color = colorHint.value<QColor>();
-    }
+  double dT = (curve_data.at(max_index).x - curve_data.at(min_index).x) / double(N - 1);
+
+  const auto window = static_cast<WindowType>(ui->comboWindow->currentIndex());
+  if (!_fft_plan || _fft_plan->size() != N || _fft_plan->window() != window)
+  {
+    _fft_plan = std::make_unique<SegmentFFT>(N, window);
+  }
 
-    _plot_widget_B->addCurve(curve_id + "_FFT", curver_fft, color);
+  std::vector<double> power(N / 2 + 1);
+  _fft_plan->powerSpectrum(curve_data, min_index, ui->checkAverage->isChecked(), power.data());
 
-    free(config);
+  auto& curver_fft = _local_data.getOrCreateScatterXY(curve_id);
+  curver_fft.clear();
+  for (size_t i = 0; i < N / 2; i++)
+  {
+    double Hz = i * (1.0 / dT) / double(N);
+    double amplitude = std::sqrt(power[i]) / _fft_plan->windowSum();
+    curver_fft.pushBack({ Hz, amplitude });
   }
 
-  _plot_widget_B->resetZoom();
+  _plot_widget_B->addCurve(curve_id + "_FFT", curver_fft, CurveColor(curve_data));
+}
+
+void ToolboxFFT::updateSpectrogramPlot(const std::string& curve_id,
+                                       const SpectralAnalyzer& analyzer)
+{
+  if (analyzer.columns().empty())
+  {
+    return;
+  }
+  // only the columns added since the last call are converted to dB
+  _spectrogram_raster->update(analyzer);
+
+  const auto& columns = analyzer.columns();
+  const size_t bins = analyzer.binCount();
+  const double max_db = _spectrogram_raster->maxValue();
+  const QwtInterval z_range(max_db - SPECTROGRAM_RANGE_DB, max_db);
+
+  // each column covers the time between its neighbours
+  const double t_first = columns.front().time;
+  const double t_last = columns.back().time;
+  const double half_step =
+      (columns.size() > 1) ?
+          0.5 * (t_last - t_first) / double(columns.size() - 1) :
+          0.5 * double(analyzer.options().segment_size) / analyzer.sampleRate();
+  const QwtInterval x_range(t_first - half_step, t_last + half_step);
+  const QwtInterval y_range(0.0, analyzer.frequency(bins - 1));
+
+  _spectrogram_raster->setIntervals(x_range, y_range, z_range);
+  _spectrogram->invalidateCache();
+
+  _spectrogram_plot->axisWidget(QwtPlot::yRight)->setColorMap(z_range, SpectrogramColorMap());
+  _spectrogram_plot->setAxisScale(QwtPlot::yRight, z_range.minValue(), z_range.maxValue());
+  _spectrogram_plot->setAxisScale(QwtPlot::xBottom, x_range.minValue(), x_range.maxValue());
+  _spectrogram_plot->setAxisScale(QwtPlot::yLeft, y_range.minValue(), y_range.maxValue());
+  _spectrogram_plot->setTitle(QString::fromStdString(curve_id));
+  _spectrogram_plot->replot();
+}
+
+void ToolboxFFT::onMethodChanged(int method)
+{
+  const bool spectrogram = (method == METHOD_SPECTROGRAM);
+  _plot_widget_B->setVisible(!spectrogram);
+  _spectrogram_plot->setVisible(spectrogram);
+
+  // the segments are not used by the single FFT
+  ui->comboSegmentSize->setEnabled(method != METHOD_FFT);
+  ui->spinOverlap->setEnabled(method != METHOD_FFT);
+
+  ui->pushButtonSave->setEnabled(!spectrogram && !_curve_names.empty());
+
+  switch (method)
+  {
+    case METHOD_FFT:
+      ui->label_3->setText("FFT: Frequencies");
+      break;
+    case METHOD_WELCH:
+      ui->label_3->setText("Welch: Power Spectral Density");
+      break;
+    case METHOD_SPECTROGRAM:
+      ui->label_3->setText("Spectrogram: Power Spectral Density [dB]");
+      break;
+  }
+
+  const auto suffix = ui->lineEditSuffix->text();
+  if (suffix == "_FFT" || suffix == "_PSD")
+  {
+    ui->lineEditSuffix->setText(method == METHOD_WELCH ? "_PSD" : "_FFT");
+  }
+  // the curves of the previous method can't be saved as the new one
+  _plot_widget_B->removeAllCurves();
+  _local_data.scatter_xy.clear();
 }
 
 void ToolboxFFT::onClearCurves()
@@ -186,9 +462,15 @@ void ToolboxFFT::onClearCurves()
   ui->pushButtonCalculate->setEnabled(false);
 
   ui->lineEditSuffix->setEnabled(false);
-  ui->lineEditSuffix->setText("_FFT");
+  ui->lineEditSuffix->setText(ui->comboMethod->currentIndex() == METHOD_WELCH ? "_PSD" : "_FFT");
 
   _curve_names.clear();
+  _analyzers.clear();
+  _local_data.scatter_xy.clear();
+
+  _spectrogram_raster->clear();
+  _spectrogram->invalidateCache();
+  _spectrogram_plot->replot();
 }
 
 void ToolboxFFT::onDragEnterEvent(QDragEnterEvent* event)
@@ -237,7 +519,7 @@ void ToolboxFFT::onDropEvent(QDropEvent*)
     _zoom_range.max = std::max(_zoom_range.max, curve_data.back().x);
   }
 
-  ui->pushButtonSave->setEnabled(true);
+  ui->pushButtonSave->setEnabled(ui->comboMethod->currentIndex() != METHOD_SPECTROGRAM);
   ui->pushButtonCalculate->setEnabled(true);
   ui->lineEditSuffix->setEnabled(true);
 
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <QtPlugin>
+#include <QTimer>
+#include <map>
+#include <memory>
 #include <thread>
 #include "PlotJuggler/toolbox_base.h"
 #include "PlotJuggler/plotwidget_base.h"
+#include "spectral_analysis.h"
+
+class QwtPlot;
+class QwtPlotSpectrogram;
+class SpectrogramRaster;
 
 namespace Ui
 {
@@ -13,7 +21,7 @@ class toolbox_fft;
 class ToolboxFFT : public PJ::ToolboxPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox")
+  Q_PLUGIN_METADATA(IID Toolbox_iid)
   Q_INTERFACES(PJ::ToolboxPlugin)
 
 public:
@@ -45,6 +53,12 @@ private:
   PJ::PlotWidgetBase* _plot_widget_A = nullptr;
   PJ::PlotWidgetBase* _plot_widget_B = nullptr;
 
+  // heatmap of the spectrogram, shown instead of _plot_widget_B
+  QwtPlot* _spectrogram_plot = nullptr;
+  QwtPlotSpectrogram* _spectrogram = nullptr;
+  // data of _spectrogram, that owns it
+  SpectrogramRaster* _spectrogram_raster = nullptr;
+
   PJ::PlotDataMapRef* _plot_data = nullptr;
   PJ::TransformsMap* _transforms = nullptr;
 
@@ -54,6 +68,31 @@ private:
 
   std::vector<std::string> _curve_names;
 
+  // same order as the items of comboMethod
+  enum SpectrumMethod
+  {
+    METHOD_FFT,
+    METHOD_WELCH,
+    METHOD_SPECTROGRAM
+  };
+
+  // plan of the single FFT, reused while the size of the range doesn't change
+  std::unique_ptr<SegmentFFT> _fft_plan;
+
+  // Welch and spectrogram state of each curve, updated incrementally
+  std::map<std::string, SpectralAnalyzer> _analyzers;
+
+  QTimer* _streaming_timer;
+
+  SpectralAnalyzer::Options analyzerOptions() const;
+
+  void updateSpectra();
+
+  void calculateFFT(const std::string& curve_id, const PlotData& curve_data, size_t min_index,
+                    size_t max_index);
+
+  void updateSpectrogramPlot(const std::string& curve_id, const SpectralAnalyzer& analyzer);
+
 private slots:
 
   void onDragEnterEvent(QDragEnterEvent* event);
@@ -62,4 +101,5 @@ private slots:
   void onSaveCurve();
   void calculateCurveFFT();
   void onClearCurves();
+  void onMethodChanged(int method);
 };
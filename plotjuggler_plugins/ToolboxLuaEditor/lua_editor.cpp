@@ -63,6 +63,12 @@ ToolboxLuaEditor::ToolboxLuaEditor()
   connect(ui->pushButtonApplyLibrary, &QPushButton::clicked, this,
           &ToolboxLuaEditor::onReloadLibrary);
 
+  _stats_timer = new QTimer(this);
+  _stats_timer->setInterval(1000);
+  connect(_stats_timer, &QTimer::timeout, this, &ToolboxLuaEditor::updateExecutionStats);
+  connect(ui->listWidgetFunctions, &QListWidget::itemSelectionChanged, this,
+          &ToolboxLuaEditor::updateExecutionStats);
+
   ui->textGlobal->setHighlighter(new QLuaHighlighter);
   ui->textFunction->setHighlighter(new QLuaHighlighter);
   ui->textLibrary->setHighlighter(new QLuaHighlighter);
@@ -86,7 +92,8 @@ ToolboxLuaEditor::ToolboxLuaEditor()
       {
         auto name = elem.attribute("name");
         auto item = new QListWidgetItem(name);
-        setItemData(item, name, elem.attribute("global"), elem.attribute("function"));
+        setItemData(item, name, elem.attribute("global"), elem.attribute("function"),
+                    elem.attribute("incremental") == "true");
         ui->listWidgetRecent->addItem(item);
       }
     }
@@ -105,6 +112,7 @@ ToolboxLuaEditor::ToolboxLuaEditor()
 
 ToolboxLuaEditor::~ToolboxLuaEditor()
 {
+  _stats_timer->stop();
   delete ui;
 }
 
@@ -157,6 +165,10 @@ bool ToolboxLuaEditor::xmlSaveState(QDomDocument& doc, QDomElement& parent_eleme
     elem.setAttribute("name", fields.name);
     elem.setAttribute("function", fields.function_code);
     elem.setAttribute("global", fields.global_code);
+    if (fields.incremental)
+    {
+      elem.setAttribute("incremental", "true");
+    }
     scripts_elem.appendChild(elem);
   }
   parent_element.appendChild(scripts_elem);
@@ -182,12 +194,13 @@ bool ToolboxLuaEditor::xmlLoadState(const QDomElement& parent_element)
       QString name = elem.attribute("name");
       QString function = elem.attribute("function");
       QString global = elem.attribute("global");
+      bool incremental = (elem.attribute("incremental") == "true");
       auto item = new QListWidgetItem(name);
-      setItemData(item, name, global, function);
+      setItemData(item, name, global, function, incremental);
       ui->listWidgetFunctions->addItem(item);
 
-      auto lua_function = std::make_shared<ReactiveLuaFunction>(_plot_data, global, function,
-                                                                ui->textLibrary->toPlainText());
+      auto lua_function = std::make_shared<ReactiveLuaFunction>(
+          _plot_data, global, function, ui->textLibrary->toPlainText(), incremental);
 
       (*_transforms)[name.toStdString()] = lua_function;
     }
@@ -208,11 +221,14 @@ bool ToolboxLuaEditor::onShowWidget()
     {
       QString name = QString::fromStdString(it.first);
       auto item = new QListWidgetItem(name);
-      setItemData(item, name, lua_function->getGlobalCode(), lua_function->getFunctionCode());
+      setItemData(item, name, lua_function->getGlobalCode(), lua_function->getFunctionCode(),
+                  lua_function->incrementalOutputs());
       ui->listWidgetFunctions->addItem(item);
     }
     ui->listWidgetFunctions->sortItems();
   }
+  updateExecutionStats();
+  _stats_timer->start();
 
   QSettings settings;
   QString theme = settings.value("StyleSheet::theme", "light").toString();
@@ -270,7 +286,7 @@ void ToolboxLuaEditor::onSave()
   {
     auto lua_function = std::make_shared<ReactiveLuaFunction>(
         _plot_data, ui->textGlobal->toPlainText(), ui->textFunction->toPlainText(),
-        ui->textLibrary->toPlainText());
+        ui->textLibrary->toPlainText(), ui->checkIncremental->isChecked());
 
     (*_transforms)[name.toStdString()] = lua_function;
 
@@ -281,7 +297,8 @@ void ToolboxLuaEditor::onSave()
     }
 
     auto item = ui->listWidgetFunctions->findItems(name, Qt::MatchExactly).first();
-    setItemData(item, name, ui->textGlobal->toPlainText(), ui->textFunction->toPlainText());
+    setItemData(item, name, ui->textGlobal->toPlainText(), ui->textFunction->toPlainText(),
+                ui->checkIncremental->isChecked());
 
     for (auto& new_name : lua_function->createdCurves())
     {
@@ -311,7 +328,8 @@ void ToolboxLuaEditor::onSave()
 
   // save recent functions
   auto new_item = new QListWidgetItem(name);
-  setItemData(new_item, name, ui->textGlobal->toPlainText(), ui->textFunction->toPlainText());
+  setItemData(new_item, name, ui->textGlobal->toPlainText(), ui->textFunction->toPlainText(),
+              ui->checkIncremental->isChecked());
   ui->listWidgetRecent->addItem(new_item);
 
   QDomDocument xml_doc;
@@ -326,6 +344,10 @@ void ToolboxLuaEditor::onSave()
     elem.setAttribute("name", fields.name);
     elem.setAttribute("global", fields.global_code);
     elem.setAttribute("function", fields.function_code);
+    if (fields.incremental)
+    {
+      elem.setAttribute("incremental", "true");
+    }
     root.appendChild(elem);
   }
   xml_doc.appendChild(root);
@@ -352,6 +374,7 @@ void ToolboxLuaEditor::restoreRecent(const QModelIndex& index)
   ui->lineEditFunctionName->setText(fields.name);
   ui->textGlobal->setPlainText(fields.global_code);
   ui->textFunction->setPlainText(fields.function_code);
+  ui->checkIncremental->setChecked(fields.incremental);
 }
 
 void ToolboxLuaEditor::restoreFunction(const QModelIndex& index)
@@ -361,6 +384,7 @@ void ToolboxLuaEditor::restoreFunction(const QModelIndex& index)
   ui->lineEditFunctionName->setText(fields.name);
   ui->textGlobal->setPlainText(fields.global_code);
   ui->textFunction->setPlainText(fields.function_code);
+  ui->checkIncremental->setChecked(fields.incremental);
 }
 
 void ToolboxLuaEditor::onLibraryUpdated()
@@ -411,8 +435,9 @@ void ToolboxLuaEditor::onReloadLibrary()
     auto fields = getItemData(item);
     try
     {
-      auto lua_function = std::make_shared<ReactiveLuaFunction>(
-          _plot_data, fields.global_code, fields.function_code, ui->textLibrary->toPlainText());
+      auto lua_function =
+          std::make_shared<ReactiveLuaFunction>(_plot_data, fields.global_code, fields.function_code,
+                                                ui->textLibrary->toPlainText(), fields.incremental);
 
       (*_transforms)[fields.name.toStdString()] = lua_function;
     }
@@ -513,15 +538,57 @@ ToolboxLuaEditor::SavedData ToolboxLuaEditor::getItemData(const QListWidgetItem*
   data.name = fields[0];
   data.global_code = fields[1];
   data.function_code = fields[2];
+  data.incremental = (fields.size() > 3 && fields[3] == "true");
   return data;
 }
 
 void ToolboxLuaEditor::setItemData(QListWidgetItem* item, QString name, QString global_code,
-                                   QString function_code)
+                                   QString function_code, bool incremental)
 {
   QStringList save_fields;
   save_fields.push_back(name);
   save_fields.push_back(global_code);
   save_fields.push_back(function_code);
+  save_fields.push_back(incremental ? "true" : "false");
   item->setData(Qt::UserRole, save_fields);
 }
+
+void ToolboxLuaEditor::updateExecutionStats()
+{
+  if (!_widget->isVisible())
+  {
+    _stats_timer->stop();
+    return;
+  }
+
+  QString selected_stats;
+  for (int row = 0; row < ui->listWidgetFunctions->count(); row++)
+  {
+    auto item = ui->listWidgetFunctions->item(row);
+    auto it = _transforms->find(item->text().toStdString());
+    if (it == _transforms->end())
+    {
+      continue;
+    }
+    auto lua_function = std::dynamic_pointer_cast<ReactiveLuaFunction>(it->second);
+    if (!lua_function)
+    {
+      continue;
+    }
+    const auto& stats = lua_function->executionStats();
+    const double average_ms = (stats.runs > 0) ? stats.total_ms / double(stats.runs) : 0.0;
+    QString text = QString("Executed %1 times, skipped %2 (nothing changed)\n"
+                           "Time: last %3 ms, average %4 ms, max %5 ms")
+                       .arg(stats.runs)
+                       .arg(stats.skipped)
+                       .arg(stats.last_ms, 0, 'f', 2)
+                       .arg(average_ms, 0, 'f', 2)
+                       .arg(stats.max_ms, 0, 'f', 2);
+    item->setToolTip(text);
+    if (item->isSelected())
+    {
+      selected_stats = text;
+    }
+  }
+  ui->labelExecutionStats->setText(selected_stats);
+}
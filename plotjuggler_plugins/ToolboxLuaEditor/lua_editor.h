@@ -3,6 +3,7 @@
 
 #include <QtPlugin>
 #include <QListWidgetItem>
+#include <QTimer>
 #include <map>
 #include "PlotJuggler/toolbox_base.h"
 #include "PlotJuggler/plotwidget_base.h"
@@ -21,7 +22,7 @@ class LuaEditor;
 class ToolboxLuaEditor : public PJ::ToolboxPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox")
+  Q_PLUGIN_METADATA(IID Toolbox_iid)
   Q_INTERFACES(PJ::ToolboxPlugin)
 
 public:
@@ -55,6 +56,8 @@ public slots:
 
   void onReloadLibrary();
 
+  void updateExecutionStats();
+
 private:
   QWidget* _widget;
   Ui::LuaEditor* ui;
@@ -72,16 +75,20 @@ private:
 
   QString _previous_library;
 
+  QTimer* _stats_timer;
+
   struct SavedData
   {
     QString name;
     QString global_code;
     QString function_code;
+    bool incremental = false;
   };
 
   SavedData getItemData(const QListWidgetItem* item) const;
 
-  void setItemData(QListWidgetItem* item, QString name, QString global_code, QString function_code);
+  void setItemData(QListWidgetItem* item, QString name, QString global_code, QString function_code,
+                   bool incremental);
 };
 
 #endif  // LUA_EDITOR_H
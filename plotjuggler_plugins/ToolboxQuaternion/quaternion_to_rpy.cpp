@@ -1,5 +1,7 @@
 #include "quaternion_to_rpy.h"
+#include "PlotJuggler/time_alignment.h"
 #include <array>
+#include <vector>
 #include <math.h>
 
 QuaternionToRollPitchYaw::QuaternionToRollPitchYaw()
@@ -37,36 +39,47 @@ void QuaternionToRollPitchYaw::calculate()
   data_pitch.clear();
   data_yaw.clear();
 
-  if (data_x.size() == 0 || data_x.size() != data_y.size() || data_y.size() != data_z.size() ||
-      data_z.size() != data_w.size())
+  if (data_x.size() == 0 || data_y.size() == 0 || data_z.size() == 0 || data_w.size() == 0)
   {
     return;
   }
 
   int pos = data_x.getIndexFromX(_last_timestamp);
   size_t index = pos < 0 ? 0 : static_cast<size_t>(pos);
+  while (index < data_x.size() && data_x.at(index).x < _last_timestamp)
+  {
+    index++;
+  }
+  if (index >= data_x.size())
+  {
+    return;
+  }
 
-  while (index < data_x.size())
+  // the timestamps of X are used for the output: the other components are
+  // interpolated, in case they don't share the same timestamps.
+  const size_t count = data_x.size() - index;
+  std::vector<double> time(count);
+  for (size_t i = 0; i < count; i++)
   {
-    auto& point_x = data_x.at(index);
-    double timestamp = point_x.x;
-    double q_x = point_x.y;
-    double q_y = data_y.at(index).y;
-    double q_z = data_z.at(index).y;
-    double q_w = data_w.at(index).y;
-
-    if (timestamp >= _last_timestamp)
-    {
-      std::array<double, 3> RPY;
-      calculateNextPoint(index, { q_x, q_y, q_z, q_w }, RPY);
+    time[i] = data_x.at(index + i).x;
+  }
+  std::vector<double> values_y(count), values_z(count), values_w(count);
+  PJ::AlignSeries(data_y, time.data(), count, PJ::LINEAR, values_y.data());
+  PJ::AlignSeries(data_z, time.data(), count, PJ::LINEAR, values_z.data());
+  PJ::AlignSeries(data_w, time.data(), count, PJ::LINEAR, values_w.data());
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const double timestamp = time[i];
+    std::array<double, 3> RPY;
+    calculateNextPoint(index + i, { data_x.at(index + i).y, values_y[i], values_z[i], values_w[i] },
+                       RPY);
 
-      data_roll.pushBack({ timestamp, _scale * (RPY[0] + _roll_offset) });
-      data_pitch.pushBack({ timestamp, _scale * (RPY[1] + _pitch_offset) });
-      data_yaw.pushBack({ timestamp, _scale * (RPY[2] + _yaw_offset) });
+    data_roll.pushBack({ timestamp, _scale * (RPY[0] + _roll_offset) });
+    data_pitch.pushBack({ timestamp, _scale * (RPY[1] + _pitch_offset) });
+    data_yaw.pushBack({ timestamp, _scale * (RPY[2] + _yaw_offset) });
 
-      _last_timestamp = timestamp;
-    }
-    index++;
+    _last_timestamp = timestamp;
   }
 }
 
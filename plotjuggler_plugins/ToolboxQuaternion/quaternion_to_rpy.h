@@ -37,6 +37,11 @@ public:
 
   void calculate() override;
 
+  bool isThreadSafe() const override
+  {
+    return true;
+  }
+
   void calculateNextPoint(size_t index, const std::array<double, 4>& quat,
                           std::array<double, 3>& rpy);
 
@@ -14,7 +14,7 @@ class quaternion_to_RPY;
 class ToolboxQuaternion : public PJ::ToolboxPlugin
 {
   Q_OBJECT
-  Q_PLUGIN_METADATA(IID "facontidavide.PlotJuggler3.Toolbox")
+  Q_PLUGIN_METADATA(IID Toolbox_iid)
   Q_INTERFACES(PJ::ToolboxPlugin)
 
 public: